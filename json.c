@@ -1,10 +1,685 @@
 #include <stdbool.h>
 #include <stddef.h>
+#include <limits.h>
+#include <locale.h>
+#include <math.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include "json.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define JSON_X86
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define JSON_POSIX
+#else
+#include <stdio.h>
+#endif
+
+// arena 首个内存块的最小字节数
+#define JSON_BLOCK_MIN 256
+
+// 成员数不少于此值的对象在解析时建立哈希索引
+#define JSON_INDEX_MIN 16
+
+// JSON_INTERN_STRINGS 时驻留的字符串值的最大字节数
+#define JSON_INTERN_MAX 16
+
+// json_parse 中原文不长于此值的key与字符串值与成员节点一起申请
+#define JSON_SHORT_STR 16
+
+// 无法映射的输入（如管道）每次读取的字节数
+#define JSON_READ_CHUNK (1 << 20)
+
+// json_writer 内部缓冲区的字节数，及最大嵌套层数
+#define JSON_WRITER_BUF (64 * 1024)
+#define JSON_WRITER_DEPTH 256
+
+// json_parse_lines 每个线程每轮处理的记录数，及每次领取的记录数
+#define JSON_LINES_WINDOW 256
+#define JSON_LINES_BATCH 16
+
+// JSON_PARALLEL 时并行解析的数组的最小字节数与元素数，及每次领取的元素数
+#define JSON_PARALLEL_MIN (1 << 20)
+#define JSON_PARALLEL_ITEMS 64
+#define JSON_PARALLEL_BATCH 16
+
+/**
+ * @brief arena 内存块
+ *
+ * 块头之后紧跟可分配的内存，ptr 为下一次分配的位置，end 为块的末尾
+ */
+struct json_block {
+  struct json_block *next;
+  char *ptr;
+  char *end;
+};
+
+/**
+ * @brief 解析过程的上下文
+ *
+ * doc 为NULL时节点与字符串均由malloc单独申请，由json_free释放；
+ * 否则从doc的arena中切分，由json_doc_free一次性释放
+ * flags 为 enum json_parse_flag 的组合
+ * stack 为解析数组时共用的临时栈，top 为栈顶偏移，cap 为容量
+ * end 为输入的结尾，pool 为第一次并行解析数组时启动的线程池，
+ * 两者只在 JSON_PARALLEL 时使用；
+ * nomem 为生成数组时申请内存失败，此时结果不完整，整个解析失败
+ */
+struct parse_ctx {
+  json_doc *doc;
+  int flags;
+  char *stack;
+  size_t top;
+  size_t cap;
+  char *end;
+  struct json_pool *pool;
+  bool nomem;
+};
+
+/**
+ * @brief 为arena追加一个至少能容纳size字节的内存块
+ *
+ * @param doc 文档
+ * @param size 需要的字节数
+ * @return struct json_block* 新的当前块，失败返回NULL
+ */
+static struct json_block *arena_grow(json_doc *doc, size_t size) {
+  // 新块大小为上一块的两倍，保证块的数量为对数级
+  size_t cap = (doc->block->end - (char *)doc->block) * 2;
+  if (cap < size + sizeof(struct json_block))
+    cap = size + sizeof(struct json_block);
+  struct json_block *b = malloc(cap);
+  if (!b)
+    return NULL;
+  b->ptr = (char *)(b + 1);
+  b->end = (char *)b + cap;
+  b->next = doc->block;
+  doc->block = b;
+  return b;
+}
+
+/**
+ * @brief 从arena中切分一块内存
+ *
+ * @param doc 文档
+ * @param size 字节数，按8字节对齐
+ * @return void* 失败返回NULL
+ */
+static void *arena_alloc(json_doc *doc, size_t size) {
+  size = (size + 7) & ~(size_t)7;
+  struct json_block *b = doc->block;
+  if ((size_t)(b->end - b->ptr) < size && !(b = arena_grow(doc, size)))
+    return NULL;
+  void *ret = b->ptr;
+  b->ptr += size;
+  return ret;
+}
+
+/**
+ * @brief 按上下文申请内存
+ *
+ * @param ctx 解析上下文
+ * @param size 字节数
+ * @return void* 失败返回NULL
+ */
+static void *ctx_alloc(struct parse_ctx *ctx, size_t size) {
+  if (ctx->doc)
+    return arena_alloc(ctx->doc, size);
+  return malloc(size);
+}
+
+/**
+ * @brief 释放由ctx_alloc申请的内存，arena中的内存随文档一起释放
+ *
+ * @param ctx 解析上下文
+ * @param ptr 由ctx_alloc申请的内存
+ */
+static void ctx_free(struct parse_ctx *ctx, void *ptr) {
+  if (!ctx->doc)
+    free(ptr);
+}
+
+/**
+ * @brief 缩小最近一次申请的内存
+ *
+ * arena中只有位于当前块顶部的内存可以归还，其余情况保持原样
+ *
+ * @param ctx 解析上下文
+ * @param ptr 由ctx_alloc申请的内存
+ * @param old 原大小
+ * @param size 新大小，不大于old
+ * @return void* 缩小后的内存
+ */
+static void *ctx_shrink(struct parse_ctx *ctx, void *ptr, size_t old,
+                        size_t size) {
+  if (!ctx->doc)
+    return realloc(ptr, size);
+  struct json_block *b = ctx->doc->block;
+  old = (old + 7) & ~(size_t)7;
+  if ((char *)ptr + old == b->ptr)
+    b->ptr = (char *)ptr + ((size + 7) & ~(size_t)7);
+  return ptr;
+}
+
+/**
+ * @brief 按字节扫描的kernel
+ *
+ * 各实现返回从str开始第一个满足条件的字符的指针，均在'\0'处停止
+ * - space 跳过除'\0'外所有控制字符和空白
+ * - line 查找'\n'
+ * - star 查找'*'
+ * - quote 查找字符串中的'"'或'\\'
+ * - escape 查找输出字符串时需要转义的字符，即'"'、'\\'和控制字符
+ * - backslash 查找'\\'，JSON_STRICT 时用于检查转义
+ * - utf8 检查长度为len的输入是否为合法的utf8，不读取len之后的字节
+ * - block 计算64字节块中各类字符的位掩码，用于建立结构索引
+ */
+struct block_masks;
+struct scan_kernel {
+  char *(*space)(char *str);
+  char *(*line)(char *str);
+  char *(*star)(char *str);
+  char *(*quote)(char *str);
+  char *(*escape)(char *str);
+  void (*block)(const char *p, struct block_masks *m);
+  char *(*backslash)(char *str);
+  bool (*utf8)(const char *s, size_t len);
+};
+
+/**
+ * @brief 64字节块中各类字符的位掩码，第i位对应第i个字节
+ *
+ * 用于建立结构索引和划分并行解析的数组，
+ * open 为`{`和`[`，close 为`}`和`]`
+ */
+struct block_masks {
+  uint64_t quote;
+  uint64_t backslash;
+  uint64_t slash;
+  uint64_t open;
+  uint64_t close;
+  uint64_t comma;
+};
+
+static char *space_scalar(char *str) {
+  while (*str <= ' ' && *str)
+    str++;
+  return str;
+}
+
+static char *line_scalar(char *str) {
+  while (*str != '\n' && *str)
+    str++;
+  return str;
+}
+
+static char *star_scalar(char *str) {
+  while (*str != '*' && *str)
+    str++;
+  return str;
+}
+
+static char *quote_scalar(char *str) {
+  while (*str != '"' && *str != '\\' && *str)
+    str++;
+  return str;
+}
+
+static char *escape_scalar(char *str) {
+  while (*str != '"' && *str != '\\' && (unsigned char)*str >= ' ')
+    str++;
+  return str;
+}
+
+static char *backslash_scalar(char *str) {
+  while (*str != '\\' && *str)
+    str++;
+  return str;
+}
+
+static size_t utf8_seq(const unsigned char *p, size_t left);
+
+// 8字节中没有非ASCII字节时整体跳过
+static bool utf8_scalar(const char *s, size_t len) {
+  const unsigned char *p = (const unsigned char *)s;
+  size_t i = 0;
+  while (i < len) {
+    uint64_t w;
+    if (len - i >= 8 && (memcpy(&w, p + i, 8), !(w & 0x8080808080808080))) {
+      i += 8;
+    } else if (p[i] < 0x80) {
+      i++;
+    } else {
+      size_t n = utf8_seq(p + i, len - i);
+      if (!n)
+        return false;
+      i += n;
+    }
+  }
+  return true;
+}
+
+static void block_scalar(const char *p, struct block_masks *m) {
+  *m = (struct block_masks){0};
+  for (int i = 0; i < 64; i++) {
+    uint64_t bit = (uint64_t)1 << i;
+    switch (p[i]) {
+    case '"':
+      m->quote |= bit;
+      break;
+    case '\\':
+      m->backslash |= bit;
+      break;
+    case '/':
+      m->slash |= bit;
+      break;
+    case '{':
+    case '[':
+      m->open |= bit;
+      break;
+    case '}':
+    case ']':
+      m->close |= bit;
+      break;
+    case ',':
+      m->comma |= bit;
+      break;
+    }
+  }
+}
+
+#ifdef JSON_X86
+/*
+ * 向量化的实现每次读取16/32字节对齐的一块，对齐的读取不会跨越页边界，
+ * 因此即使读到'\0'之后也不会越界访问未映射的内存。
+ * 第一块中str之前的字节通过掩码忽略。
+ * 这种读取会被AddressSanitizer和ThreadSanitizer误报，因此对这些函数关闭检查
+ */
+#define JSON_SIMD(isa)                                                         \
+  __attribute__((target(isa), no_sanitize("address", "thread")))
+
+// 由比较结果生成停止位掩码，第i位为1表示第i个字节满足条件
+#define SCAN_LOOP(vec, width, load, movemask, stop)                            \
+  uintptr_t off = (uintptr_t)str & (width - 1);                                \
+  const vec *p = (const vec *)(str - off);                                     \
+  vec v = load(p);                                                             \
+  uint32_t mask = (uint32_t)movemask(stop) >> off;                             \
+  if (mask)                                                                    \
+    return str + __builtin_ctz(mask);                                          \
+  for (;;) {                                                                   \
+    v = load(++p);                                                             \
+    mask = (uint32_t)movemask(stop);                                           \
+    if (mask)                                                                  \
+      return (char *)p + __builtin_ctz(mask);                                  \
+  }
+
+JSON_SIMD("sse2") static char *space_sse2(char *str) {
+  const __m128i sp = _mm_set1_epi8(' ');
+  const __m128i zero = _mm_setzero_si128();
+  SCAN_LOOP(__m128i, 16, _mm_load_si128, _mm_movemask_epi8,
+            _mm_or_si128(_mm_cmpgt_epi8(v, sp), _mm_cmpeq_epi8(v, zero)))
+}
+
+JSON_SIMD("sse2") static char *line_sse2(char *str) {
+  const __m128i nl = _mm_set1_epi8('\n');
+  const __m128i zero = _mm_setzero_si128();
+  SCAN_LOOP(__m128i, 16, _mm_load_si128, _mm_movemask_epi8,
+            _mm_or_si128(_mm_cmpeq_epi8(v, nl), _mm_cmpeq_epi8(v, zero)))
+}
+
+JSON_SIMD("sse2") static char *star_sse2(char *str) {
+  const __m128i star = _mm_set1_epi8('*');
+  const __m128i zero = _mm_setzero_si128();
+  SCAN_LOOP(__m128i, 16, _mm_load_si128, _mm_movemask_epi8,
+            _mm_or_si128(_mm_cmpeq_epi8(v, star), _mm_cmpeq_epi8(v, zero)))
+}
+
+JSON_SIMD("sse2") static char *quote_sse2(char *str) {
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i slash = _mm_set1_epi8('\\');
+  const __m128i zero = _mm_setzero_si128();
+  SCAN_LOOP(__m128i, 16, _mm_load_si128, _mm_movemask_epi8,
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                      _mm_cmpeq_epi8(v, slash)),
+                         _mm_cmpeq_epi8(v, zero)))
+}
+
+// 无符号比较 v <= 0x1F 即为控制字符，包括'\0'
+JSON_SIMD("sse2") static char *escape_sse2(char *str) {
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i slash = _mm_set1_epi8('\\');
+  const __m128i ctrl = _mm_set1_epi8(0x1F);
+  SCAN_LOOP(__m128i, 16, _mm_load_si128, _mm_movemask_epi8,
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                      _mm_cmpeq_epi8(v, slash)),
+                         _mm_cmpeq_epi8(_mm_max_epu8(v, ctrl), ctrl)))
+}
+
+JSON_SIMD("avx2") static char *space_avx2(char *str) {
+  const __m256i sp = _mm256_set1_epi8(' ');
+  const __m256i zero = _mm256_setzero_si256();
+  SCAN_LOOP(__m256i, 32, _mm256_load_si256, _mm256_movemask_epi8,
+            _mm256_or_si256(_mm256_cmpgt_epi8(v, sp),
+                            _mm256_cmpeq_epi8(v, zero)))
+}
+
+JSON_SIMD("avx2") static char *line_avx2(char *str) {
+  const __m256i nl = _mm256_set1_epi8('\n');
+  const __m256i zero = _mm256_setzero_si256();
+  SCAN_LOOP(__m256i, 32, _mm256_load_si256, _mm256_movemask_epi8,
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, nl),
+                            _mm256_cmpeq_epi8(v, zero)))
+}
+
+JSON_SIMD("avx2") static char *star_avx2(char *str) {
+  const __m256i star = _mm256_set1_epi8('*');
+  const __m256i zero = _mm256_setzero_si256();
+  SCAN_LOOP(__m256i, 32, _mm256_load_si256, _mm256_movemask_epi8,
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, star),
+                            _mm256_cmpeq_epi8(v, zero)))
+}
+JSON_SIMD("avx2") static char *quote_avx2(char *str) {
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i slash = _mm256_set1_epi8('\\');
+  const __m256i zero = _mm256_setzero_si256();
+  SCAN_LOOP(__m256i, 32, _mm256_load_si256, _mm256_movemask_epi8,
+            _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                                            _mm256_cmpeq_epi8(v, slash)),
+                            _mm256_cmpeq_epi8(v, zero)))
+}
+
+JSON_SIMD("avx2") static char *escape_avx2(char *str) {
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i slash = _mm256_set1_epi8('\\');
+  const __m256i ctrl = _mm256_set1_epi8(0x1F);
+  SCAN_LOOP(__m256i, 32, _mm256_load_si256, _mm256_movemask_epi8,
+            _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                                _mm256_cmpeq_epi8(v, slash)),
+                _mm256_cmpeq_epi8(_mm256_max_epu8(v, ctrl), ctrl)))
+}
+
+JSON_SIMD("sse2") static char *backslash_sse2(char *str) {
+  const __m128i slash = _mm_set1_epi8('\\');
+  const __m128i zero = _mm_setzero_si128();
+  SCAN_LOOP(__m128i, 16, _mm_load_si128, _mm_movemask_epi8,
+            _mm_or_si128(_mm_cmpeq_epi8(v, slash), _mm_cmpeq_epi8(v, zero)))
+}
+
+JSON_SIMD("avx2") static char *backslash_avx2(char *str) {
+  const __m256i slash = _mm256_set1_epi8('\\');
+  const __m256i zero = _mm256_setzero_si256();
+  SCAN_LOOP(__m256i, 32, _mm256_load_si256, _mm256_movemask_epi8,
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, slash),
+                            _mm256_cmpeq_epi8(v, zero)))
+}
+
+/*
+ * 按查表检查utf8 (Keiser, Lemire. Validating UTF-8 In Less Than One
+ * Instruction Per Byte)。
+ * 每个字节与其前一个字节的高4位、前一个字节的低4位、本字节的高4位
+ * 各查一次表，三者按位与后非0即为错误或第3、4个字节；
+ * 再由前2、3个字节是否为3、4字节字符的开头确定哪些位置必须是第3、4个字节。
+ * 前一块按32字节保存，块之间的字节由alignr拼接
+ */
+#define UTF8_TOO_SHORT (1 << 0)
+#define UTF8_TOO_LONG (1 << 1)
+#define UTF8_OVERLONG_3 (1 << 2)
+#define UTF8_TOO_LARGE (1 << 3)
+#define UTF8_SURROGATE (1 << 4)
+#define UTF8_OVERLONG_2 (1 << 5)
+#define UTF8_TOO_LARGE_1000 (1 << 6)
+#define UTF8_OVERLONG_4 (1 << 6)
+#define UTF8_TWO_CONTS (1 << 7)
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+#define UTF8_TABLE(...) _mm256_setr_epi8(__VA_ARGS__, __VA_ARGS__)
+
+// input之前的n个字节，前面的字节来自prev
+#define UTF8_PREV(input, prev, n)                                              \
+  _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev, input, 0x21),     \
+                     16 - (n))
+
+JSON_SIMD("avx2")
+static __m256i utf8_block(__m256i input, __m256i prev) {
+  const __m256i low4 = _mm256_set1_epi8(0x0F);
+  const __m256i byte_1_high = UTF8_TABLE(
+      UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+      UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+      UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+      UTF8_TOO_SHORT | UTF8_OVERLONG_2, UTF8_TOO_SHORT,
+      UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+      UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 |
+          UTF8_OVERLONG_4);
+  const __m256i byte_1_low = UTF8_TABLE(
+      UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+      UTF8_CARRY | UTF8_OVERLONG_2, UTF8_CARRY, UTF8_CARRY,
+      UTF8_CARRY | UTF8_TOO_LARGE,
+      UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+      UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+      UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+      UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+      UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+      UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+      UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+      UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+      UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+      UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+      UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000);
+  const __m256i byte_2_high = UTF8_TABLE(
+      UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+      UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+      UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 |
+          UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+      UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 |
+          UTF8_TOO_LARGE,
+      UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE |
+          UTF8_TOO_LARGE,
+      UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE |
+          UTF8_TOO_LARGE,
+      UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT);
+
+  __m256i prev1 = UTF8_PREV(input, prev, 1);
+  __m256i special = _mm256_and_si256(
+      _mm256_and_si256(
+          _mm256_shuffle_epi8(byte_1_high, _mm256_and_si256(
+                                               _mm256_srli_epi16(prev1, 4),
+                                               low4)),
+          _mm256_shuffle_epi8(byte_1_low, _mm256_and_si256(prev1, low4))),
+      _mm256_shuffle_epi8(byte_2_high,
+                          _mm256_and_si256(_mm256_srli_epi16(input, 4), low4)));
+
+  // 前2个字节不小于0xE0或前3个字节不小于0xF0时，本字节须为后续字节
+  __m256i prev2 = UTF8_PREV(input, prev, 2);
+  __m256i prev3 = UTF8_PREV(input, prev, 3);
+  __m256i must23 = _mm256_or_si256(
+      _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0 - 0x80))),
+      _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0 - 0x80))));
+  __m256i must23_80 = _mm256_and_si256(must23, _mm256_set1_epi8((char)0x80));
+  return _mm256_xor_si256(must23_80, special);
+}
+
+// 最后3个字节为未结束的多字节字符的开头时非0
+JSON_SIMD("avx2") static __m256i utf8_incomplete(__m256i input) {
+  const __m256i max = _mm256_setr_epi8(
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xF0 - 1),
+      (char)(0xE0 - 1), (char)(0xC0 - 1));
+  return _mm256_subs_epu8(input, max);
+}
+
+JSON_SIMD("avx2") static bool utf8_avx2(const char *s, size_t len) {
+  __m256i prev = _mm256_setzero_si256();
+  __m256i incomplete = _mm256_setzero_si256();
+  __m256i error = _mm256_setzero_si256();
+  for (size_t i = 0; i < len; i += 32) {
+    __m256i input;
+    if (len - i >= 32) {
+      input = _mm256_loadu_si256((const __m256i *)(s + i));
+    } else {
+      // 末尾不足一块时补'\0'，未结束的字符由TOO_SHORT发现
+      char tail[32] = {0};
+      memcpy(tail, s + i, len - i);
+      input = _mm256_loadu_si256((const __m256i *)tail);
+    }
+    if (!_mm256_movemask_epi8(input)) {
+      // 整块为ASCII时，只需检查上一块的末尾是否已结束
+      error = _mm256_or_si256(error, incomplete);
+      incomplete = _mm256_setzero_si256();
+    } else {
+      error = _mm256_or_si256(error, utf8_block(input, prev));
+      incomplete = utf8_incomplete(input);
+    }
+    prev = input;
+  }
+  error = _mm256_or_si256(error, incomplete);
+  return _mm256_testz_si256(error, error);
+}
+
+/*
+ * 块掩码按16/32字节分段比较后拼接为64位。
+ * `{`与`[`、`}`与`]`只相差0x20，或上0x20后各用一次比较
+ */
+#define BLOCK_MASKS(vec, width, loadu, set1, or, cmpeq, movemask)             \
+  const vec quote = set1('"');                                                 \
+  const vec backslash = set1('\\');                                            \
+  const vec slash = set1('/');                                                 \
+  const vec lower = set1(0x20);                                                \
+  const vec open = set1('{');                                                  \
+  const vec close = set1('}');                                                 \
+  const vec comma = set1(',');                                                 \
+  *m = (struct block_masks){0};                                                \
+  for (int i = 0; i < 64; i += width) {                                        \
+    vec v = loadu((const vec *)(p + i));                                       \
+    vec l = or(v, lower);                                                      \
+    m->quote |= (uint64_t)(uint32_t)movemask(cmpeq(v, quote)) << i;            \
+    m->backslash |= (uint64_t)(uint32_t)movemask(cmpeq(v, backslash)) << i;    \
+    m->slash |= (uint64_t)(uint32_t)movemask(cmpeq(v, slash)) << i;            \
+    m->open |= (uint64_t)(uint32_t)movemask(cmpeq(l, open)) << i;              \
+    m->close |= (uint64_t)(uint32_t)movemask(cmpeq(l, close)) << i;            \
+    m->comma |= (uint64_t)(uint32_t)movemask(cmpeq(v, comma)) << i;            \
+  }
+
+JSON_SIMD("sse2")
+static void block_sse2(const char *p, struct block_masks *m) {
+  BLOCK_MASKS(__m128i, 16, _mm_loadu_si128, _mm_set1_epi8, _mm_or_si128,
+              _mm_cmpeq_epi8, _mm_movemask_epi8)
+}
+
+JSON_SIMD("avx2")
+static void block_avx2(const char *p, struct block_masks *m) {
+  BLOCK_MASKS(__m256i, 32, _mm256_loadu_si256, _mm256_set1_epi8,
+              _mm256_or_si256, _mm256_cmpeq_epi8, _mm256_movemask_epi8)
+}
+#endif
+
+static char *space_init(char *str);
+static char *line_init(char *str);
+static char *star_init(char *str);
+static char *quote_init(char *str);
+static char *escape_init(char *str);
+static void block_init(const char *p, struct block_masks *m);
+static char *backslash_init(char *str);
+static bool utf8_init(const char *s, size_t len);
+
+// 加载时或首次调用时按CPU选择实现
+static struct scan_kernel scan = {space_init,     line_init,   star_init,
+                                  quote_init,     escape_init, block_init,
+                                  backslash_init, utf8_init};
+
+/**
+ * @brief 按CPU支持的指令集选择扫描kernel
+ *
+ * AVX2 优先，其次 SSE2，都不支持时使用按字节的实现
+ */
+static void scan_select(void) {
+#ifdef JSON_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    scan = (struct scan_kernel){space_avx2,     line_avx2,   star_avx2,
+                                quote_avx2,     escape_avx2, block_avx2,
+                                backslash_avx2, utf8_avx2};
+    return;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    // 查表需要SSSE3的pshufb，SSE2按8字节跳过ASCII
+    scan = (struct scan_kernel){space_sse2,     line_sse2,   star_sse2,
+                                quote_sse2,     escape_sse2, block_sse2,
+                                backslash_sse2, utf8_scalar};
+    return;
+  }
+#endif
+  scan = (struct scan_kernel){space_scalar,     line_scalar,   star_scalar,
+                              quote_scalar,     escape_scalar, block_scalar,
+                              backslash_scalar, utf8_scalar};
+}
+
+#ifdef __GNUC__
+// 加载时即选择实现，解析线程启动前scan已不再改变，之后只读取
+__attribute__((constructor)) static void scan_load(void) { scan_select(); }
+#endif
+
+/**
+ * @brief 首次调用时选择实现，多个线程同时调用时只选择一次
+ */
+static void scan_init(void) {
+#ifdef JSON_POSIX
+  static pthread_once_t once = PTHREAD_ONCE_INIT;
+  pthread_once(&once, scan_select);
+#else
+  scan_select();
+#endif
+}
+
+static char *space_init(char *str) {
+  scan_init();
+  return scan.space(str);
+}
+
+static char *line_init(char *str) {
+  scan_init();
+  return scan.line(str);
+}
+
+static char *star_init(char *str) {
+  scan_init();
+  return scan.star(str);
+}
+
+static char *quote_init(char *str) {
+  scan_init();
+  return scan.quote(str);
+}
+
+static char *escape_init(char *str) {
+  scan_init();
+  return scan.escape(str);
+}
+
+static void block_init(const char *p, struct block_masks *m) {
+  scan_init();
+  scan.block(p, m);
+}
+
+static char *backslash_init(char *str) {
+  scan_init();
+  return scan.backslash(str);
+}
+
+static bool utf8_init(const char *s, size_t len) {
+  scan_init();
+  return scan.utf8(s, len);
+}
+
 /**
  * @brief 跳过空白和注释
  *
@@ -15,23 +690,23 @@ static char *skip(char *str) {
 continueskip:
 
   // 跳过除'\0'外所有控制字符和空白
-  while (*str <= ' ' && *str)
-    str++;
+  // 紧凑的json中多数位置没有空白，先按字节判断，避免向量化的开销
+  if (*str <= ' ' && *str)
+    str = scan.space(str + 1);
 
   // 检查是否为注释
   if (*str == '/') {
 
     // 跳过注释 `//`
     if (*(str + 1) == '/') {
-      while (*str != '\n' && *str)
-        str++;
+      str = scan.line(str + 2);
       goto continueskip;
     }
 
     // 跳过注释 `/* */`
     if (*(str + 1) == '*') {
       str += 2;
-      while (!(*str == '*' && *(str + 1) == '/') && *str)
+      while (*(str = scan.star(str)) && *(str + 1) != '/')
         str++;
       if (*str == '*')
         str += 2;
@@ -41,25 +716,67 @@ continueskip:
   return str;
 }
 
+/**
+ * @brief 读取4位hex
+ *
+ * 逐个读取，遇到非hex字符时停止，不会越过字符串结尾的'\0'
+ *
+ * @param p 第一位hex
+ * @param out 修改为读取的数字
+ * @return bool 不足4位时返回false
+ */
+static bool hex4(const char *p, uint32_t *out) {
+  uint32_t hex = 0;
+  for (int i = 0; i < 4; i++) {
+    char ch = p[i];
+    if (ch >= '0' && ch <= '9')
+      hex = (hex << 4) + ch - '0';
+    else if (ch >= 'a' && ch <= 'f')
+      hex = (hex << 4) + ch - 'a' + 10;
+    else if (ch >= 'A' && ch <= 'F')
+      hex = (hex << 4) + ch - 'A' + 10;
+    else
+      return false;
+  }
+  *out = hex;
+  return true;
+}
+
 /**
  * @brief 4位hex转为utf8编码字符串
  *
+ * 高代理项之后紧跟`\u`低代理项时，两者合并为一个4字节的字符；
+ * 单独的代理项仍按3字节编码
+ *
  * @param write 写入对象，并修改指向最后一个写入字符的下一字符
  * @param from 读取对象，从u开始，修改为指向最后一位hex
+ * 不足4位时指向最后一个已读取的字符
  */
 static void hex4ToUtf8(char **write, char **from) {
 
-  // 将4个hex字符转为数字hex
+  // 将4个hex字符转为数字hex，遇到非hex字符时停止，不会越过字符串结尾
   uint32_t hex = 0;
   for (int i = 0; i < 4; i++) {
-    char ch = *(++(*from));
+    char ch = *(*from + 1);
     if (ch >= '0' && ch <= '9') {
       hex = (hex << 4) + ch - '0';
     } else if (ch >= 'a' && ch <= 'f') {
       hex = (hex << 4) + ch - 'a' + 10;
     } else if (ch >= 'A' && ch <= 'F') {
       hex = (hex << 4) + ch - 'A' + 10;
+    } else {
+      break;
     }
+    (*from)++;
+  }
+
+  // 代理对
+  uint32_t low;
+  if (hex >= 0xD800 && hex < 0xDC00 && (*from)[1] == '\\' &&
+      (*from)[2] == 'u' && hex4(*from + 3, &low) && low >= 0xDC00 &&
+      low < 0xE000) {
+    hex = 0x10000 + ((hex - 0xD800) << 10) + (low - 0xDC00);
+    *from += 6;
   }
 
   // 将数字hex转化为utf8编码的字符串
@@ -72,896 +789,6499 @@ static void hex4ToUtf8(char **write, char **from) {
     *((*write)++) = hex >> 12 | 0xE0;       // 0xE0 1110 0000
     *((*write)++) = hex >> 6 & 0x3F | 0x80; // 0x80 1000 0000
     *((*write)++) = hex & 0x3F | 0x80;
+  } else {
+    *((*write)++) = (hex >> 18) | 0xF0; // 0xF0 1111 0000
+    *((*write)++) = ((hex >> 12) & 0x3F) | 0x80;
+    *((*write)++) = ((hex >> 6) & 0x3F) | 0x80;
+    *((*write)++) = (hex & 0x3F) | 0x80;
   }
 }
 
 /**
- * @brief 解析字符串并储存
+ * @brief 检查一个转义
  *
- * @param s 从*s开始读取，确保**s为`"`，并修改*s为这个字符串末尾`"`后
- * @return char* 返回为 malloc，解析后的字符串
+ * 转义只能为`\"` `\\` `\/` `\b` `\f` `\n` `\r` `\t`和4位hex的`\u`，
+ * 代理项必须成对出现
+ *
+ * @param s `\\`
+ * @param end 输入的结尾
+ * @return size_t 合法时返回字节数，否则为0
  */
-static char *parse_str(char **s) {
-  char *str = *s;
-  if (*str != '"')
-    return NULL;
-  // 将str修改为字符串开始`"`之后
-  str++;
-  // 将*s修改为字符串结尾`"`之后
-  while (*(++(*s)) != '"' || *((*s) - 1) == '\\')
-    if (!**s)
-      return NULL;
-  (*s)++;
-
-  // 根据估算的字符串最大长度申请内存
-  char *ret = malloc(*s - str);
-
-  // 从str解析字符串到ret
-  char *write = ret;
-  while (*str != '"') {
+static size_t escape_seq(const char *s, const char *end) {
+  size_t left = end - s;
+  if (left < 2)
+    return 0;
+  if (s[1] && strchr("\"\\/bfnrt", s[1]))
+    return 2;
+  uint32_t hex, low;
+  if (s[1] != 'u' || left < 6 || !hex4(s + 2, &hex))
+    return 0;
+  if (hex < 0xD800 || hex >= 0xE000)
+    return 6;
+  if (hex >= 0xDC00 || left < 12 || s[6] != '\\' || s[7] != 'u' ||
+      !hex4(s + 8, &low) || low < 0xDC00 || low >= 0xE000)
+    return 0;
+  return 12;
+}
 
-    if (*str == '\\') {
-      str++;
-      // 转义字符解码
-      switch (*str) {
-      case '"':
-        *(write++) = '\"';
-        break;
-      case '\\':
-        *(write++) = '\\';
-        break;
-      case '/':
-        *(write++) = '/';
-        break;
-      case 'b':
-        *(write++) = '\b';
-        break;
-      case 'f':
-        *(write++) = '\f';
-        break;
-      case 'n':
-        *(write++) = '\n';
-        break;
-      case 'r':
-        *(write++) = '\r';
-        break;
-      case 't':
-        *(write++) = '\t';
-        break;
-      case 'u':
-        hex4ToUtf8(&write, &str);
-      }
-      str++;
-      continue;
-    }
-    *(write++) = *(str++);
+/**
+ * @brief 检查一个多字节的utf8字符
+ *
+ * 不能是超长编码、代理项或大于U+10FFFF
+ *
+ * @param p 非ASCII字节
+ * @param left 剩余的字节数
+ * @return size_t 合法时返回字节数，否则为0
+ */
+static size_t utf8_seq(const unsigned char *p, size_t left) {
+  // 第二个字节的范围排除超长编码、代理项和超出范围的字符
+  size_t n;
+  unsigned char lo = 0x80, hi = 0xBF;
+  if (*p >= 0xC2 && *p <= 0xDF) {
+    n = 2;
+  } else if (*p >= 0xE0 && *p <= 0xEF) {
+    n = 3;
+    if (*p == 0xE0)
+      lo = 0xA0;
+    else if (*p == 0xED)
+      hi = 0x9F;
+  } else if (*p >= 0xF0 && *p <= 0xF4) {
+    n = 4;
+    if (*p == 0xF0)
+      lo = 0x90;
+    else if (*p == 0xF4)
+      hi = 0x8F;
+  } else {
+    return 0;
   }
-  *(write++) = '\0';
-
-  // 重新分配大小，释放多余内存
-  ret = realloc(ret, write - ret);
-  return ret;
+  if (left < n || p[1] < lo || p[1] > hi)
+    return 0;
+  for (size_t i = 2; i < n; i++)
+    if ((p[i] & 0xC0) != 0x80)
+      return 0;
+  return n;
 }
 
 /**
- * @brief 申请一块内存储存json节点
+ * @brief JSON_STRICT 时检查输入中的utf8编码与转义
  *
- * @return json* 如果失败返回NULL
+ * utf8由向量化的kernel按块检查，之后只逐个检查`\\`开始的转义。
+ * 注释中的`\\`同样按转义检查
+ *
+ * @param s 输入
+ * @param end 输入的结尾
+ * @param padded 为true时*end为'\0'，可以使用向量化的kernel查找`\\`
+ * @return bool 含有非法的utf8、转义或'\0'时返回false
  */
-static json *json_create() { return malloc(sizeof(json)); }
+static bool strict_check(const char *s, const char *end, bool padded) {
+  if (!scan.utf8(s, end - s))
+    return false;
+  for (;;) {
+    if (padded) {
+      s = scan.backslash((char *)s);
+    } else {
+      while (s < end && *s != '\\' && *s)
+        s++;
+    }
+    if (s >= end)
+      return true;
+    size_t n = *s ? escape_seq(s, end) : 0;
+    if (!n)
+      return false;
+    s += n;
+  }
+}
 
 /**
- * @brief 从字符串开头的“跳转到结尾”
+ * @brief 查找字符串结尾的`"`
  *
- * @param str 第一个字符为`"`
- * @return char* 返回指向`"`的下一个字符
+ * 每次跳到下一个`"`或`\\`，`\\`总是与其后一个字符组成转义，
+ * 因此连续的`\\\\`之后的`"`能正确识别为结尾
+ *
+ * @param str 从字符串开始`"`之后读取
+ * @return char* 返回结尾`"`的指针，字符串未结束时返回NULL
  */
-static char *nest_match_str(char *str) {
-  str++;
-  while (*(str++) != '"' || *(str - 1) == '\\')
-    continue;
-  return str;
+static char *str_end(char *str) {
+  for (;;) {
+    str = scan.quote(str);
+    if (*str == '"')
+      return str;
+    if (!*str || !*(str + 1))
+      return NULL;
+    str += 2;
+  }
 }
 
 /**
- * @brief 符号匹配
+ * @brief 将转义的字符串解码到write
  *
- * 向后匹配同一层级的符号
+ * 不含转义的片段整块复制
  *
- * @param str 第一个字符为匹配对象，向后匹配
- * @return char* 返回匹配到的符号的下一字符的指针
+ * @param write 写入位置，可以与*from相同
+ * @param from 从字符串开始`"`之后读取，修改为结尾`"`之后
+ * @return char* 返回写入的'\0'的下一个字符，字符串未结束时返回NULL
  */
-static char *nest_match(char *str) {
-  char l = *str;
-  char r;
-  switch (l) {
-  case '[':
-    r = ']';
-    break;
-  case '{':
-    r = '}';
-    break;
-  case '(':
-    r = ')';
-    break;
-  default:
-    return str;
-  }
+static char *unescape_str(char *write, char **from) {
+  char *str = *from;
+  for (;;) {
+    // 复制到下一个`"`或`\\`之前
+    char *end = scan.quote(str);
+    if (write != str)
+      memmove(write, str, end - str);
+    write += end - str;
+    str = end;
 
-  unsigned int level = 0;
-  do {
-    if (*str == l)
-      level++;
-    if (*str == r)
-      level--;
     if (*str == '"')
-      str = nest_match_str(str);
-    else
-      str++;
-  } while (level);
-  return str;
-}
+      break;
+    if (!*str || !*(str + 1))
+      return NULL;
 
-// 因为parse_object 要调用此函数，提前声明一下
-static void parse_array(char **s, json *item);
+    str++;
+    // 转义字符解码
+    switch (*str) {
+    case '"':
+      *(write++) = '\"';
+      break;
+    case '\\':
+      *(write++) = '\\';
+      break;
+    case '/':
+      *(write++) = '/';
+      break;
+    case 'b':
+      *(write++) = '\b';
+      break;
+    case 'f':
+      *(write++) = '\f';
+      break;
+    case 'n':
+      *(write++) = '\n';
+      break;
+    case 'r':
+      *(write++) = '\r';
+      break;
+    case 't':
+      *(write++) = '\t';
+      break;
+    case 'u':
+      hex4ToUtf8(&write, &str);
+    }
+    str++;
+  }
+  *(write++) = '\0';
+  *from = str + 1;
+  return write;
+}
 
 /**
- * @brief 解析json对象
+ * @brief 解析字符串并储存
  *
- * @param s 从*s字符串中解析，确保**s为`{`
- * 并修改*s指向json对象结束的下一个字符
- * @return json* 返回该json对象的首个item的指针
+ * 解码后的字符串不会长于原文，JSON_INSITU 模式下直接解码到原文中，
+ * 结尾的`"`之前写入'\0'，返回的指针指向输入缓冲区
+ *
+ * @param s 从*s开始读取，确保**s为`"`，并修改*s为这个字符串末尾`"`后
+ * @return char* 返回由ctx申请的，解析后的字符串
  */
-static json *parse_object(char **s) {
+static char *parse_str(struct parse_ctx *ctx, char **s) {
   char *str = *s;
-  if (*str != '{')
+  if (*str != '"')
     return NULL;
+  // 将str修改为字符串开始`"`之后
   str++;
-  str = skip(str);
-  json *ret = NULL;
-  json *head;
-  do {
-    // 忽略 `,`
-    while (*str == ',') {
-      str++;
-      str = skip(str);
-    }
-
-    // 解析 key
-    if (*str == '}')
-      break;
-    if (*str != '"')
-      return NULL;
-    char *key = parse_str(&str);
-    if (!str)
-      return NULL;
 
-    // 检测语法 `:`
-    str = skip(str);
-    if (*str != ':') {
-      free(key);
+  // 原地解码时写入位置总不超过读取位置，无需预先查找结尾
+  if (ctx->flags & JSON_INSITU) {
+    char *ret = str;
+    if (!unescape_str(str, &str))
       return NULL;
-    }
-    str++;
+    *s = str;
+    return ret;
+  }
 
-    // 创建json节点
-    if (ret)
-      head = head->next = json_create();
-    else
-      ret = head = json_create();
-    head->key = key;
+  // 根据字符串的最大长度申请内存
+  char *end = str_end(str);
+  if (!end)
+    return NULL;
+  size_t cap = end - str + 1;
+  char *ret = ctx_alloc(ctx, cap);
+  if (!ret)
+    return NULL;
+  char *write = unescape_str(ret, &str);
+  *s = str;
 
-    // 解析 value
-    str = skip(str);
+  // 重新分配大小，释放多余内存
+  return ctx_shrink(ctx, ret, cap, write - ret);
+}
 
-    if (*str == '"') {
-      // value 为字符串
-      head->value_type = json_String;
-      head->value.String = parse_str(&str);
+/**
+ * @brief 申请一块内存储存json节点
+ *
+ * @param ctx 解析上下文
+ * @return json* 如果失败返回NULL
+ */
+static json *json_create(struct parse_ctx *ctx) {
+  return ctx_alloc(ctx, sizeof(json));
+}
 
-    } else if ((*str >= '0' && *str <= '9') || *str == '-') {
-      // value 为数字类型
+/**
+ * @brief 对象成员的哈希索引
+ *
+ * 线性探测的开放寻址哈希表，slots 数量为 mask + 1，
+ * 同名的key按出现顺序排列在探测序列上，查找时返回第一个
+ */
+struct json_slot {
+  uint32_t hash;
+  uint32_t len;
+  json *node;
+};
+struct json_index {
+  size_t mask;
+  struct json_slot slots[];
+};
 
-      // 审查数字是否为浮点类型，并将str推向数字后
-      char *temp = str;
-      bool isfloat = false;
-      while (str++) {
-        if (*str >= '0' && *str <= '9' || *str == '-')
-          continue;
-        else if (*str == '.' || *str == 'e' || *str == 'E')
-          isfloat = true;
-        else
-          break;
-      }
+/**
+ * @brief 对象成员链表的头部信息
+ *
+ * 由解析器与对象中第一个值不是数组的成员节点一起申请，位于该节点之后，
+ * 节点的起始地址仍是申请的起始地址；该节点的len带有 JSON_LEN_HEAD。
+ * 手动建立的对象没有头部
+ */
+struct json_head {
+  struct json_index *index;
+};
 
-      // 将数字转化为json的值
-      if (isfloat) {
-        head->value_type = json_Float;
-        head->value.Float = atof(temp);
-      } else {
-        head->value_type = json_Int;
-        head->value.Int = atol(temp);
-      }
+// 值不是数组的节点，len的高3位为解析器的标记，其余位为0或延迟的值的偏移
+#define JSON_LEN_HEAD 0x80000000u   // 节点之后带有 json_head
+#define JSON_LEN_KEY 0x40000000u    // key与节点一起申请
+#define JSON_LEN_STR 0x20000000u    // 字符串值与节点一起申请
+#define JSON_LEN_FLAGS 0xE0000000u  // 全部标记位
+#define JSON_LEN_OFFSET 0x1FFFFFFFu // 带有标记时延迟的值的偏移
 
-    } else if (*str == '{') {
-      // value 为 object
-      head->value_type = json_Json;
-      head->value.Json = parse_object(&str);
+/**
+ * @brief 申请对象的成员节点，节点之后带有extra字节，用于储存短的key与值
+ *
+ * @param ctx 解析上下文
+ * @param headed 节点之后是否带有 json_head，位于extra之前
+ * @param extra 节点之后的字节数
+ * @return json* 如果失败返回NULL
+ */
+static json *json_create_member(struct parse_ctx *ctx, bool headed,
+                                size_t extra) {
+  size_t size = sizeof(json) + extra;
+  if (headed)
+    size += sizeof(struct json_head);
+  json *node = ctx_alloc(ctx, size);
+  if (node && headed)
+    ((struct json_head *)(node + 1))->index = NULL;
+  return node;
+}
 
-    } else if (*str == '[') {
-      // value 为 array
-      parse_array(&str, head);
+/**
+ * @brief 成员节点之后储存短字符串的位置
+ *
+ * key与字符串值依次在 json_head 之后，是否与节点一起申请由len中的
+ * JSON_LEN_KEY 与 JSON_LEN_STR 记录，不由地址判断
+ *
+ * @param node 成员节点
+ * @param headed 节点之后是否带有 json_head
+ * @return char*
+ */
+static char *member_tail(json *node, bool headed) {
+  char *tail = (char *)(node + 1);
+  return headed ? tail + sizeof(struct json_head) : tail;
+}
 
-    } else {
-      // value 为 null 或 bool 类型
-      if (!strncmp("null", str, 4)) {
-        head->value_type = json_Null;
-        str += 4;
-      } else if (!strncmp("true", str, 4)) {
-        head->value_type = json_Bool;
-        head->value.Bool = true;
-        str += 4;
-      } else if (!strncmp("false", str, 5)) {
-        head->value_type = json_Bool;
-        head->value.Bool = false;
-        str += 5;
-      }
-    }
+/**
+ * @brief 短字符串的原文长度
+ *
+ * @param str 字符串开始的`"`
+ * @return size_t 原文不长于 JSON_SHORT_STR 时返回包括'\0'的字节数，否则为0
+ */
+static size_t short_str(char *str) {
+  char *end = str_end(str + 1);
+  if (!end || end - str - 1 > JSON_SHORT_STR)
+    return 0;
+  return end - str;
+}
 
-    str = skip(str);
-  } while (*str == ',');
-  head->next = NULL;
+/**
+ * @brief 对象的头部信息
+ *
+ * @param node len带有 JSON_LEN_HEAD 的成员节点
+ * @return struct json_head*
+ */
+static struct json_head *object_head(const json *node) {
+  return (struct json_head *)(node + 1);
+}
 
-  if (*str == '}') {
-    *s = str + 1;
-    return ret;
+/**
+ * @brief 计算key的哈希值
+ *
+ * @param key
+ * @param len key的长度
+ * @return uint32_t
+ */
+static uint32_t key_hash(const char *key, size_t len) {
+  uint64_t h = 0x9E3779B97F4A7C15ull ^ len;
+  for (; len >= 8; key += 8, len -= 8) {
+    uint64_t v;
+    memcpy(&v, key, 8);
+    h = (h ^ v) * 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 31;
   }
-  *s = str;
-  return ret;
+  uint64_t v = 0;
+  memcpy(&v, key, len);
+  h = (h ^ v) * 0x94D049BB133111EBull;
+  h ^= h >> 29;
+  return (uint32_t)h;
 }
 
 /**
- * @brief 解析元素均为字符串的数组
+ * @brief 驻留字符串的头部，位于字符串之前
+ */
+struct intern_head {
+  uint32_t hash;
+  uint32_t len;
+};
+
+/**
+ * @brief 文档的字符串驻留表
  *
- * @param s 从s开始解析，应保证*s==[
- * @param nums 元素个数
- * @return union 返回Strings
+ * 线性探测的开放寻址哈希表，strs 指向arena中带有 intern_head 的字符串，
+ * 数量为 mask + 1，nums 为已驻留的个数
  */
-static union json_value parse_array_strings(char *s, size_t nums) {
-  // 初始化Strings
-  union json_value ret;
-  ret.Strings = malloc(sizeof(char *) * (nums + 1));
-  ret.Strings[nums] = NULL;
+struct json_intern {
+  size_t mask;
+  size_t nums;
+  char **strs;
+};
 
-  // 解析Strings
-  char *str = s;
-  str++;
-  str = skip(str);
-  for (size_t i = 0; i < nums; i++) {
-    // 忽略`,`
-    while (*str == ',') {
-      str++;
-      str = skip(str);
-    }
-    ret.Strings[i] = parse_str(&str);
-    str = skip(str);
-  }
-  return ret;
+static struct intern_head *intern_head(const char *str) {
+  return (struct intern_head *)str - 1;
 }
 
 /**
- * @brief 解析元素均为json的数组
+ * @brief 在驻留表中查找
  *
- * @param s 从s开始解析，应保证*s==[
- * @param nums 元素个数
- * @return union 返回Jsons
+ * @param t 驻留表，可以为NULL
+ * @return char* 未找到返回NULL
  */
-static union json_value parse_array_jsons(char *s, size_t nums) {
-  // 初始化Jsons
-  union json_value ret;
-  ret.Strings = malloc(sizeof(json *) * (nums + 1));
-  ret.Strings[nums] = NULL;
-
-  // 解析Jsons
-  char *str = s;
-  str++;
-  str = skip(str);
-  for (size_t i = 0; i < nums; i++) {
-    // 忽略`,`
-    while (*str == ',') {
-      str++;
-      str = skip(str);
-    }
-    ret.Jsons[i] = parse_object(&str);
-    str = skip(str);
+static char *intern_find(const struct json_intern *t, const char *str,
+                         size_t len, uint32_t hash) {
+  if (!t)
+    return NULL;
+  for (size_t i = hash & t->mask; t->strs[i]; i = (i + 1) & t->mask) {
+    struct intern_head *h = intern_head(t->strs[i]);
+    if (h->hash == hash && h->len == len && !memcmp(t->strs[i], str, len))
+      return t->strs[i];
   }
-  return ret;
+  return NULL;
 }
 
 /**
- * @brief 解析元素均为整数的数组
+ * @brief 将已在arena中的驻留字符串加入驻留表，装载因子不超过1/2
  *
- * @param s 从s开始解析，应保证*s==[
- * @param nums 元素个数
- * @return union 返回Ints
+ * @param doc 文档，第一次加入时创建驻留表
+ * @param str 带有 intern_head 的字符串，表中尚无与其相同的字符串
+ * @return bool 申请内存失败时返回false，字符串仍然有效，只是不被复用
  */
-static union json_value parse_array_ints(char *s, size_t nums) {
-  // 初始化Ints
-  union json_value ret;
-  ret.Ints = malloc(sizeof(long) * nums);
-
-  //解析Ints
-  char *str = s;
-  str++;
-  str = skip(str);
-  for (size_t i = 0; i < nums; i++) {
-    // 忽略`,`
-    while (*str == ',') {
-      str++;
-      str = skip(str);
+static bool intern_insert(json_doc *doc, char *str) {
+  struct json_intern *t = doc->intern;
+  if (!t) {
+    if (!(t = malloc(sizeof(struct json_intern))))
+      return false;
+    if (!(t->strs = calloc(64, sizeof(char *)))) {
+      free(t);
+      return false;
     }
-    ret.Ints[i] = atol(str);
-    while (str++) {
-      if (*str >= '0' && *str <= '9' || *str == '-')
+    t->mask = 63;
+    t->nums = 0;
+    doc->intern = t;
+  }
+  if ((t->nums + 1) * 2 > t->mask + 1) {
+    size_t cap = (t->mask + 1) * 2;
+    char **strs = calloc(cap, sizeof(char *));
+    if (!strs)
+      return false;
+    for (size_t i = 0; i <= t->mask; i++) {
+      if (!t->strs[i])
         continue;
-      else
-        break;
+      size_t j = intern_head(t->strs[i])->hash & (cap - 1);
+      while (strs[j])
+        j = (j + 1) & (cap - 1);
+      strs[j] = t->strs[i];
     }
-    str = skip(str);
+    free(t->strs);
+    t->strs = strs;
+    t->mask = cap - 1;
   }
-  return ret;
+  size_t i = intern_head(str)->hash & t->mask;
+  while (t->strs[i])
+    i = (i + 1) & t->mask;
+  t->strs[i] = str;
+  t->nums++;
+  return true;
 }
 
 /**
- * @brief 解析元素均为浮点数的数组
+ * @brief 释放驻留表，表中的字符串随arena释放
  *
- * @param s 从s开始解析，应保证*s==[
- * @param nums 元素个数
- * @return union 返回Floats
+ * @param t 可以为NULL
  */
-static union json_value parse_array_floats(char *s, size_t nums) {
-  // 初始化Floats
-  union json_value ret;
-  ret.Floats = malloc(sizeof(double) * nums);
+static void intern_free(struct json_intern *t) {
+  if (t)
+    free(t->strs);
+  free(t);
+}
 
-  //解析Floats
-  char *str = s;
-  str++;
-  str = skip(str);
-  for (size_t i = 0; i < nums; i++) {
-    // 忽略`,`
-    while (*str == ',') {
-      str++;
-      str = skip(str);
-    }
-    ret.Floats[i] = atof(str);
-    while (str++) {
-      if (*str >= '0' && *str <= '9' || *str == '-' || *str == '.' ||
-          *str == 'e' || *str == 'E')
-        continue;
-      else
-        break;
+/**
+ * @brief 解析字符串并驻留，文档中相同的字符串共用一份
+ *
+ * 解码到arena顶部后查找，已驻留时归还刚申请的内存；
+ * JSON_INSITU 时原地解码，只在第一次出现时复制到arena中
+ *
+ * @param s 从*s开始读取，确保**s为`"`，并修改*s为这个字符串末尾`"`后
+ * @param max 解码后长于max字节的字符串不驻留，按parse_str储存
+ * @return char* 驻留的字符串，失败或长于4GiB时返回NULL
+ */
+static char *parse_str_intern(struct parse_ctx *ctx, char **s, size_t max) {
+  char *str = *s + 1;
+  json_doc *doc = ctx->doc;
+  char *ret;
+  size_t len;
+  if (ctx->flags & JSON_INSITU) {
+    char *write = unescape_str(str, &str);
+    if (!write)
+      return NULL;
+    ret = *s + 1;
+    len = write - ret - 1;
+    *s = str;
+    if (len > max)
+      return ret;
+    if (len > UINT32_MAX)
+      return NULL;
+    uint32_t hash = key_hash(ret, len);
+    char *found = intern_find(doc->intern, ret, len, hash);
+    if (found)
+      return found;
+    struct intern_head *h = arena_alloc(doc, sizeof(*h) + len + 1);
+    if (!h)
+      return NULL;
+    h->hash = hash;
+    h->len = (uint32_t)len;
+    ret = memcpy(h + 1, ret, len + 1);
+  } else {
+    char *end = str_end(str);
+    if (!end)
+      return NULL;
+    size_t cap = end - str + 1;
+    if (cap - 1 > max)
+      return parse_str(ctx, s);
+    if (cap > UINT32_MAX)
+      return NULL;
+    size_t size = sizeof(struct intern_head) + cap;
+    struct intern_head *h = arena_alloc(doc, size);
+    if (!h)
+      return NULL;
+    ret = (char *)(h + 1);
+    len = unescape_str(ret, &str) - ret - 1;
+    *s = str;
+    h->hash = key_hash(ret, len);
+    h->len = (uint32_t)len;
+    char *found = intern_find(doc->intern, ret, len, h->hash);
+    if (found) {
+      ctx_shrink(ctx, h, size, 0);
+      return found;
     }
-    str = skip(str);
+    ctx_shrink(ctx, h, size, sizeof(*h) + len + 1);
   }
+  intern_insert(doc, ret);
   return ret;
 }
 
 /**
- * @brief 解析元素均为布尔的数组
+ * @brief 为对象建立成员的哈希索引
  *
- * @param s 从s开始解析，应保证*s==[
- * @param nums 元素个数
- * @return union 返回Bools
+ * @param ctx 解析上下文
+ * @param first 对象的首个成员节点
+ * @param nums 成员个数
+ * @param headed 带有 json_head 的成员节点，为NULL时不建立索引
  */
-static union json_value parse_array_bools(char *s, size_t nums) {
-  // 初始化Bools
-  union json_value ret;
-  ret.Bools = malloc(sizeof(bool) * nums);
+static void build_index(struct parse_ctx *ctx, json *first, size_t nums,
+                        json *headed) {
+  if (!headed)
+    return;
+  // 装载因子不超过1/2
+  size_t cap = 2;
+  while (cap < nums * 2)
+    cap <<= 1;
+  struct json_index *index =
+      ctx_alloc(ctx, sizeof(struct json_index) + sizeof(struct json_slot) * cap);
+  if (!index)
+    return;
+  index->mask = cap - 1;
+  memset(index->slots, 0, sizeof(struct json_slot) * cap);
 
-  //解析Bools
-  char *str = s;
-  str++;
-  str = skip(str);
-  for (size_t i = 0; i < nums; i++) {
-    // 忽略`,`
-    while (*str == ',') {
-      str++;
-      str = skip(str);
-    }
-    if (!strncmp("true", str, 4)) {
-      str += 4;
-      ret.Bools[i] = true;
-    } else if (!strncmp("flase", str, 5)) {
-      str += 5;
-      ret.Bools[i] = false;
+  // 驻留的key带有长度与哈希值
+  bool interned = ctx->doc && (ctx->flags & JSON_INTERN);
+  for (json *next = first; next; next = next->next) {
+    size_t len;
+    uint32_t hash;
+    if (interned) {
+      len = intern_head(next->key)->len;
+      hash = intern_head(next->key)->hash;
+    } else {
+      len = strlen(next->key);
+      hash = key_hash(next->key, len);
     }
-    str = skip(str);
+    size_t i = hash & index->mask;
+    while (index->slots[i].node)
+      i = (i + 1) & index->mask;
+    index->slots[i].hash = hash;
+    index->slots[i].len = len;
+    index->slots[i].node = next;
   }
-  return ret;
+  object_head(headed)->index = index;
 }
 
 /**
- * @brief 解析混合元素的数组
+ * @brief 从字符串开头的“跳转到结尾”
  *
- * @param s 从s开始解析，应保证*s==[
- * @param nums 元素个数
- * @return union 返回Mix
+ * @param str 第一个字符为`"`
+ * @return char* 返回指向`"`的下一个字符，字符串未结束时返回结尾的'\0'
  */
-static union json_value parse_array_Mix(char *s, size_t nums) {
-  char *str = s;
-  str++;
-  str = skip(str);
-  union json_value ret;
-  ret.Mix = NULL;
-  json *head = NULL;
-  for (size_t i = 0; i < nums; i++) {
-    // 忽略`,`
-    while (*str == ',') {
-      str++;
-      str = skip(str);
-    }
-    // 创建json节点
-    if (ret.Mix)
-      head = head->next = json_create();
-    else
-      ret.Mix = head = json_create();
-    head->key = NULL;
-
-    // 判断元素并解析到json节点
-    if (*str == '"') {
-      // 数组元素为字符串
-      head->value_type = json_String;
-      head->value.String = parse_str(&str);
-
-    } else if ((*str >= '0' && *str <= '9') || *str == '-') {
-      // value 为数字类型
+static char *nest_match_str(char *str) {
+  char *end = str_end(str + 1);
+  if (!end)
+    return str + strlen(str);
+  return end + 1;
+}
 
-      // 审查数字是否为浮点类型，并将str推向数字后
-      char *temp = str;
-      bool isfloat = false;
-      while (str++) {
-        if (*str >= '0' && *str <= '9' || *str == '-')
-          continue;
-        else if (*str == '.' || *str == 'e' || *str == 'E')
-          isfloat = true;
-        else
-          break;
+/**
+ * @brief 符号匹配
+ *
+ * 向后匹配同一层级的符号
+ *
+ * @param str 第一个字符为匹配对象，向后匹配
+ * @return char* 返回匹配到的符号的下一字符的指针
+ */
+static char *nest_match(char *str) {
+  char l = *str;
+  char r;
+  switch (l) {
+  case '[':
+    r = ']';
+    break;
+  case '{':
+    r = '}';
+    break;
+  case '(':
+    r = ')';
+    break;
+  default:
+    return str;
+  }
+
+  unsigned int level = 0;
+  do {
+    if (*str == l)
+      level++;
+    if (*str == r)
+      level--;
+    if (*str == '"')
+      str = nest_match_str(str);
+    else if (*str)
+      str++;
+    else
+      break;
+  } while (level);
+  return str;
+}
+
+/**
+ * @brief 结构索引
+ *
+ * pos 为字符串外的括号在原文中的偏移，按出现顺序排列；
+ * pair 为括号对应的另一半在pos中的下标；
+ * cur 为上一次跳过的容器之后的下标，顺序访问时即为下一个容器的开头；
+ * len 为原文长度。
+ * 跳过值只需要括号，`:`和`,`由解析时逐字节处理，不记录在索引中
+ */
+struct json_tokens {
+  uint32_t *pos;
+  uint32_t *pair;
+  uint32_t n;
+  uint32_t cur;
+  size_t len;
+};
+
+/**
+ * @brief 节点的len能否带有标记，即值不是数组
+ *
+ * 延迟的值按原文中的第一个字符判断，原文长于 JSON_LEN_OFFSET 时偏移占用全部位
+ *
+ * @param node 节点
+ * @return bool
+ */
+static bool len_spare(const json *node) {
+  if (node->value_type == json_Lazy) {
+    json_doc *doc = node->value.Doc;
+    return doc->tokens && doc->tokens->len <= JSON_LEN_OFFSET &&
+           doc->text[node->len & JSON_LEN_OFFSET] != '[';
+  }
+  return node->value_type <= json_Json;
+}
+
+/**
+ * @brief 节点len中的标记
+ *
+ * @param node 节点
+ * @return unsigned int 值为数组的节点返回0
+ */
+static unsigned int len_flags(const json *node) {
+  return len_spare(node) ? node->len & JSON_LEN_FLAGS : 0;
+}
+
+/**
+ * @brief 对象的成员索引
+ *
+ * 头部位于第一个值不是数组的成员之后，跳过之前值为数组的成员
+ *
+ * @param first 对象的首个成员节点，可以为NULL
+ * @return struct json_index* 对象没有头部或没有索引时返回NULL
+ */
+static struct json_index *object_index(const json *first) {
+  while (first && !len_spare(first))
+    first = first->next;
+  if (!first || !(first->len & JSON_LEN_HEAD))
+    return NULL;
+  return object_head(first)->index;
+}
+
+// x为0时返回64
+static int ctz64(uint64_t x) {
+#ifdef __GNUC__
+  return x ? __builtin_ctzll(x) : 64;
+#else
+  int n = 0;
+  while (n < 64 && !(x & 1)) {
+    x >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+// 第i位为第0到i位的异或，引号之间(含开头的引号)为1
+static uint64_t prefix_xor(uint64_t x) {
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  x ^= x << 32;
+  return x;
+}
+
+/**
+ * @brief 找出被转义的字符
+ *
+ * 连续的'\\'从奇数位开始时偶数位被转义，反之奇数位被转义，
+ * 两者由一次加法的进位区分，跨块的'\\'由carry传递
+ *
+ * @param backslash 块中'\\'的位掩码
+ * @param carry 上一块末尾的'\\'是否转义下一块的第一个字符，更新为本块的结果
+ * @return uint64_t 被转义的字符的位掩码
+ */
+static uint64_t escaped_mask(uint64_t backslash, uint64_t *carry) {
+  const uint64_t even = 0x5555555555555555ULL;
+  backslash &= ~*carry;
+  uint64_t follows = backslash << 1 | *carry;
+  uint64_t odd_starts = backslash & ~even & ~follows;
+  uint64_t seq = odd_starts + backslash;
+  *carry = seq < backslash;
+  return (even ^ (seq << 1)) & follows;
+}
+
+static void tokens_free(struct json_tokens *t) {
+  if (!t)
+    return;
+  free(t->pos);
+  free(t->pair);
+  free(t);
+}
+
+/**
+ * @brief 建立结构索引
+ *
+ * 按64字节一块计算引号、'\\'和括号的位掩码，
+ * 去掉被转义的引号后由前缀异或得到字符串内部的掩码，
+ * 剩下的括号按顺序写入pos，同时用栈匹配，栈保存在尚未填写的pair中
+ *
+ * @param s 输入
+ * @param len 输入长度，不超过UINT32_MAX
+ * @return struct json_tokens* 含有注释、括号不匹配或字符串未结束时返回NULL
+ */
+static struct json_tokens *tokens_build(const char *s, size_t len) {
+  struct json_tokens *t = calloc(1, sizeof(*t));
+  if (!t)
+    return NULL;
+  t->len = len;
+  size_t cap = len / 8 + 64;
+  uint32_t *pos = t->pos = malloc(cap * sizeof(uint32_t));
+  uint32_t *pair = t->pair = malloc(cap * sizeof(uint32_t));
+  if (!pos || !pair)
+    goto fail;
+
+  uint32_t n = 0;
+  uint32_t top = UINT32_MAX;
+  uint64_t carry = 0;
+  uint64_t in_str = 0;
+  for (size_t i = 0; i < len; i += 64) {
+    struct block_masks m;
+    if (len - i >= 64) {
+      scan.block(s + i, &m);
+    } else {
+      char tail[64] = {0};
+      memcpy(tail, s + i, len - i);
+      scan.block(tail, &m);
+    }
+    uint64_t quote = m.quote & ~escaped_mask(m.backslash, &carry);
+    uint64_t str = prefix_xor(quote) ^ in_str;
+    in_str = (uint64_t)((int64_t)str >> 63);
+    if (m.slash & ~str)
+      goto fail;
+
+    if (n + 64 > cap) {
+      cap *= 2;
+      if (!(pos = realloc(t->pos, cap * sizeof(uint32_t))))
+        goto fail;
+      t->pos = pos;
+      if (!(pair = realloc(t->pair, cap * sizeof(uint32_t))))
+        goto fail;
+      t->pair = pair;
+    }
+
+    uint64_t bits = (m.open | m.close) & ~str;
+    while (bits) {
+      int b = ctz64(bits);
+      uint32_t k = n++;
+      pos[k] = (uint32_t)(i + b);
+      if (m.open >> b & 1) {
+        pair[k] = top;
+        top = k;
+      } else {
+        // `}`与`]`分别比`{`与`[`大2
+        if (top == UINT32_MAX || s[pos[top]] != s[i + b] - 2)
+          goto fail;
+        uint32_t parent = pair[top];
+        pair[top] = k;
+        pair[k] = top;
+        top = parent;
+      }
+      bits &= bits - 1;
+    }
+  }
+  if (in_str || top != UINT32_MAX)
+    goto fail;
+  t->n = n;
+  return t;
+
+fail:
+  tokens_free(t);
+  return NULL;
+}
+
+/**
+ * @brief 在结构索引中查找位于偏移off的括号
+ *
+ * @param t 结构索引
+ * @param off 偏移
+ * @return uint32_t 在pos中的下标，不是括号时返回t->n
+ */
+static uint32_t tokens_find(struct json_tokens *t, uint32_t off) {
+  if (t->cur < t->n && t->pos[t->cur] == off)
+    return t->cur;
+
+  // 跳转到别处解析时二分查找
+  uint32_t lo = 0;
+  uint32_t hi = t->n;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (t->pos[mid] < off)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo < t->n && t->pos[lo] == off)
+    return lo;
+  return t->n;
+}
+
+/**
+ * @brief 跳过一个值，不解析
+ *
+ * 对象与数组在有结构索引时由括号表直接找到结尾，否则由nest_match匹配；
+ * 字符串查找结尾的`"`，数字和null, true, false 跳到下一个分隔符
+ *
+ * @param doc 文档
+ * @param str 值的开始
+ * @return char* 值结束的下一个字符，不是值时返回str
+ */
+static char *skip_value(json_doc *doc, char *str) {
+  if (*str == '{' || *str == '[') {
+    struct json_tokens *t = doc->tokens;
+    if (t) {
+      uint32_t k = tokens_find(t, (uint32_t)(str - doc->text));
+      if (k < t->n) {
+        k = t->pair[k];
+        t->cur = k + 1;
+        return doc->text + t->pos[k] + 1;
+      }
+    }
+    return nest_match(str);
+  }
+  if (*str == '"')
+    return nest_match_str(str);
+  while (*str > ' ' && *str != ',' && *str != '}' && *str != ']' &&
+         *str != '/')
+    str++;
+  return str;
+}
+
+/**
+ * @brief 5的幂的128位近似值，用于Eisel-Lemire算法
+ *
+ * 第i项为5^(i-342)，最高位对齐到第127位，负幂向上取整
+ */
+static const uint64_t pow5_128[651][2] = {
+    {0xeef453d6923bd65a, 0x113faa2906a13b3f},
+    {0x9558b4661b6565f8, 0x4ac7ca59a424c507},
+    {0xbaaee17fa23ebf76, 0x5d79bcf00d2df649},
+    {0xe95a99df8ace6f53, 0xf4d82c2c107973dc},
+    {0x91d8a02bb6c10594, 0x79071b9b8a4be869},
+    {0xb64ec836a47146f9, 0x9748e2826cdee284},
+    {0xe3e27a444d8d98b7, 0xfd1b1b2308169b25},
+    {0x8e6d8c6ab0787f72, 0xfe30f0f5e50e20f7},
+    {0xb208ef855c969f4f, 0xbdbd2d335e51a935},
+    {0xde8b2b66b3bc4723, 0xad2c788035e61382},
+    {0x8b16fb203055ac76, 0x4c3bcb5021afcc31},
+    {0xaddcb9e83c6b1793, 0xdf4abe242a1bbf3d},
+    {0xd953e8624b85dd78, 0xd71d6dad34a2af0d},
+    {0x87d4713d6f33aa6b, 0x8672648c40e5ad68},
+    {0xa9c98d8ccb009506, 0x680efdaf511f18c2},
+    {0xd43bf0effdc0ba48, 0x0212bd1b2566def2},
+    {0x84a57695fe98746d, 0x014bb630f7604b57},
+    {0xa5ced43b7e3e9188, 0x419ea3bd35385e2d},
+    {0xcf42894a5dce35ea, 0x52064cac828675b9},
+    {0x818995ce7aa0e1b2, 0x7343efebd1940993},
+    {0xa1ebfb4219491a1f, 0x1014ebe6c5f90bf8},
+    {0xca66fa129f9b60a6, 0xd41a26e077774ef6},
+    {0xfd00b897478238d0, 0x8920b098955522b4},
+    {0x9e20735e8cb16382, 0x55b46e5f5d5535b0},
+    {0xc5a890362fddbc62, 0xeb2189f734aa831d},
+    {0xf712b443bbd52b7b, 0xa5e9ec7501d523e4},
+    {0x9a6bb0aa55653b2d, 0x47b233c92125366e},
+    {0xc1069cd4eabe89f8, 0x999ec0bb696e840a},
+    {0xf148440a256e2c76, 0xc00670ea43ca250d},
+    {0x96cd2a865764dbca, 0x380406926a5e5728},
+    {0xbc807527ed3e12bc, 0xc605083704f5ecf2},
+    {0xeba09271e88d976b, 0xf7864a44c633682e},
+    {0x93445b8731587ea3, 0x7ab3ee6afbe0211d},
+    {0xb8157268fdae9e4c, 0x5960ea05bad82964},
+    {0xe61acf033d1a45df, 0x6fb92487298e33bd},
+    {0x8fd0c16206306bab, 0xa5d3b6d479f8e056},
+    {0xb3c4f1ba87bc8696, 0x8f48a4899877186c},
+    {0xe0b62e2929aba83c, 0x331acdabfe94de87},
+    {0x8c71dcd9ba0b4925, 0x9ff0c08b7f1d0b14},
+    {0xaf8e5410288e1b6f, 0x07ecf0ae5ee44dd9},
+    {0xdb71e91432b1a24a, 0xc9e82cd9f69d6150},
+    {0x892731ac9faf056e, 0xbe311c083a225cd2},
+    {0xab70fe17c79ac6ca, 0x6dbd630a48aaf406},
+    {0xd64d3d9db981787d, 0x092cbbccdad5b108},
+    {0x85f0468293f0eb4e, 0x25bbf56008c58ea5},
+    {0xa76c582338ed2621, 0xaf2af2b80af6f24e},
+    {0xd1476e2c07286faa, 0x1af5af660db4aee1},
+    {0x82cca4db847945ca, 0x50d98d9fc890ed4d},
+    {0xa37fce126597973c, 0xe50ff107bab528a0},
+    {0xcc5fc196fefd7d0c, 0x1e53ed49a96272c8},
+    {0xff77b1fcbebcdc4f, 0x25e8e89c13bb0f7a},
+    {0x9faacf3df73609b1, 0x77b191618c54e9ac},
+    {0xc795830d75038c1d, 0xd59df5b9ef6a2417},
+    {0xf97ae3d0d2446f25, 0x4b0573286b44ad1d},
+    {0x9becce62836ac577, 0x4ee367f9430aec32},
+    {0xc2e801fb244576d5, 0x229c41f793cda73f},
+    {0xf3a20279ed56d48a, 0x6b43527578c1110f},
+    {0x9845418c345644d6, 0x830a13896b78aaa9},
+    {0xbe5691ef416bd60c, 0x23cc986bc656d553},
+    {0xedec366b11c6cb8f, 0x2cbfbe86b7ec8aa8},
+    {0x94b3a202eb1c3f39, 0x7bf7d71432f3d6a9},
+    {0xb9e08a83a5e34f07, 0xdaf5ccd93fb0cc53},
+    {0xe858ad248f5c22c9, 0xd1b3400f8f9cff68},
+    {0x91376c36d99995be, 0x23100809b9c21fa1},
+    {0xb58547448ffffb2d, 0xabd40a0c2832a78a},
+    {0xe2e69915b3fff9f9, 0x16c90c8f323f516c},
+    {0x8dd01fad907ffc3b, 0xae3da7d97f6792e3},
+    {0xb1442798f49ffb4a, 0x99cd11cfdf41779c},
+    {0xdd95317f31c7fa1d, 0x40405643d711d583},
+    {0x8a7d3eef7f1cfc52, 0x482835ea666b2572},
+    {0xad1c8eab5ee43b66, 0xda3243650005eecf},
+    {0xd863b256369d4a40, 0x90bed43e40076a82},
+    {0x873e4f75e2224e68, 0x5a7744a6e804a291},
+    {0xa90de3535aaae202, 0x711515d0a205cb36},
+    {0xd3515c2831559a83, 0x0d5a5b44ca873e03},
+    {0x8412d9991ed58091, 0xe858790afe9486c2},
+    {0xa5178fff668ae0b6, 0x626e974dbe39a872},
+    {0xce5d73ff402d98e3, 0xfb0a3d212dc8128f},
+    {0x80fa687f881c7f8e, 0x7ce66634bc9d0b99},
+    {0xa139029f6a239f72, 0x1c1fffc1ebc44e80},
+    {0xc987434744ac874e, 0xa327ffb266b56220},
+    {0xfbe9141915d7a922, 0x4bf1ff9f0062baa8},
+    {0x9d71ac8fada6c9b5, 0x6f773fc3603db4a9},
+    {0xc4ce17b399107c22, 0xcb550fb4384d21d3},
+    {0xf6019da07f549b2b, 0x7e2a53a146606a48},
+    {0x99c102844f94e0fb, 0x2eda7444cbfc426d},
+    {0xc0314325637a1939, 0xfa911155fefb5308},
+    {0xf03d93eebc589f88, 0x793555ab7eba27ca},
+    {0x96267c7535b763b5, 0x4bc1558b2f3458de},
+    {0xbbb01b9283253ca2, 0x9eb1aaedfb016f16},
+    {0xea9c227723ee8bcb, 0x465e15a979c1cadc},
+    {0x92a1958a7675175f, 0x0bfacd89ec191ec9},
+    {0xb749faed14125d36, 0xcef980ec671f667b},
+    {0xe51c79a85916f484, 0x82b7e12780e7401a},
+    {0x8f31cc0937ae58d2, 0xd1b2ecb8b0908810},
+    {0xb2fe3f0b8599ef07, 0x861fa7e6dcb4aa15},
+    {0xdfbdcece67006ac9, 0x67a791e093e1d49a},
+    {0x8bd6a141006042bd, 0xe0c8bb2c5c6d24e0},
+    {0xaecc49914078536d, 0x58fae9f773886e18},
+    {0xda7f5bf590966848, 0xaf39a475506a899e},
+    {0x888f99797a5e012d, 0x6d8406c952429603},
+    {0xaab37fd7d8f58178, 0xc8e5087ba6d33b83},
+    {0xd5605fcdcf32e1d6, 0xfb1e4a9a90880a64},
+    {0x855c3be0a17fcd26, 0x5cf2eea09a55067f},
+    {0xa6b34ad8c9dfc06f, 0xf42faa48c0ea481e},
+    {0xd0601d8efc57b08b, 0xf13b94daf124da26},
+    {0x823c12795db6ce57, 0x76c53d08d6b70858},
+    {0xa2cb1717b52481ed, 0x54768c4b0c64ca6e},
+    {0xcb7ddcdda26da268, 0xa9942f5dcf7dfd09},
+    {0xfe5d54150b090b02, 0xd3f93b35435d7c4c},
+    {0x9efa548d26e5a6e1, 0xc47bc5014a1a6daf},
+    {0xc6b8e9b0709f109a, 0x359ab6419ca1091b},
+    {0xf867241c8cc6d4c0, 0xc30163d203c94b62},
+    {0x9b407691d7fc44f8, 0x79e0de63425dcf1d},
+    {0xc21094364dfb5636, 0x985915fc12f542e4},
+    {0xf294b943e17a2bc4, 0x3e6f5b7b17b2939d},
+    {0x979cf3ca6cec5b5a, 0xa705992ceecf9c42},
+    {0xbd8430bd08277231, 0x50c6ff782a838353},
+    {0xece53cec4a314ebd, 0xa4f8bf5635246428},
+    {0x940f4613ae5ed136, 0x871b7795e136be99},
+    {0xb913179899f68584, 0x28e2557b59846e3f},
+    {0xe757dd7ec07426e5, 0x331aeada2fe589cf},
+    {0x9096ea6f3848984f, 0x3ff0d2c85def7621},
+    {0xb4bca50b065abe63, 0x0fed077a756b53a9},
+    {0xe1ebce4dc7f16dfb, 0xd3e8495912c62894},
+    {0x8d3360f09cf6e4bd, 0x64712dd7abbbd95c},
+    {0xb080392cc4349dec, 0xbd8d794d96aacfb3},
+    {0xdca04777f541c567, 0xecf0d7a0fc5583a0},
+    {0x89e42caaf9491b60, 0xf41686c49db57244},
+    {0xac5d37d5b79b6239, 0x311c2875c522ced5},
+    {0xd77485cb25823ac7, 0x7d633293366b828b},
+    {0x86a8d39ef77164bc, 0xae5dff9c02033197},
+    {0xa8530886b54dbdeb, 0xd9f57f830283fdfc},
+    {0xd267caa862a12d66, 0xd072df63c324fd7b},
+    {0x8380dea93da4bc60, 0x4247cb9e59f71e6d},
+    {0xa46116538d0deb78, 0x52d9be85f074e608},
+    {0xcd795be870516656, 0x67902e276c921f8b},
+    {0x806bd9714632dff6, 0x00ba1cd8a3db53b6},
+    {0xa086cfcd97bf97f3, 0x80e8a40eccd228a4},
+    {0xc8a883c0fdaf7df0, 0x6122cd128006b2cd},
+    {0xfad2a4b13d1b5d6c, 0x796b805720085f81},
+    {0x9cc3a6eec6311a63, 0xcbe3303674053bb0},
+    {0xc3f490aa77bd60fc, 0xbedbfc4411068a9c},
+    {0xf4f1b4d515acb93b, 0xee92fb5515482d44},
+    {0x991711052d8bf3c5, 0x751bdd152d4d1c4a},
+    {0xbf5cd54678eef0b6, 0xd262d45a78a0635d},
+    {0xef340a98172aace4, 0x86fb897116c87c34},
+    {0x9580869f0e7aac0e, 0xd45d35e6ae3d4da0},
+    {0xbae0a846d2195712, 0x8974836059cca109},
+    {0xe998d258869facd7, 0x2bd1a438703fc94b},
+    {0x91ff83775423cc06, 0x7b6306a34627ddcf},
+    {0xb67f6455292cbf08, 0x1a3bc84c17b1d542},
+    {0xe41f3d6a7377eeca, 0x20caba5f1d9e4a93},
+    {0x8e938662882af53e, 0x547eb47b7282ee9c},
+    {0xb23867fb2a35b28d, 0xe99e619a4f23aa43},
+    {0xdec681f9f4c31f31, 0x6405fa00e2ec94d4},
+    {0x8b3c113c38f9f37e, 0xde83bc408dd3dd04},
+    {0xae0b158b4738705e, 0x9624ab50b148d445},
+    {0xd98ddaee19068c76, 0x3badd624dd9b0957},
+    {0x87f8a8d4cfa417c9, 0xe54ca5d70a80e5d6},
+    {0xa9f6d30a038d1dbc, 0x5e9fcf4ccd211f4c},
+    {0xd47487cc8470652b, 0x7647c3200069671f},
+    {0x84c8d4dfd2c63f3b, 0x29ecd9f40041e073},
+    {0xa5fb0a17c777cf09, 0xf468107100525890},
+    {0xcf79cc9db955c2cc, 0x7182148d4066eeb4},
+    {0x81ac1fe293d599bf, 0xc6f14cd848405530},
+    {0xa21727db38cb002f, 0xb8ada00e5a506a7c},
+    {0xca9cf1d206fdc03b, 0xa6d90811f0e4851c},
+    {0xfd442e4688bd304a, 0x908f4a166d1da663},
+    {0x9e4a9cec15763e2e, 0x9a598e4e043287fe},
+    {0xc5dd44271ad3cdba, 0x40eff1e1853f29fd},
+    {0xf7549530e188c128, 0xd12bee59e68ef47c},
+    {0x9a94dd3e8cf578b9, 0x82bb74f8301958ce},
+    {0xc13a148e3032d6e7, 0xe36a52363c1faf01},
+    {0xf18899b1bc3f8ca1, 0xdc44e6c3cb279ac1},
+    {0x96f5600f15a7b7e5, 0x29ab103a5ef8c0b9},
+    {0xbcb2b812db11a5de, 0x7415d448f6b6f0e7},
+    {0xebdf661791d60f56, 0x111b495b3464ad21},
+    {0x936b9fcebb25c995, 0xcab10dd900beec34},
+    {0xb84687c269ef3bfb, 0x3d5d514f40eea742},
+    {0xe65829b3046b0afa, 0x0cb4a5a3112a5112},
+    {0x8ff71a0fe2c2e6dc, 0x47f0e785eaba72ab},
+    {0xb3f4e093db73a093, 0x59ed216765690f56},
+    {0xe0f218b8d25088b8, 0x306869c13ec3532c},
+    {0x8c974f7383725573, 0x1e414218c73a13fb},
+    {0xafbd2350644eeacf, 0xe5d1929ef90898fa},
+    {0xdbac6c247d62a583, 0xdf45f746b74abf39},
+    {0x894bc396ce5da772, 0x6b8bba8c328eb783},
+    {0xab9eb47c81f5114f, 0x066ea92f3f326564},
+    {0xd686619ba27255a2, 0xc80a537b0efefebd},
+    {0x8613fd0145877585, 0xbd06742ce95f5f36},
+    {0xa798fc4196e952e7, 0x2c48113823b73704},
+    {0xd17f3b51fca3a7a0, 0xf75a15862ca504c5},
+    {0x82ef85133de648c4, 0x9a984d73dbe722fb},
+    {0xa3ab66580d5fdaf5, 0xc13e60d0d2e0ebba},
+    {0xcc963fee10b7d1b3, 0x318df905079926a8},
+    {0xffbbcfe994e5c61f, 0xfdf17746497f7052},
+    {0x9fd561f1fd0f9bd3, 0xfeb6ea8bedefa633},
+    {0xc7caba6e7c5382c8, 0xfe64a52ee96b8fc0},
+    {0xf9bd690a1b68637b, 0x3dfdce7aa3c673b0},
+    {0x9c1661a651213e2d, 0x06bea10ca65c084e},
+    {0xc31bfa0fe5698db8, 0x486e494fcff30a62},
+    {0xf3e2f893dec3f126, 0x5a89dba3c3efccfa},
+    {0x986ddb5c6b3a76b7, 0xf89629465a75e01c},
+    {0xbe89523386091465, 0xf6bbb397f1135823},
+    {0xee2ba6c0678b597f, 0x746aa07ded582e2c},
+    {0x94db483840b717ef, 0xa8c2a44eb4571cdc},
+    {0xba121a4650e4ddeb, 0x92f34d62616ce413},
+    {0xe896a0d7e51e1566, 0x77b020baf9c81d17},
+    {0x915e2486ef32cd60, 0x0ace1474dc1d122e},
+    {0xb5b5ada8aaff80b8, 0x0d819992132456ba},
+    {0xe3231912d5bf60e6, 0x10e1fff697ed6c69},
+    {0x8df5efabc5979c8f, 0xca8d3ffa1ef463c1},
+    {0xb1736b96b6fd83b3, 0xbd308ff8a6b17cb2},
+    {0xddd0467c64bce4a0, 0xac7cb3f6d05ddbde},
+    {0x8aa22c0dbef60ee4, 0x6bcdf07a423aa96b},
+    {0xad4ab7112eb3929d, 0x86c16c98d2c953c6},
+    {0xd89d64d57a607744, 0xe871c7bf077ba8b7},
+    {0x87625f056c7c4a8b, 0x11471cd764ad4972},
+    {0xa93af6c6c79b5d2d, 0xd598e40d3dd89bcf},
+    {0xd389b47879823479, 0x4aff1d108d4ec2c3},
+    {0x843610cb4bf160cb, 0xcedf722a585139ba},
+    {0xa54394fe1eedb8fe, 0xc2974eb4ee658828},
+    {0xce947a3da6a9273e, 0x733d226229feea32},
+    {0x811ccc668829b887, 0x0806357d5a3f525f},
+    {0xa163ff802a3426a8, 0xca07c2dcb0cf26f7},
+    {0xc9bcff6034c13052, 0xfc89b393dd02f0b5},
+    {0xfc2c3f3841f17c67, 0xbbac2078d443ace2},
+    {0x9d9ba7832936edc0, 0xd54b944b84aa4c0d},
+    {0xc5029163f384a931, 0x0a9e795e65d4df11},
+    {0xf64335bcf065d37d, 0x4d4617b5ff4a16d5},
+    {0x99ea0196163fa42e, 0x504bced1bf8e4e45},
+    {0xc06481fb9bcf8d39, 0xe45ec2862f71e1d6},
+    {0xf07da27a82c37088, 0x5d767327bb4e5a4c},
+    {0x964e858c91ba2655, 0x3a6a07f8d510f86f},
+    {0xbbe226efb628afea, 0x890489f70a55368b},
+    {0xeadab0aba3b2dbe5, 0x2b45ac74ccea842e},
+    {0x92c8ae6b464fc96f, 0x3b0b8bc90012929d},
+    {0xb77ada0617e3bbcb, 0x09ce6ebb40173744},
+    {0xe55990879ddcaabd, 0xcc420a6a101d0515},
+    {0x8f57fa54c2a9eab6, 0x9fa946824a12232d},
+    {0xb32df8e9f3546564, 0x47939822dc96abf9},
+    {0xdff9772470297ebd, 0x59787e2b93bc56f7},
+    {0x8bfbea76c619ef36, 0x57eb4edb3c55b65a},
+    {0xaefae51477a06b03, 0xede622920b6b23f1},
+    {0xdab99e59958885c4, 0xe95fab368e45eced},
+    {0x88b402f7fd75539b, 0x11dbcb0218ebb414},
+    {0xaae103b5fcd2a881, 0xd652bdc29f26a119},
+    {0xd59944a37c0752a2, 0x4be76d3346f0495f},
+    {0x857fcae62d8493a5, 0x6f70a4400c562ddb},
+    {0xa6dfbd9fb8e5b88e, 0xcb4ccd500f6bb952},
+    {0xd097ad07a71f26b2, 0x7e2000a41346a7a7},
+    {0x825ecc24c873782f, 0x8ed400668c0c28c8},
+    {0xa2f67f2dfa90563b, 0x728900802f0f32fa},
+    {0xcbb41ef979346bca, 0x4f2b40a03ad2ffb9},
+    {0xfea126b7d78186bc, 0xe2f610c84987bfa8},
+    {0x9f24b832e6b0f436, 0x0dd9ca7d2df4d7c9},
+    {0xc6ede63fa05d3143, 0x91503d1c79720dbb},
+    {0xf8a95fcf88747d94, 0x75a44c6397ce912a},
+    {0x9b69dbe1b548ce7c, 0xc986afbe3ee11aba},
+    {0xc24452da229b021b, 0xfbe85badce996168},
+    {0xf2d56790ab41c2a2, 0xfae27299423fb9c3},
+    {0x97c560ba6b0919a5, 0xdccd879fc967d41a},
+    {0xbdb6b8e905cb600f, 0x5400e987bbc1c920},
+    {0xed246723473e3813, 0x290123e9aab23b68},
+    {0x9436c0760c86e30b, 0xf9a0b6720aaf6521},
+    {0xb94470938fa89bce, 0xf808e40e8d5b3e69},
+    {0xe7958cb87392c2c2, 0xb60b1d1230b20e04},
+    {0x90bd77f3483bb9b9, 0xb1c6f22b5e6f48c2},
+    {0xb4ecd5f01a4aa828, 0x1e38aeb6360b1af3},
+    {0xe2280b6c20dd5232, 0x25c6da63c38de1b0},
+    {0x8d590723948a535f, 0x579c487e5a38ad0e},
+    {0xb0af48ec79ace837, 0x2d835a9df0c6d851},
+    {0xdcdb1b2798182244, 0xf8e431456cf88e65},
+    {0x8a08f0f8bf0f156b, 0x1b8e9ecb641b58ff},
+    {0xac8b2d36eed2dac5, 0xe272467e3d222f3f},
+    {0xd7adf884aa879177, 0x5b0ed81dcc6abb0f},
+    {0x86ccbb52ea94baea, 0x98e947129fc2b4e9},
+    {0xa87fea27a539e9a5, 0x3f2398d747b36224},
+    {0xd29fe4b18e88640e, 0x8eec7f0d19a03aad},
+    {0x83a3eeeef9153e89, 0x1953cf68300424ac},
+    {0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7},
+    {0xcdb02555653131b6, 0x3792f412cb06794d},
+    {0x808e17555f3ebf11, 0xe2bbd88bbee40bd0},
+    {0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4},
+    {0xc8de047564d20a8b, 0xf245825a5a445275},
+    {0xfb158592be068d2e, 0xeed6e2f0f0d56712},
+    {0x9ced737bb6c4183d, 0x55464dd69685606b},
+    {0xc428d05aa4751e4c, 0xaa97e14c3c26b886},
+    {0xf53304714d9265df, 0xd53dd99f4b3066a8},
+    {0x993fe2c6d07b7fab, 0xe546a8038efe4029},
+    {0xbf8fdb78849a5f96, 0xde98520472bdd033},
+    {0xef73d256a5c0f77c, 0x963e66858f6d4440},
+    {0x95a8637627989aad, 0xdde7001379a44aa8},
+    {0xbb127c53b17ec159, 0x5560c018580d5d52},
+    {0xe9d71b689dde71af, 0xaab8f01e6e10b4a6},
+    {0x9226712162ab070d, 0xcab3961304ca70e8},
+    {0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22},
+    {0xe45c10c42a2b3b05, 0x8cb89a7db77c506a},
+    {0x8eb98a7a9a5b04e3, 0x77f3608e92adb242},
+    {0xb267ed1940f1c61c, 0x55f038b237591ed3},
+    {0xdf01e85f912e37a3, 0x6b6c46dec52f6688},
+    {0x8b61313bbabce2c6, 0x2323ac4b3b3da015},
+    {0xae397d8aa96c1b77, 0xabec975e0a0d081a},
+    {0xd9c7dced53c72255, 0x96e7bd358c904a21},
+    {0x881cea14545c7575, 0x7e50d64177da2e54},
+    {0xaa242499697392d2, 0xdde50bd1d5d0b9e9},
+    {0xd4ad2dbfc3d07787, 0x955e4ec64b44e864},
+    {0x84ec3c97da624ab4, 0xbd5af13bef0b113e},
+    {0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e},
+    {0xcfb11ead453994ba, 0x67de18eda5814af2},
+    {0x81ceb32c4b43fcf4, 0x80eacf948770ced7},
+    {0xa2425ff75e14fc31, 0xa1258379a94d028d},
+    {0xcad2f7f5359a3b3e, 0x096ee45813a04330},
+    {0xfd87b5f28300ca0d, 0x8bca9d6e188853fc},
+    {0x9e74d1b791e07e48, 0x775ea264cf55347e},
+    {0xc612062576589dda, 0x95364afe032a819e},
+    {0xf79687aed3eec551, 0x3a83ddbd83f52205},
+    {0x9abe14cd44753b52, 0xc4926a9672793543},
+    {0xc16d9a0095928a27, 0x75b7053c0f178294},
+    {0xf1c90080baf72cb1, 0x5324c68b12dd6339},
+    {0x971da05074da7bee, 0xd3f6fc16ebca5e04},
+    {0xbce5086492111aea, 0x88f4bb1ca6bcf585},
+    {0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6},
+    {0x9392ee8e921d5d07, 0x3aff322e62439fd0},
+    {0xb877aa3236a4b449, 0x09befeb9fad487c3},
+    {0xe69594bec44de15b, 0x4c2ebe687989a9b4},
+    {0x901d7cf73ab0acd9, 0x0f9d37014bf60a11},
+    {0xb424dc35095cd80f, 0x538484c19ef38c95},
+    {0xe12e13424bb40e13, 0x2865a5f206b06fba},
+    {0x8cbccc096f5088cb, 0xf93f87b7442e45d4},
+    {0xafebff0bcb24aafe, 0xf78f69a51539d749},
+    {0xdbe6fecebdedd5be, 0xb573440e5a884d1c},
+    {0x89705f4136b4a597, 0x31680a88f8953031},
+    {0xabcc77118461cefc, 0xfdc20d2b36ba7c3e},
+    {0xd6bf94d5e57a42bc, 0x3d32907604691b4d},
+    {0x8637bd05af6c69b5, 0xa63f9a49c2c1b110},
+    {0xa7c5ac471b478423, 0x0fcf80dc33721d54},
+    {0xd1b71758e219652b, 0xd3c36113404ea4a9},
+    {0x83126e978d4fdf3b, 0x645a1cac083126ea},
+    {0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4},
+    {0xcccccccccccccccc, 0xcccccccccccccccd},
+    {0x8000000000000000, 0x0000000000000000},
+    {0xa000000000000000, 0x0000000000000000},
+    {0xc800000000000000, 0x0000000000000000},
+    {0xfa00000000000000, 0x0000000000000000},
+    {0x9c40000000000000, 0x0000000000000000},
+    {0xc350000000000000, 0x0000000000000000},
+    {0xf424000000000000, 0x0000000000000000},
+    {0x9896800000000000, 0x0000000000000000},
+    {0xbebc200000000000, 0x0000000000000000},
+    {0xee6b280000000000, 0x0000000000000000},
+    {0x9502f90000000000, 0x0000000000000000},
+    {0xba43b74000000000, 0x0000000000000000},
+    {0xe8d4a51000000000, 0x0000000000000000},
+    {0x9184e72a00000000, 0x0000000000000000},
+    {0xb5e620f480000000, 0x0000000000000000},
+    {0xe35fa931a0000000, 0x0000000000000000},
+    {0x8e1bc9bf04000000, 0x0000000000000000},
+    {0xb1a2bc2ec5000000, 0x0000000000000000},
+    {0xde0b6b3a76400000, 0x0000000000000000},
+    {0x8ac7230489e80000, 0x0000000000000000},
+    {0xad78ebc5ac620000, 0x0000000000000000},
+    {0xd8d726b7177a8000, 0x0000000000000000},
+    {0x878678326eac9000, 0x0000000000000000},
+    {0xa968163f0a57b400, 0x0000000000000000},
+    {0xd3c21bcecceda100, 0x0000000000000000},
+    {0x84595161401484a0, 0x0000000000000000},
+    {0xa56fa5b99019a5c8, 0x0000000000000000},
+    {0xcecb8f27f4200f3a, 0x0000000000000000},
+    {0x813f3978f8940984, 0x4000000000000000},
+    {0xa18f07d736b90be5, 0x5000000000000000},
+    {0xc9f2c9cd04674ede, 0xa400000000000000},
+    {0xfc6f7c4045812296, 0x4d00000000000000},
+    {0x9dc5ada82b70b59d, 0xf020000000000000},
+    {0xc5371912364ce305, 0x6c28000000000000},
+    {0xf684df56c3e01bc6, 0xc732000000000000},
+    {0x9a130b963a6c115c, 0x3c7f400000000000},
+    {0xc097ce7bc90715b3, 0x4b9f100000000000},
+    {0xf0bdc21abb48db20, 0x1e86d40000000000},
+    {0x96769950b50d88f4, 0x1314448000000000},
+    {0xbc143fa4e250eb31, 0x17d955a000000000},
+    {0xeb194f8e1ae525fd, 0x5dcfab0800000000},
+    {0x92efd1b8d0cf37be, 0x5aa1cae500000000},
+    {0xb7abc627050305ad, 0xf14a3d9e40000000},
+    {0xe596b7b0c643c719, 0x6d9ccd05d0000000},
+    {0x8f7e32ce7bea5c6f, 0xe4820023a2000000},
+    {0xb35dbf821ae4f38b, 0xdda2802c8a800000},
+    {0xe0352f62a19e306e, 0xd50b2037ad200000},
+    {0x8c213d9da502de45, 0x4526f422cc340000},
+    {0xaf298d050e4395d6, 0x9670b12b7f410000},
+    {0xdaf3f04651d47b4c, 0x3c0cdd765f114000},
+    {0x88d8762bf324cd0f, 0xa5880a69fb6ac800},
+    {0xab0e93b6efee0053, 0x8eea0d047a457a00},
+    {0xd5d238a4abe98068, 0x72a4904598d6d880},
+    {0x85a36366eb71f041, 0x47a6da2b7f864750},
+    {0xa70c3c40a64e6c51, 0x999090b65f67d924},
+    {0xd0cf4b50cfe20765, 0xfff4b4e3f741cf6d},
+    {0x82818f1281ed449f, 0xbff8f10e7a8921a4},
+    {0xa321f2d7226895c7, 0xaff72d52192b6a0d},
+    {0xcbea6f8ceb02bb39, 0x9bf4f8a69f764490},
+    {0xfee50b7025c36a08, 0x02f236d04753d5b4},
+    {0x9f4f2726179a2245, 0x01d762422c946590},
+    {0xc722f0ef9d80aad6, 0x424d3ad2b7b97ef5},
+    {0xf8ebad2b84e0d58b, 0xd2e0898765a7deb2},
+    {0x9b934c3b330c8577, 0x63cc55f49f88eb2f},
+    {0xc2781f49ffcfa6d5, 0x3cbf6b71c76b25fb},
+    {0xf316271c7fc3908a, 0x8bef464e3945ef7a},
+    {0x97edd871cfda3a56, 0x97758bf0e3cbb5ac},
+    {0xbde94e8e43d0c8ec, 0x3d52eeed1cbea317},
+    {0xed63a231d4c4fb27, 0x4ca7aaa863ee4bdd},
+    {0x945e455f24fb1cf8, 0x8fe8caa93e74ef6a},
+    {0xb975d6b6ee39e436, 0xb3e2fd538e122b44},
+    {0xe7d34c64a9c85d44, 0x60dbbca87196b616},
+    {0x90e40fbeea1d3a4a, 0xbc8955e946fe31cd},
+    {0xb51d13aea4a488dd, 0x6babab6398bdbe41},
+    {0xe264589a4dcdab14, 0xc696963c7eed2dd1},
+    {0x8d7eb76070a08aec, 0xfc1e1de5cf543ca2},
+    {0xb0de65388cc8ada8, 0x3b25a55f43294bcb},
+    {0xdd15fe86affad912, 0x49ef0eb713f39ebe},
+    {0x8a2dbf142dfcc7ab, 0x6e3569326c784337},
+    {0xacb92ed9397bf996, 0x49c2c37f07965404},
+    {0xd7e77a8f87daf7fb, 0xdc33745ec97be906},
+    {0x86f0ac99b4e8dafd, 0x69a028bb3ded71a3},
+    {0xa8acd7c0222311bc, 0xc40832ea0d68ce0c},
+    {0xd2d80db02aabd62b, 0xf50a3fa490c30190},
+    {0x83c7088e1aab65db, 0x792667c6da79e0fa},
+    {0xa4b8cab1a1563f52, 0x577001b891185938},
+    {0xcde6fd5e09abcf26, 0xed4c0226b55e6f86},
+    {0x80b05e5ac60b6178, 0x544f8158315b05b4},
+    {0xa0dc75f1778e39d6, 0x696361ae3db1c721},
+    {0xc913936dd571c84c, 0x03bc3a19cd1e38e9},
+    {0xfb5878494ace3a5f, 0x04ab48a04065c723},
+    {0x9d174b2dcec0e47b, 0x62eb0d64283f9c76},
+    {0xc45d1df942711d9a, 0x3ba5d0bd324f8394},
+    {0xf5746577930d6500, 0xca8f44ec7ee36479},
+    {0x9968bf6abbe85f20, 0x7e998b13cf4e1ecb},
+    {0xbfc2ef456ae276e8, 0x9e3fedd8c321a67e},
+    {0xefb3ab16c59b14a2, 0xc5cfe94ef3ea101e},
+    {0x95d04aee3b80ece5, 0xbba1f1d158724a12},
+    {0xbb445da9ca61281f, 0x2a8a6e45ae8edc97},
+    {0xea1575143cf97226, 0xf52d09d71a3293bd},
+    {0x924d692ca61be758, 0x593c2626705f9c56},
+    {0xb6e0c377cfa2e12e, 0x6f8b2fb00c77836c},
+    {0xe498f455c38b997a, 0x0b6dfb9c0f956447},
+    {0x8edf98b59a373fec, 0x4724bd4189bd5eac},
+    {0xb2977ee300c50fe7, 0x58edec91ec2cb657},
+    {0xdf3d5e9bc0f653e1, 0x2f2967b66737e3ed},
+    {0x8b865b215899f46c, 0xbd79e0d20082ee74},
+    {0xae67f1e9aec07187, 0xecd8590680a3aa11},
+    {0xda01ee641a708de9, 0xe80e6f4820cc9495},
+    {0x884134fe908658b2, 0x3109058d147fdcdd},
+    {0xaa51823e34a7eede, 0xbd4b46f0599fd415},
+    {0xd4e5e2cdc1d1ea96, 0x6c9e18ac7007c91a},
+    {0x850fadc09923329e, 0x03e2cf6bc604ddb0},
+    {0xa6539930bf6bff45, 0x84db8346b786151c},
+    {0xcfe87f7cef46ff16, 0xe612641865679a63},
+    {0x81f14fae158c5f6e, 0x4fcb7e8f3f60c07e},
+    {0xa26da3999aef7749, 0xe3be5e330f38f09d},
+    {0xcb090c8001ab551c, 0x5cadf5bfd3072cc5},
+    {0xfdcb4fa002162a63, 0x73d9732fc7c8f7f6},
+    {0x9e9f11c4014dda7e, 0x2867e7fddcdd9afa},
+    {0xc646d63501a1511d, 0xb281e1fd541501b8},
+    {0xf7d88bc24209a565, 0x1f225a7ca91a4226},
+    {0x9ae757596946075f, 0x3375788de9b06958},
+    {0xc1a12d2fc3978937, 0x0052d6b1641c83ae},
+    {0xf209787bb47d6b84, 0xc0678c5dbd23a49a},
+    {0x9745eb4d50ce6332, 0xf840b7ba963646e0},
+    {0xbd176620a501fbff, 0xb650e5a93bc3d898},
+    {0xec5d3fa8ce427aff, 0xa3e51f138ab4cebe},
+    {0x93ba47c980e98cdf, 0xc66f336c36b10137},
+    {0xb8a8d9bbe123f017, 0xb80b0047445d4184},
+    {0xe6d3102ad96cec1d, 0xa60dc059157491e5},
+    {0x9043ea1ac7e41392, 0x87c89837ad68db2f},
+    {0xb454e4a179dd1877, 0x29babe4598c311fb},
+    {0xe16a1dc9d8545e94, 0xf4296dd6fef3d67a},
+    {0x8ce2529e2734bb1d, 0x1899e4a65f58660c},
+    {0xb01ae745b101e9e4, 0x5ec05dcff72e7f8f},
+    {0xdc21a1171d42645d, 0x76707543f4fa1f73},
+    {0x899504ae72497eba, 0x6a06494a791c53a8},
+    {0xabfa45da0edbde69, 0x0487db9d17636892},
+    {0xd6f8d7509292d603, 0x45a9d2845d3c42b6},
+    {0x865b86925b9bc5c2, 0x0b8a2392ba45a9b2},
+    {0xa7f26836f282b732, 0x8e6cac7768d7141e},
+    {0xd1ef0244af2364ff, 0x3207d795430cd926},
+    {0x8335616aed761f1f, 0x7f44e6bd49e807b8},
+    {0xa402b9c5a8d3a6e7, 0x5f16206c9c6209a6},
+    {0xcd036837130890a1, 0x36dba887c37a8c0f},
+    {0x802221226be55a64, 0xc2494954da2c9789},
+    {0xa02aa96b06deb0fd, 0xf2db9baa10b7bd6c},
+    {0xc83553c5c8965d3d, 0x6f92829494e5acc7},
+    {0xfa42a8b73abbf48c, 0xcb772339ba1f17f9},
+    {0x9c69a97284b578d7, 0xff2a760414536efb},
+    {0xc38413cf25e2d70d, 0xfef5138519684aba},
+    {0xf46518c2ef5b8cd1, 0x7eb258665fc25d69},
+    {0x98bf2f79d5993802, 0xef2f773ffbd97a61},
+    {0xbeeefb584aff8603, 0xaafb550ffacfd8fa},
+    {0xeeaaba2e5dbf6784, 0x95ba2a53f983cf38},
+    {0x952ab45cfa97a0b2, 0xdd945a747bf26183},
+    {0xba756174393d88df, 0x94f971119aeef9e4},
+    {0xe912b9d1478ceb17, 0x7a37cd5601aab85d},
+    {0x91abb422ccb812ee, 0xac62e055c10ab33a},
+    {0xb616a12b7fe617aa, 0x577b986b314d6009},
+    {0xe39c49765fdf9d94, 0xed5a7e85fda0b80b},
+    {0x8e41ade9fbebc27d, 0x14588f13be847307},
+    {0xb1d219647ae6b31c, 0x596eb2d8ae258fc8},
+    {0xde469fbd99a05fe3, 0x6fca5f8ed9aef3bb},
+    {0x8aec23d680043bee, 0x25de7bb9480d5854},
+    {0xada72ccc20054ae9, 0xaf561aa79a10ae6a},
+    {0xd910f7ff28069da4, 0x1b2ba1518094da04},
+    {0x87aa9aff79042286, 0x90fb44d2f05d0842},
+    {0xa99541bf57452b28, 0x353a1607ac744a53},
+    {0xd3fa922f2d1675f2, 0x42889b8997915ce8},
+    {0x847c9b5d7c2e09b7, 0x69956135febada11},
+    {0xa59bc234db398c25, 0x43fab9837e699095},
+    {0xcf02b2c21207ef2e, 0x94f967e45e03f4bb},
+    {0x8161afb94b44f57d, 0x1d1be0eebac278f5},
+    {0xa1ba1ba79e1632dc, 0x6462d92a69731732},
+    {0xca28a291859bbf93, 0x7d7b8f7503cfdcfe},
+    {0xfcb2cb35e702af78, 0x5cda735244c3d43e},
+    {0x9defbf01b061adab, 0x3a0888136afa64a7},
+    {0xc56baec21c7a1916, 0x088aaa1845b8fdd0},
+    {0xf6c69a72a3989f5b, 0x8aad549e57273d45},
+    {0x9a3c2087a63f6399, 0x36ac54e2f678864b},
+    {0xc0cb28a98fcf3c7f, 0x84576a1bb416a7dd},
+    {0xf0fdf2d3f3c30b9f, 0x656d44a2a11c51d5},
+    {0x969eb7c47859e743, 0x9f644ae5a4b1b325},
+    {0xbc4665b596706114, 0x873d5d9f0dde1fee},
+    {0xeb57ff22fc0c7959, 0xa90cb506d155a7ea},
+    {0x9316ff75dd87cbd8, 0x09a7f12442d588f2},
+    {0xb7dcbf5354e9bece, 0x0c11ed6d538aeb2f},
+    {0xe5d3ef282a242e81, 0x8f1668c8a86da5fa},
+    {0x8fa475791a569d10, 0xf96e017d694487bc},
+    {0xb38d92d760ec4455, 0x37c981dcc395a9ac},
+    {0xe070f78d3927556a, 0x85bbe253f47b1417},
+    {0x8c469ab843b89562, 0x93956d7478ccec8e},
+    {0xaf58416654a6babb, 0x387ac8d1970027b2},
+    {0xdb2e51bfe9d0696a, 0x06997b05fcc0319e},
+    {0x88fcf317f22241e2, 0x441fece3bdf81f03},
+    {0xab3c2fddeeaad25a, 0xd527e81cad7626c3},
+    {0xd60b3bd56a5586f1, 0x8a71e223d8d3b074},
+    {0x85c7056562757456, 0xf6872d5667844e49},
+    {0xa738c6bebb12d16c, 0xb428f8ac016561db},
+    {0xd106f86e69d785c7, 0xe13336d701beba52},
+    {0x82a45b450226b39c, 0xecc0024661173473},
+    {0xa34d721642b06084, 0x27f002d7f95d0190},
+    {0xcc20ce9bd35c78a5, 0x31ec038df7b441f4},
+    {0xff290242c83396ce, 0x7e67047175a15271},
+    {0x9f79a169bd203e41, 0x0f0062c6e984d386},
+    {0xc75809c42c684dd1, 0x52c07b78a3e60868},
+    {0xf92e0c3537826145, 0xa7709a56ccdf8a82},
+    {0x9bbcc7a142b17ccb, 0x88a66076400bb691},
+    {0xc2abf989935ddbfe, 0x6acff893d00ea435},
+    {0xf356f7ebf83552fe, 0x0583f6b8c4124d43},
+    {0x98165af37b2153de, 0xc3727a337a8b704a},
+    {0xbe1bf1b059e9a8d6, 0x744f18c0592e4c5c},
+    {0xeda2ee1c7064130c, 0x1162def06f79df73},
+    {0x9485d4d1c63e8be7, 0x8addcb5645ac2ba8},
+    {0xb9a74a0637ce2ee1, 0x6d953e2bd7173692},
+    {0xe8111c87c5c1ba99, 0xc8fa8db6ccdd0437},
+    {0x910ab1d4db9914a0, 0x1d9c9892400a22a2},
+    {0xb54d5e4a127f59c8, 0x2503beb6d00cab4b},
+    {0xe2a0b5dc971f303a, 0x2e44ae64840fd61d},
+    {0x8da471a9de737e24, 0x5ceaecfed289e5d2},
+    {0xb10d8e1456105dad, 0x7425a83e872c5f47},
+    {0xdd50f1996b947518, 0xd12f124e28f77719},
+    {0x8a5296ffe33cc92f, 0x82bd6b70d99aaa6f},
+    {0xace73cbfdc0bfb7b, 0x636cc64d1001550b},
+    {0xd8210befd30efa5a, 0x3c47f7e05401aa4e},
+    {0x8714a775e3e95c78, 0x65acfaec34810a71},
+    {0xa8d9d1535ce3b396, 0x7f1839a741a14d0d},
+    {0xd31045a8341ca07c, 0x1ede48111209a050},
+    {0x83ea2b892091e44d, 0x934aed0aab460432},
+    {0xa4e4b66b68b65d60, 0xf81da84d5617853f},
+    {0xce1de40642e3f4b9, 0x36251260ab9d668e},
+    {0x80d2ae83e9ce78f3, 0xc1d72b7c6b426019},
+    {0xa1075a24e4421730, 0xb24cf65b8612f81f},
+    {0xc94930ae1d529cfc, 0xdee033f26797b627},
+    {0xfb9b7cd9a4a7443c, 0x169840ef017da3b1},
+    {0x9d412e0806e88aa5, 0x8e1f289560ee864e},
+    {0xc491798a08a2ad4e, 0xf1a6f2bab92a27e2},
+    {0xf5b5d7ec8acb58a2, 0xae10af696774b1db},
+    {0x9991a6f3d6bf1765, 0xacca6da1e0a8ef29},
+    {0xbff610b0cc6edd3f, 0x17fd090a58d32af3},
+    {0xeff394dcff8a948e, 0xddfc4b4cef07f5b0},
+    {0x95f83d0a1fb69cd9, 0x4abdaf101564f98e},
+    {0xbb764c4ca7a4440f, 0x9d6d1ad41abe37f1},
+    {0xea53df5fd18d5513, 0x84c86189216dc5ed},
+    {0x92746b9be2f8552c, 0x32fd3cf5b4e49bb4},
+    {0xb7118682dbb66a77, 0x3fbc8c33221dc2a1},
+    {0xe4d5e82392a40515, 0x0fabaf3feaa5334a},
+    {0x8f05b1163ba6832d, 0x29cb4d87f2a7400e},
+    {0xb2c71d5bca9023f8, 0x743e20e9ef511012},
+    {0xdf78e4b2bd342cf6, 0x914da9246b255416},
+    {0x8bab8eefb6409c1a, 0x1ad089b6c2f7548e},
+    {0xae9672aba3d0c320, 0xa184ac2473b529b1},
+    {0xda3c0f568cc4f3e8, 0xc9e5d72d90a2741e},
+    {0x8865899617fb1871, 0x7e2fa67c7a658892},
+    {0xaa7eebfb9df9de8d, 0xddbb901b98feeab7},
+    {0xd51ea6fa85785631, 0x552a74227f3ea565},
+    {0x8533285c936b35de, 0xd53a88958f87275f},
+    {0xa67ff273b8460356, 0x8a892abaf368f137},
+    {0xd01fef10a657842c, 0x2d2b7569b0432d85},
+    {0x8213f56a67f6b29b, 0x9c3b29620e29fc73},
+    {0xa298f2c501f45f42, 0x8349f3ba91b47b8f},
+    {0xcb3f2f7642717713, 0x241c70a936219a73},
+    {0xfe0efb53d30dd4d7, 0xed238cd383aa0110},
+    {0x9ec95d1463e8a506, 0xf4363804324a40aa},
+    {0xc67bb4597ce2ce48, 0xb143c6053edcd0d5},
+    {0xf81aa16fdc1b81da, 0xdd94b7868e94050a},
+    {0x9b10a4e5e9913128, 0xca7cf2b4191c8326},
+    {0xc1d4ce1f63f57d72, 0xfd1c2f611f63a3f0},
+    {0xf24a01a73cf2dccf, 0xbc633b39673c8cec},
+    {0x976e41088617ca01, 0xd5be0503e085d813},
+    {0xbd49d14aa79dbc82, 0x4b2d8644d8a74e18},
+    {0xec9c459d51852ba2, 0xddf8e7d60ed1219e},
+    {0x93e1ab8252f33b45, 0xcabb90e5c942b503},
+    {0xb8da1662e7b00a17, 0x3d6a751f3b936243},
+    {0xe7109bfba19c0c9d, 0x0cc512670a783ad4},
+    {0x906a617d450187e2, 0x27fb2b80668b24c5},
+    {0xb484f9dc9641e9da, 0xb1f9f660802dedf6},
+    {0xe1a63853bbd26451, 0x5e7873f8a0396973},
+    {0x8d07e33455637eb2, 0xdb0b487b6423e1e8},
+    {0xb049dc016abc5e5f, 0x91ce1a9a3d2cda62},
+    {0xdc5c5301c56b75f7, 0x7641a140cc7810fb},
+    {0x89b9b3e11b6329ba, 0xa9e904c87fcb0a9d},
+    {0xac2820d9623bf429, 0x546345fa9fbdcd44},
+    {0xd732290fbacaf133, 0xa97c177947ad4095},
+    {0x867f59a9d4bed6c0, 0x49ed8eabcccc485d},
+    {0xa81f301449ee8c70, 0x5c68f256bfff5a74},
+    {0xd226fc195c6a2f8c, 0x73832eec6fff3111},
+    {0x83585d8fd9c25db7, 0xc831fd53c5ff7eab},
+    {0xa42e74f3d032f525, 0xba3e7ca8b77f5e55},
+    {0xcd3a1230c43fb26f, 0x28ce1bd2e55f35eb},
+    {0x80444b5e7aa7cf85, 0x7980d163cf5b81b3},
+    {0xa0555e361951c366, 0xd7e105bcc332621f},
+    {0xc86ab5c39fa63440, 0x8dd9472bf3fefaa7},
+    {0xfa856334878fc150, 0xb14f98f6f0feb951},
+    {0x9c935e00d4b9d8d2, 0x6ed1bf9a569f33d3},
+    {0xc3b8358109e84f07, 0x0a862f80ec4700c8},
+    {0xf4a642e14c6262c8, 0xcd27bb612758c0fa},
+    {0x98e7e9cccfbd7dbd, 0x8038d51cb897789c},
+    {0xbf21e44003acdd2c, 0xe0470a63e6bd56c3},
+    {0xeeea5d5004981478, 0x1858ccfce06cac74},
+    {0x95527a5202df0ccb, 0x0f37801e0c43ebc8},
+    {0xbaa718e68396cffd, 0xd30560258f54e6ba},
+    {0xe950df20247c83fd, 0x47c6b82ef32a2069},
+    {0x91d28b7416cdd27e, 0x4cdc331d57fa5441},
+    {0xb6472e511c81471d, 0xe0133fe4adf8e952},
+    {0xe3d8f9e563a198e5, 0x58180fddd97723a6},
+    {0x8e679c2f5e44ff8f, 0x570f09eaa7ea7648},
+};
+
+// 能被double精确表示的10的幂
+static const double pow10_exact[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/**
+ * @brief 64位乘法，结果的高64位写入hi，返回低64位
+ */
+static uint64_t mul128(uint64_t a, uint64_t b, uint64_t *hi) {
+#ifdef __SIZEOF_INT128__
+  unsigned __int128 r = (unsigned __int128)a * b;
+  *hi = (uint64_t)(r >> 64);
+  return (uint64_t)r;
+#else
+  uint64_t al = (uint32_t)a, ah = a >> 32, bl = (uint32_t)b, bh = b >> 32;
+  uint64_t ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+  uint64_t mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+  *hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+  return (mid << 32) | (uint32_t)ll;
+#endif
+}
+
+/**
+ * @brief Eisel-Lemire 算法，计算 w * 10^q 最接近的double
+ *
+ * w不超过19位十进制数字时结果总是正确舍入的
+ *
+ * @param w 十进制有效数字
+ * @param q 十进制指数
+ * @param out 写入非负的结果
+ */
+static void eisel_lemire(uint64_t w, int64_t q, double *out) {
+  uint64_t bits;
+  if (w == 0 || q < -342) {
+    bits = 0;
+  } else if (q > 308) {
+    bits = 0x7FFull << 52;
+  } else {
+    // w左移使最高位为1，与5^q相乘取高位
+    int lz = __builtin_clzll(w);
+    w <<= lz;
+    const uint64_t *p = pow5_128[q + 342];
+    uint64_t hi;
+    uint64_t lo = mul128(w, p[0], &hi);
+    if ((hi & 0x1FF) == 0x1FF) {
+      uint64_t hi2;
+      mul128(w, p[1], &hi2);
+      lo += hi2;
+      if (hi2 > lo)
+        hi++;
+    }
+
+    // 取53+2位尾数，power2为偏移后的二进制指数
+    int upper = (int)(hi >> 63);
+    int shift = upper + 9;
+    uint64_t mantissa = hi >> shift;
+    int64_t power2 = ((217706 * q) >> 16) + 63 + upper - lz + 1023;
+
+    if (power2 <= 0) {
+      // 非规格化数
+      if (-power2 + 1 >= 64) {
+        bits = 0;
+      } else {
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = mantissa < (1ull << 52) ? 0 : 1;
+        bits = (mantissa & ((1ull << 52) - 1)) | (uint64_t)power2 << 52;
+      }
+    } else {
+      // 恰好位于两个double中间时向偶数舍入
+      if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 &&
+          (mantissa << shift) == hi)
+        mantissa &= ~(uint64_t)1;
+      mantissa += mantissa & 1;
+      mantissa >>= 1;
+      if (mantissa >= (2ull << 52)) {
+        mantissa = 1ull << 52;
+        power2++;
       }
+      mantissa &= ~(1ull << 52);
+      if (power2 >= 0x7FF)
+        bits = 0x7FFull << 52;
+      else
+        bits = mantissa | (uint64_t)power2 << 52;
+    }
+  }
+  memcpy(out, &bits, sizeof(double));
+}
+
+/**
+ * @brief 使用strtod解析数字，用于超过19位有效数字的少见情况
+ *
+ * strtod受locale影响，先将`.`替换为当前locale的小数点
+ *
+ * @param start 数字开始
+ * @param end 数字结束的下一个字符
+ * @return double
+ */
+static double strtod_fallback(const char *start, const char *end) {
+  char stack[128];
+  size_t n = end - start;
+  char *buf = n < sizeof(stack) ? stack : malloc(n + 1);
+  if (!buf)
+    return 0;
+  memcpy(buf, start, n);
+  buf[n] = '\0';
+  char *dot = memchr(buf, '.', n);
+  if (dot)
+    *dot = *localeconv()->decimal_point;
+  double ret = strtod(buf, NULL);
+  if (buf != stack)
+    free(buf);
+  return ret;
+}
+
+/**
+ * @brief 解析数字
+ *
+ * 数字只扫描一次，整数在int64范围内时为json_Int，
+ * 否则与带小数点或指数的数字一样为json_Float
+ *
+ * @param s 从*s开始解析，并修改*s指向数字结束的下一个字符
+ * @param item 修改item的value, value_type
+ * @return bool 不是数字时返回false
+ */
+static bool parse_number(char **s, json *item) {
+  char *str = *s;
+  bool neg = *str == '-';
+  if (neg)
+    str++;
+  if (*str < '0' || *str > '9')
+    return false;
 
-      // 将数字转化为json的值
-      if (isfloat) {
-        head->value_type = json_Float;
-        head->value.Float = atof(temp);
+  // 最多累积19位有效数字，其余的只记录指数与是否非零
+  uint64_t w = 0;
+  int digits = 0;
+  int64_t q = 0;
+  bool trunc = false;
+  bool isfloat = false;
+  for (; *str >= '0' && *str <= '9'; str++) {
+    if (digits < 19) {
+      w = w * 10 + (*str - '0');
+      digits += w != 0;
+    } else {
+      q++;
+      trunc |= *str != '0';
+    }
+  }
+  if (*str == '.') {
+    isfloat = true;
+    for (str++; *str >= '0' && *str <= '9'; str++) {
+      if (digits < 19) {
+        w = w * 10 + (*str - '0');
+        digits += w != 0;
+        q--;
       } else {
-        head->value_type = json_Int;
-        head->value.Int = atol(temp);
+        trunc |= *str != '0';
       }
+    }
+  }
+  if (*str == 'e' || *str == 'E') {
+    isfloat = true;
+    str++;
+    bool eneg = *str == '-';
+    if (*str == '-' || *str == '+')
+      str++;
+    int64_t e = 0;
+    for (; *str >= '0' && *str <= '9'; str++)
+      if (e < 100000)
+        e = e * 10 + (*str - '0');
+    q += eneg ? -e : e;
+  }
+
+  // 整数且在long范围内
+  if (!isfloat && q == 0 &&
+      w <= (neg ? (uint64_t)LONG_MAX + 1 : (uint64_t)LONG_MAX)) {
+    item->value_type = json_Int;
+    item->value.Int = neg ? (long)(0 - w) : (long)w;
+    *s = str;
+    return true;
+  }
+
+  double d;
+  if (!trunc && w <= (1ull << 53) && q >= -22 && q <= 22) {
+    // 尾数与10的幂都能精确表示，一次乘除即为正确舍入的结果
+    d = (double)w;
+    d = q < 0 ? d / pow10_exact[-q] : d * pow10_exact[q];
+  } else {
+    eisel_lemire(w, q, &d);
+    if (trunc) {
+      // 被截断的数字介于w和w+1之间，两者结果相同时即为正确结果
+      double up;
+      eisel_lemire(w + 1, q, &up);
+      if (d != up)
+        d = strtod_fallback(*s + neg, str);
+    }
+  }
+  item->value_type = json_Float;
+  item->value.Float = neg ? -d : d;
+  *s = str;
+  return true;
+}
+
+// 因为parse_value 要调用此函数，提前声明一下
+static json *parse_object(struct parse_ctx *ctx, char **s);
+static bool parse_array(struct parse_ctx *ctx, char **s, json *item);
+static bool parse_array_parallel(struct parse_ctx *ctx, char **s, json *item);
+static void ctx_release(struct parse_ctx *ctx);
+static void free_value(json *item);
+static void free_chain(json *head);
+
+/**
+ * @brief 在临时栈顶申请内存
+ *
+ * 临时栈在解析过程中被各层数组共用，扩容后之前返回的指针失效，
+ * 因此调用者应记录偏移量而不是指针
+ *
+ * @param ctx 解析上下文
+ * @param size 字节数
+ * @return void* 失败返回NULL
+ */
+static void *stack_push(struct parse_ctx *ctx, size_t size) {
+  if (ctx->top + size > ctx->cap) {
+    size_t cap = ctx->cap ? ctx->cap * 2 : 1024;
+    while (cap < ctx->top + size)
+      cap *= 2;
+    char *stack = realloc(ctx->stack, cap);
+    if (!stack)
+      return NULL;
+    ctx->stack = stack;
+    ctx->cap = cap;
+  }
+  void *ret = ctx->stack + ctx->top;
+  ctx->top += size;
+  return ret;
+}
+
+/**
+ * @brief 解析一个值到json节点
+ *
+ * @param s 从*s开始解析，并修改*s指向值结束的下一个字符
+ * @param item 修改item的value, value_type
+ * @return bool 无法识别值时返回false，item为null；
+ * 数组申请内存失败时返回false，item为空数组
+ */
+static bool parse_value(struct parse_ctx *ctx, char **s, json *item) {
+  char *str = *s;
+  item->len = 0;
+
+  if (*str == '"') {
+    // value 为字符串
+    item->value_type = json_String;
+    if (ctx->doc && (ctx->flags & JSON_INTERN_STRINGS))
+      item->value.String = parse_str_intern(ctx, &str, JSON_INTERN_MAX);
+    else
+      item->value.String = parse_str(ctx, &str);
+
+  } else if ((*str >= '0' && *str <= '9') || *str == '-') {
+    // value 为数字类型
+    if (!parse_number(&str, item)) {
+      item->value_type = json_Null;
+      return false;
+    }
+
+  } else if (*str == '{') {
+    // value 为 object
+    item->value_type = json_Json;
+    item->value.Json = parse_object(ctx, &str);
+
+  } else if (*str == '[') {
+    // value 为 array
+    if (!parse_array(ctx, &str, item))
+      return false;
+
+  } else {
+    // value 为 null 或 bool 类型
+    if (!strncmp("null", str, 4)) {
+      item->value_type = json_Null;
+      str += 4;
+    } else if (!strncmp("true", str, 4)) {
+      item->value_type = json_Bool;
+      item->value.Bool = true;
+      str += 4;
+    } else if (!strncmp("false", str, 5)) {
+      item->value_type = json_Bool;
+      item->value.Bool = false;
+      str += 5;
+    } else {
+      item->value_type = json_Null;
+      return false;
+    }
+  }
+
+  *s = str;
+  return true;
+}
+
+/**
+ * @brief 解析json对象
+ *
+ * @param s 从*s字符串中解析，确保**s为`{`
+ * 并修改*s指向json对象结束的下一个字符
+ * @return json* 返回该json对象的首个item的指针
+ */
+static json *parse_object(struct parse_ctx *ctx, char **s) {
+  char *str = *s;
+  if (*str != '{')
+    return NULL;
+  str++;
+  str = skip(str);
+  json *ret = NULL;
+  json *head = NULL;
+  json *headed = NULL;
+  size_t nums = 0;
+  do {
+    // 忽略 `,`
+    while (*str == ',') {
+      str++;
+      str = skip(str);
+    }
 
-    } else if (*str == '{') {
-      // value 为 object
-      head->value_type = json_Json;
-      head->value.Json = parse_object(&str);
+    // 解析 key
+    if (*str == '}')
+      break;
+    if (*str != '"')
+      goto fail;
+
+    // 单独申请节点时，短的key与字符串值在节点之后，先记录位置
+    bool inline_str = !ctx->doc && !(ctx->flags & JSON_INSITU);
+    char *key_str = str;
+    size_t key_size = inline_str ? short_str(str) : 0;
+    char *key = NULL;
+    if (key_size)
+      str += key_size + 1;
+    else if (ctx->doc && (ctx->flags & JSON_INTERN))
+      key = parse_str_intern(ctx, &str, SIZE_MAX);
+    else
+      key = parse_str(ctx, &str);
+    if (!key_size && !key)
+      goto fail;
+
+    // 检测语法 `:`
+    str = skip(str);
+    if (*str != ':') {
+      ctx_free(ctx, key);
+      goto fail;
+    }
+    str++;
+    str = skip(str);
+    size_t value_size = inline_str && *str == '"' ? short_str(str) : 0;
+
+    // 值为数组时len为元素个数，无法记录标记，key单独申请
+    if (key_size && *str == '[') {
+      char *temp = key_str;
+      key = parse_str(ctx, &temp);
+      if (!key)
+        goto fail;
+      key_size = 0;
+    }
 
-    } else if (*str == '[') {
-      // value 为 array
-      parse_array(&str, head);
+    // 创建json节点，值不是数组的成员可以带有头部，
+    // 原文过长的延迟文档中节点的len没有标记位
+    bool with_head = !headed && *str != '[' &&
+                     (!(ctx->flags & JSON_LAZY) ||
+                      ctx->doc->tokens->len <= JSON_LEN_OFFSET);
+    json *node = json_create_member(ctx, with_head, key_size + value_size);
+    if (!node) {
+      ctx_free(ctx, key);
+      ctx->nomem = true;
+      goto fail;
+    }
+    if (ret)
+      head = head->next = node;
+    else
+      ret = head = node;
+    if (key_size) {
+      key = member_tail(head, with_head);
+      key_str++;
+      unescape_str(key, &key_str);
+    }
+    head->key = key;
+    head->next = NULL;
+    nums++;
 
+    // 解析 value，延迟模式只记录值在原文中的位置
+    bool ok = true;
+    if (value_size) {
+      head->value_type = json_String;
+      head->value.String = member_tail(head, with_head) + key_size;
+      head->len = 0;
+      str++;
+      unescape_str(head->value.String, &str);
+    } else if (ctx->flags & JSON_LAZY) {
+      char *end = skip_value(ctx->doc, str);
+      if (end == str)
+        break;
+      head->value_type = json_Lazy;
+      head->value.Doc = ctx->doc;
+      head->len = str - ctx->doc->text;
+      str = end;
     } else {
-      // value 为 null 或 bool 类型
-      if (!strncmp("null", str, 4)) {
-        head->value_type = json_Null;
-        str += 4;
-      } else if (!strncmp("true", str, 4)) {
-        head->value_type = json_Bool;
-        head->value.Bool = true;
-        str += 4;
-      } else if (!strncmp("false", str, 5)) {
-        head->value_type = json_Bool;
-        head->value.Bool = false;
-        str += 5;
+      ok = parse_value(ctx, &str, head);
+    }
+
+    // 值不是数组时在len中记录节点之后的内容，失败的值为null，同样记录
+    if (len_spare(head)) {
+      if (with_head) {
+        head->len |= JSON_LEN_HEAD;
+        headed = head;
       }
+      if (key_size)
+        head->len |= JSON_LEN_KEY;
+      if (value_size)
+        head->len |= JSON_LEN_STR;
     }
+    if (!ok)
+      break;
+
+    str = skip(str);
+  } while (*str == ',');
+
+  // 成员较多的对象建立索引，使查找为O(1)
+  if (nums >= JSON_INDEX_MIN)
+    build_index(ctx, ret, nums, headed);
+
+  if (*str == '}') {
+    *s = str + 1;
+    return ret;
+  }
+  *s = str;
+  return ret;
+
+fail:
+  // 单独申请时释放已解析的成员
+  if (!ctx->doc)
+    free_chain(ret);
+  return NULL;
+}
+
+/**
+ * @brief 数组元素对应的数组类型
+ *
+ * 空对象与解析失败的字符串为NULL，不能放入以NULL结尾的Jsons/Strings中
+ *
+ * @param elem 数组元素
+ * @return enum json_value_type Strings, Jsons, Ints, Floats, Bools 或 Mix
+ */
+static enum json_value_type array_kind(json *elem) {
+  switch (elem->value_type) {
+  case json_String:
+    return elem->value.String ? json_Strings : json_Mix;
+  case json_Json:
+    return elem->value.Json ? json_Jsons : json_Mix;
+  case json_Int:
+    return json_Ints;
+  case json_Float:
+    return json_Floats;
+  case json_Bool:
+    return json_Bools;
+  default:
+    return json_Mix;
+  }
+}
+
+/**
+ * @brief 将栈中同类型的值转换为json节点
+ *
+ * @param base 数组在临时栈中的起始偏移
+ * @param nums 元素个数
+ * @param kind 当前的数组类型
+ * @return bool 失败返回false
+ */
+static bool demote_to_mix(struct parse_ctx *ctx, size_t base, size_t nums,
+                          enum json_value_type kind) {
+  enum json_value_type type;
+  switch (kind) {
+  case json_Strings:
+    type = json_String;
+    break;
+  case json_Jsons:
+    type = json_Json;
+    break;
+  case json_Ints:
+    type = json_Int;
+    break;
+  case json_Floats:
+    type = json_Float;
+    break;
+  default:
+    type = json_Bool;
+  }
+
+  // 在值之后写入节点，再整体移动到数组起始处
+  if (!stack_push(ctx, nums * sizeof(json)))
+    return false;
+  union json_value *values = (union json_value *)(ctx->stack + base);
+  json *nodes = (json *)(values + nums);
+  for (size_t i = 0; i < nums; i++) {
+    nodes[i].next = NULL;
+    nodes[i].key = NULL;
+    nodes[i].value_type = type;
+    nodes[i].len = 0;
+    nodes[i].value = values[i];
+  }
+  memmove(values, nodes, nums * sizeof(json));
+  ctx->top = base + nums * sizeof(json);
+  return true;
+}
+
+/**
+ * @brief 由临时栈中的元素生成数组的值
+ *
+ * @param base 数组在临时栈中的起始偏移
+ * @param nums 元素个数
+ * @param kind 数组类型，Mix时栈中为json节点，否则为json_value
+ * @param item 修改item的value, value_type, len
+ * @return bool 申请内存失败时返回false，item为空数组，释放栈中的元素
+ */
+static bool build_array(struct parse_ctx *ctx, size_t base, size_t nums,
+                        enum json_value_type kind, json *item) {
+  union json_value *values = (union json_value *)(ctx->stack + base);
+  union json_value ret;
+  if (kind == json_Strings || kind == json_Jsons) {
+    ret.Strings = ctx_alloc(ctx, sizeof(char *) * (nums + 1));
+    if (ret.Strings) {
+      for (size_t i = 0; i < nums; i++)
+        ret.Strings[i] = values[i].String;
+      ret.Strings[nums] = NULL;
+    }
+    item->value_type = kind;
+  } else if (kind == json_Ints) {
+    ret.Ints = ctx_alloc(ctx, sizeof(long) * nums);
+    if (ret.Ints)
+      for (size_t i = 0; i < nums; i++)
+        ret.Ints[i] = values[i].Int;
+    item->value_type = json_Ints + nums;
+  } else if (kind == json_Floats) {
+    ret.Floats = ctx_alloc(ctx, sizeof(double) * nums);
+    if (ret.Floats)
+      for (size_t i = 0; i < nums; i++)
+        ret.Floats[i] = values[i].Float;
+    item->value_type = json_Floats + nums;
+  } else if (kind == json_Bools) {
+    ret.Bools = ctx_alloc(ctx, sizeof(bool) * nums);
+    if (ret.Bools)
+      for (size_t i = 0; i < nums; i++)
+        ret.Bools[i] = values[i].Bool;
+    item->value_type = json_Bools + nums;
+  } else {
+    // 混合数组的节点连续储存，同时保持next链接
+    ret.Mix = ctx_alloc(ctx, sizeof(json) * nums);
+    if (ret.Mix) {
+      memcpy(ret.Mix, values, sizeof(json) * nums);
+      for (size_t i = 0; i < nums; i++)
+        ret.Mix[i].next = i + 1 < nums ? &ret.Mix[i + 1] : NULL;
+    }
+    item->value_type = json_Mix;
+  }
+  item->value = ret;
+  item->len = nums;
+  if (ret.Mix)
+    return true;
+
+  // 单独申请时释放已压入的元素，文档中的随arena释放
+  if (!ctx->doc) {
+    for (size_t i = 0; i < nums; i++) {
+      if (kind == json_Strings)
+        free(values[i].String);
+      else if (kind == json_Jsons)
+        free_chain(values[i].Json);
+      else if (kind == json_Mix)
+        free_value((json *)values + i);
+    }
+  }
+  item->value_type = json_Mix;
+  item->len = 0;
+  ctx->nomem = true;
+  return false;
+}
+
+/**
+ * @brief 将数组元素压入临时栈
+ *
+ * 同类型的元素只压入值，遇到第一个类型冲突时将已压入的值转换为节点
+ *
+ * @param base 数组在临时栈中的起始偏移
+ * @param nums 已压入的元素个数，成功时加1
+ * @param kind 当前的数组类型，可能被修改为Mix
+ * @param elem 数组元素
+ * @return bool 失败返回false
+ */
+static bool array_push(struct parse_ctx *ctx, size_t base, size_t *nums,
+                       enum json_value_type *kind, json *elem) {
+  // 类型判断，Ints等的长度编码在类型中，超出范围时同样转为Mix
+  enum json_value_type elem_kind = array_kind(elem);
+  if (*kind == json_Null)
+    *kind = elem_kind;
+  if (*kind != json_Mix &&
+      (elem_kind != *kind || *nums >= json_Ints_end - json_Ints)) {
+    if (!demote_to_mix(ctx, base, *nums, *kind))
+      return false;
+    *kind = json_Mix;
+  }
+
+  // 压入临时栈
+  if (*kind == json_Mix) {
+    json *node = stack_push(ctx, sizeof(json));
+    if (!node)
+      return false;
+    *node = *elem;
+  } else {
+    union json_value *value = stack_push(ctx, sizeof(union json_value));
+    if (!value)
+      return false;
+    *value = elem->value;
+  }
+  (*nums)++;
+  return true;
+}
+
+/**
+ * @brief 由临时栈中的元素生成数组，并弹出这些元素
+ *
+ * @param base 数组在临时栈中的起始偏移
+ * @param nums 元素个数
+ * @param kind 数组类型
+ * @param item 修改item的value, value_type, len
+ * @return bool 申请内存失败返回false，item为空数组
+ */
+static bool array_finish(struct parse_ctx *ctx, size_t base, size_t nums,
+                         enum json_value_type kind, json *item) {
+  bool ok = true;
+  if (nums) {
+    ok = build_array(ctx, base, nums, kind, item);
+  } else {
+    item->value_type = json_Mix;
+    item->value.Mix = NULL;
+    item->len = 0;
+  }
+  ctx->top = base;
+  return ok;
+}
+
+/**
+ * @brief 解析array
+ *
+ * 单趟解析，同类型的元素值依次压入临时栈，
+ * 遇到第一个类型冲突时将已解析的值转换为混合数组的节点
+ *
+ * @param s 从*s字符串中解析，确保**s为`[`
+ * 并修改*s指向array对象结束的下一个字符
+ * @param item 父json节点指针，将修改value, value_type
+ * @return bool 申请内存失败返回false
+ */
+static bool parse_array(struct parse_ctx *ctx, char **s, json *item) {
+  char *str = *s;
+  if (*str != '[')
+    return true;
+  if ((ctx->flags & JSON_PARALLEL) && ctx->end &&
+      parse_array_parallel(ctx, s, item))
+    return !ctx->nomem;
+  str++;
+  str = skip(str);
+
+  size_t base = ctx->top;
+  size_t nums = 0;
+  enum json_value_type kind = json_Null;
+  while (*str != ']') {
+    // 忽略`,`
+    if (*str == ',') {
+      str++;
+      str = skip(str);
+      continue;
+    }
+
+    // 解析元素，嵌套数组会使用临时栈，因此先解析到局部节点
+    json elem;
+    elem.key = NULL;
+    if (!parse_value(ctx, &str, &elem))
+      break;
+    str = skip(str);
+
+    if (!array_push(ctx, base, &nums, &kind, &elem))
+      break;
+  }
+  bool ok = array_finish(ctx, base, nums, kind, item);
+
+  if (*str == ']')
+    *s = str + 1;
+  else
+    *s = str;
+  return ok;
+}
+
+/**
+ * @brief 按上下文从字符串中解析json
+ *
+ * @param ctx 解析上下文
+ * @param s
+ * @return json* 返回解析后的根节点
+ * 若失败返回NULL
+ */
+static json *parse_root(struct parse_ctx *ctx, char *s) {
+  char *str = s;
+  str = skip(str);
+  if (*str != '{')
+    return NULL;
+  json *ret = json_create(ctx);
+  if (!ret)
+    return NULL;
+  ret->key = NULL;
+  ret->next = NULL;
+  ret->value_type = json_Json;
+  ret->len = 0;
+  ret->value.Json = parse_object(ctx, &str);
+  if (ctx->nomem) {
+    if (!ctx->doc)
+      json_free(ret);
+    return NULL;
+  }
+  return ret;
+}
+
+/**
+ * @brief 从字符串中解析json
+ *
+ * @param s
+ * @return json* 返回解析后的根节点
+ * 若失败返回NULL
+ */
+json *json_parse(char *s) {
+  struct parse_ctx ctx = {.doc = NULL};
+  json *ret = parse_root(&ctx, s);
+  free(ctx.stack);
+  return ret;
+}
+
+/**
+ * @brief 按解析方式估计文档首块的大小，不足时arena按两倍增长
+ *
+ * 普通解析的树约为输入的两倍，原地解析不复制字符串；
+ * 延迟解析只建立访问到的节点，并行解析时数组元素在各线程的块中
+ *
+ * @param len 输入长度
+ * @param flags enum json_parse_flag 的组合
+ * @return size_t 字节数
+ */
+static size_t doc_reserve(size_t len, int flags) {
+  if (flags & (JSON_LAZY | JSON_PARALLEL))
+    return len / 8;
+  if (flags & JSON_INSITU)
+    return len;
+  return len * 2;
+}
+
+/**
+ * @brief 创建空文档
+ *
+ * @param size 首块中预留的字节数，通常由doc_reserve估计
+ * @return json_doc* 失败返回NULL
+ */
+static json_doc *doc_new(size_t size) {
+  size_t cap = size + JSON_BLOCK_MIN;
+  struct json_block *b = malloc(cap);
+  if (!b)
+    return NULL;
+  b->next = NULL;
+  b->ptr = (char *)(b + 1);
+  b->end = (char *)b + cap;
+
+  // 文档本身也位于首块中
+  json_doc *doc = (json_doc *)b->ptr;
+  b->ptr += (sizeof(json_doc) + 7) & ~(size_t)7;
+  doc->block = b;
+  doc->root = NULL;
+  doc->input = NULL;
+  doc->input_map = 0;
+  doc->text = NULL;
+  doc->flags = 0;
+  doc->tokens = NULL;
+  doc->intern = NULL;
+  return doc;
+}
+
+/**
+ * @brief 按上下文在文档中解析以'\0'结尾的输入，结果为ctx->doc->root
+ *
+ * 延迟的值以相对原文的偏移记录在len中，输入超过其范围时不延迟；
+ * 延迟解析时先建立结构索引，跳过未访问的值时不再逐字节扫描，
+ * 无法建立索引时(含有注释或括号不匹配)按普通方式解析
+ *
+ * @param ctx 解析上下文，doc与flags由调用者设置，使用后由调用者释放
+ * @param s 输入
+ * @param len 输入长度
+ */
+static void doc_parse_ctx(struct parse_ctx *ctx, char *s, size_t len) {
+  json_doc *doc = ctx->doc;
+  if ((ctx->flags & JSON_STRICT) && !strict_check(s, s + len, true)) {
+    doc->root = NULL;
+    return;
+  }
+  if (len > UINT_MAX)
+    ctx->flags &= ~JSON_LAZY;
+  if ((ctx->flags & JSON_LAZY) && !(doc->tokens = tokens_build(s, len)))
+    ctx->flags &= ~JSON_LAZY;
+  doc->flags = ctx->flags;
+  doc->text = ctx->flags & JSON_LAZY ? s : NULL;
+  ctx->end = s + len;
+  doc->root = parse_root(ctx, s);
+}
+
+/**
+ * @brief 在文档中解析以'\0'结尾的输入，结果为doc->root
+ *
+ * @param doc 由doc_new创建的文档
+ * @param s 输入
+ * @param len 输入长度
+ * @param flags enum json_parse_flag 的组合
+ */
+static void doc_parse(json_doc *doc, char *s, size_t len, int flags) {
+  struct parse_ctx ctx = {.doc = doc, .flags = flags};
+  doc_parse_ctx(&ctx, s, len);
+  ctx_release(&ctx);
+}
+
+/**
+ * @brief 从字符串中解析json文档，所有节点与字符串由文档的arena分配
+ *
+ * @param s
+ * @param flags enum json_parse_flag 的组合
+ * @return json_doc* 返回解析后的文档，根节点为doc->root
+ * 若失败返回NULL
+ */
+json_doc *json_doc_parse(char *s, int flags) {
+  size_t len = strlen(s);
+  json_doc *doc = doc_new(doc_reserve(len, flags));
+  if (!doc)
+    return NULL;
+
+  doc_parse(doc, s, len, flags);
+  if (!doc->root) {
+    json_doc_free(doc);
+    return NULL;
+  }
+  return doc;
+}
+
+/**
+ * @brief 释放json文档，一次性归还arena中的所有内存块
+ *
+ * @param doc 由json_doc_parse返回的文档
+ */
+void json_doc_free(json_doc *doc) {
+  if (!doc)
+    return;
+#ifdef JSON_POSIX
+  if (doc->input_map)
+    munmap(doc->input, doc->input_map);
+  else
+#endif
+    free(doc->input);
+  tokens_free(doc->tokens);
+  intern_free(doc->intern);
+  struct json_block *b = doc->block;
+  while (b) {
+    struct json_block *next = b->next;
+    free(b);
+    b = next;
+  }
+}
+
+/**
+ * @brief 查找文档中驻留的字符串
+ *
+ * @param doc 以 JSON_INTERN 解析的文档
+ * @param str 以'\0'结尾
+ * @return char* 文档中与str相同的驻留字符串，没有时返回NULL
+ */
+char *json_doc_intern(const json_doc *doc, const char *str) {
+  size_t len = strlen(str);
+  if (len > UINT32_MAX)
+    return NULL;
+  return intern_find(doc->intern, str, len, key_hash(str, len));
+}
+
+/**
+ * @brief 可复用的解析上下文
+ *
+ * doc 的arena与临时栈在两次解析之间保留，
+ * 重置时多个内存块合并为一块，容量逐渐增长到负载的最大值
+ */
+struct json_parser_ctx {
+  json_doc doc;
+  char *stack;
+  size_t cap;
+};
+
+/**
+ * @brief 创建可复用的解析上下文
+ *
+ * @return json_parser_ctx* 由json_ctx_free释放，失败返回NULL
+ */
+json_parser_ctx *json_ctx_new(void) {
+  json_parser_ctx *c = calloc(1, sizeof(json_parser_ctx));
+  if (!c)
+    return NULL;
+  struct json_block *b = malloc(JSON_BLOCK_MIN);
+  if (!b) {
+    free(c);
+    return NULL;
+  }
+  b->next = NULL;
+  b->ptr = (char *)(b + 1);
+  b->end = (char *)b + JSON_BLOCK_MIN;
+  c->doc.block = b;
+  return c;
+}
+
+/**
+ * @brief 以新的内存块替换上下文的所有内存块
+ *
+ * @param cap 新块的字节数
+ * @return bool 申请失败时保持原样并返回false
+ */
+static bool ctx_replace_block(json_parser_ctx *c, size_t cap) {
+  struct json_block *b = malloc(cap);
+  if (!b)
+    return false;
+  struct json_block *old = c->doc.block;
+  while (old) {
+    struct json_block *next = old->next;
+    free(old);
+    old = next;
+  }
+  b->next = NULL;
+  b->ptr = (char *)(b + 1);
+  b->end = (char *)b + cap;
+  c->doc.block = b;
+  return true;
+}
+
+/**
+ * @brief 丢弃上一次解析的内容，内存块保持原样
+ *
+ * @param c 解析上下文
+ */
+static void ctx_forget(json_parser_ctx *c) {
+  json_doc *doc = &c->doc;
+  tokens_free(doc->tokens);
+
+  // 驻留表清空后保留容量，字符串随arena一起重置
+  if (doc->intern) {
+    memset(doc->intern->strs, 0, (doc->intern->mask + 1) * sizeof(char *));
+    doc->intern->nums = 0;
+  }
+  doc->root = NULL;
+  doc->text = NULL;
+  doc->flags = 0;
+  doc->tokens = NULL;
+}
+
+/**
+ * @brief 将多个内存块合并为一块，并清空arena
+ *
+ * @param c 解析上下文，内容已丢弃
+ * @param want 合并后至少的字节数
+ */
+static void ctx_merge(json_parser_ctx *c, size_t want) {
+  struct json_block *b = c->doc.block;
+  size_t cap = 0;
+  for (struct json_block *p = b; p; p = p->next)
+    cap += p->end - (char *)p;
+  if (cap < want)
+    cap = want;
+
+  // 合并后同样大小的文档不再申请内存
+  if ((b->next || (size_t)(b->end - (char *)b) < cap) &&
+      !ctx_replace_block(c, cap)) {
+    // 无法合并时只保留当前块，即最大的一块
+    struct json_block *p = b->next;
+    while (p) {
+      struct json_block *next = p->next;
+      free(p);
+      p = next;
+    }
+    b->next = NULL;
+  }
+  c->doc.block->ptr = (char *)(c->doc.block + 1);
+}
+
+/**
+ * @brief 重置上下文，上一次解析的文档失效，内存保留给下一次解析
+ *
+ * @param c 解析上下文
+ */
+void json_ctx_reset(json_parser_ctx *c) {
+  ctx_forget(c);
+  ctx_merge(c, 0);
+}
+
+/**
+ * @brief 使用上下文解析json文档
+ *
+ * 上一次解析的文档失效。arena与临时栈足够时不申请内存，
+ * 不足时按输入长度一次扩大
+ *
+ * @param c 解析上下文
+ * @param s 输入
+ * @param flags enum json_parse_flag 的组合
+ * @return json_doc* 属于上下文，不能用json_doc_free释放，失败返回NULL
+ */
+json_doc *json_ctx_parse(json_parser_ctx *c, char *s, int flags) {
+  size_t len = strlen(s);
+  ctx_forget(c);
+  ctx_merge(c, doc_reserve(len, flags) + JSON_BLOCK_MIN);
+
+  struct parse_ctx ctx = {
+      .doc = &c->doc, .flags = flags, .stack = c->stack, .cap = c->cap};
+  doc_parse_ctx(&ctx, s, len);
+  c->stack = ctx.stack;
+  c->cap = ctx.cap;
+  ctx.stack = NULL;
+  ctx_release(&ctx);
+  return c->doc.root ? &c->doc : NULL;
+}
+
+/**
+ * @brief 归还上下文保留的内存，用于空闲时
+ *
+ * 上一次解析的文档失效，之后的解析重新按需申请
+ *
+ * @param c 解析上下文
+ */
+void json_ctx_shrink(json_parser_ctx *c) {
+  // 直接替换所有内存块，不先合并
+  ctx_forget(c);
+  free(c->stack);
+  c->stack = NULL;
+  c->cap = 0;
+  intern_free(c->doc.intern);
+  c->doc.intern = NULL;
+  ctx_replace_block(c, JSON_BLOCK_MIN);
+}
+
+/**
+ * @brief 释放解析上下文及其文档
+ *
+ * @param c 解析上下文，可以为NULL
+ */
+void json_ctx_free(json_parser_ctx *c) {
+  if (!c)
+    return;
+  // 文档位于上下文中，json_doc_free只释放其内存块与驻留表
+  json_doc_free(&c->doc);
+  free(c->stack);
+  free(c);
+}
+
+/**
+ * @brief 以大块读取整个输入，末尾写入'\0'
+ *
+ * 用于无法映射的输入，如管道和终端
+ *
+ * @param fd 已打开的文件
+ * @param len 修改为读取的字节数
+ * @return char* 由malloc申请，失败返回NULL
+ */
+#ifdef JSON_POSIX
+static char *read_all(int fd, size_t *len) {
+#else
+static char *read_all(FILE *fd, size_t *len) {
+#endif
+  size_t cap = JSON_READ_CHUNK;
+  size_t size = 0;
+  char *buf = malloc(cap + 1);
+  if (!buf)
+    return NULL;
+  for (;;) {
+    if (size == cap) {
+      char *temp = realloc(buf, cap * 2 + 1);
+      if (!temp) {
+        free(buf);
+        return NULL;
+      }
+      buf = temp;
+      cap *= 2;
+    }
+#ifdef JSON_POSIX
+    ssize_t n = read(fd, buf + size, cap - size);
+    if (n < 0) {
+      free(buf);
+      return NULL;
+    }
+#else
+    size_t n = fread(buf + size, 1, cap - size, fd);
+#endif
+    if (n == 0)
+      break;
+    size += n;
+  }
+  buf[size] = '\0';
+  *len = size;
+  return buf;
+}
+
+#ifdef JSON_POSIX
+/**
+ * @brief 将文件映射到内存，映射之后至少有一个为'\0'的字节作为哨兵
+ *
+ * 先保留一段匿名映射，再将文件以私有映射覆盖在其开头，
+ * 文件长度为页大小的整数倍时哨兵位于之后的匿名页中，
+ * 否则位于文件最后一页被填充为0的部分。
+ * 私有映射写入时复制，原地解析不会修改文件
+ *
+ * @param fd 已打开的普通文件
+ * @param len 文件长度，不为0
+ * @param map_len 修改为映射的总长度
+ * @return char* 映射的开始，失败返回NULL
+ */
+static char *map_file(int fd, size_t len, size_t *map_len) {
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t total = (len / page + 1) * page;
+  char *map = mmap(NULL, total, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (map == MAP_FAILED)
+    return NULL;
+  if (mmap(map, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd,
+           0) == MAP_FAILED) {
+    munmap(map, total);
+    return NULL;
+  }
+  // 解析是单趟顺序读取，提示内核加大预读
+  madvise(map, len, MADV_SEQUENTIAL);
+  *map_len = total;
+  return map;
+}
+#endif
+
+/**
+ * @brief 从文件中解析json文档
+ *
+ * 普通文件映射到内存后直接解析，不经过stdio逐字节读取；
+ * 管道等无法映射的输入以大块读取到缓冲区中解析。
+ * 不使用 JSON_INSITU 或 JSON_LAZY 时解析完成后立即释放输入，
+ * 否则输入随文档一起释放
+ *
+ * @param path 文件路径
+ * @param flags enum json_parse_flag 的组合
+ * @return json_doc* 返回解析后的文档，若失败返回NULL
+ */
+json_doc *json_parse_file(const char *path, int flags) {
+  char *buf = NULL;
+  size_t len = 0;
+  size_t map_len = 0;
+
+#ifdef JSON_POSIX
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+  struct stat st;
+  if (!fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0) {
+    len = st.st_size;
+    buf = map_file(fd, len, &map_len);
+  }
+  if (!buf)
+    buf = read_all(fd, &len);
+  close(fd);
+#else
+  FILE *fd = fopen(path, "rb");
+  if (!fd)
+    return NULL;
+  buf = read_all(fd, &len);
+  fclose(fd);
+#endif
+  if (!buf)
+    return NULL;
+
+  json_doc *doc = doc_new(doc_reserve(len, flags));
+  if (doc) {
+    doc_parse(doc, buf, len, flags);
+    doc->input = buf;
+    doc->input_map = map_len;
+    if (!doc->root) {
+      json_doc_free(doc);
+      return NULL;
+    }
+    if (!(doc->flags & (JSON_INSITU | JSON_LAZY))) {
+#ifdef JSON_POSIX
+      if (map_len)
+        munmap(buf, map_len);
+      else
+#endif
+        free(buf);
+      doc->input = NULL;
+      doc->input_map = 0;
+    }
+    return doc;
+  }
+
+#ifdef JSON_POSIX
+  if (map_len)
+    munmap(buf, map_len);
+  else
+#endif
+    free(buf);
+  return NULL;
+}
+
+/**
+ * @brief 释放json节点的值，不释放节点本身
+ *
+ * @param item
+ */
+static void free_value(json *item) {
+  if (item->value_type == json_String) {
+    free(item->value.String);
+  } else if (item->value_type == json_Json) {
+    free_chain(item->value.Json);
+  } else if (item->value_type >= json_Ints &&
+             item->value_type <= json_Ints_end) {
+    free(item->value.Ints);
+  } else if (item->value_type >= json_Floats &&
+             item->value_type <= json_Floats_end) {
+    free(item->value.Floats);
+  } else if (item->value_type >= json_Bools &&
+             item->value_type <= json_Bools_end) {
+    free(item->value.Bools);
+  } else if (item->value_type == json_Strings) {
+    for (size_t i = 0; i < item->len; i++)
+      free(item->value.Strings[i]);
+    free(item->value.Strings);
+  } else if (item->value_type == json_Jsons) {
+    for (size_t i = 0; i < item->len; i++)
+      free_chain(item->value.Jsons[i]);
+    free(item->value.Jsons);
+  } else if (item->value_type == json_Mix) {
+    // 混合数组的节点连续储存，整体释放
+    for (size_t i = 0; i < item->len; i++)
+      free_value(&item->value.Mix[i]);
+    free(item->value.Mix);
+  }
+}
+
+/**
+ * @brief 释放json节点链表的内存
+ *
+ * @param head 链表的首个节点
+ */
+static void free_chain(json *head) {
+  json *next = head;
+  while (next) {
+    // 释放key和value，与节点一起申请的短字符串不单独释放
+    unsigned int flags = len_flags(next);
+    if (!(flags & JSON_LEN_KEY))
+      free(next->key);
+    if (!(flags & JSON_LEN_STR))
+      free_value(next);
+
+    // 并释放本节点，json_head 与节点一起申请
+    if (flags & JSON_LEN_HEAD)
+      free(object_head(next)->index);
+    json *temp = next;
+    next = next->next;
+    free(temp);
+  }
+}
+
+/**
+ * @brief 释放json树的内存
+ *
+ * @param root json树的根节点
+ */
+void json_free(json *root) { free_chain(root); }
+
+/**
+ * @brief 解析延迟的值，之后该节点与立即解析的节点相同
+ *
+ * 值中的对象同样只解析一层，成员仍为延迟的值；值有误时为null
+ *
+ * @param item 值类型为 json_Lazy 的节点
+ */
+static void lazy_load(json *item) {
+  json_doc *doc = item->value.Doc;
+  unsigned int flags = len_flags(item);
+  char *str = doc->text + (flags ? item->len & JSON_LEN_OFFSET : item->len);
+  struct parse_ctx ctx = {.doc = doc, .flags = doc->flags};
+  if (!parse_value(&ctx, &str, item)) {
+    item->value_type = json_Null;
+    item->len = 0;
+  }
+  // 带有标记的值不是数组，解析后保留标记
+  item->len |= flags;
+  ctx_release(&ctx);
+}
+
+/**
+ * @brief 确保节点的值已解析
+ *
+ * JSON_LAZY 文档中直接访问value之前需要调用，
+ * jump, json_read_str, json_path_get 等查找函数会自动调用
+ *
+ * @param item 节点，可以为NULL
+ * @return json* 返回item
+ */
+json *json_load(json *item) {
+  if (item && item->value_type == json_Lazy)
+    lazy_load(item);
+  return item;
+}
+
+/**
+ * @brief 在对象中查找成员，使用已计算好的哈希值
+ *
+ * 有索引时按哈希查找，否则沿链表逐个比较
+ *
+ * @param first 对象的首个成员节点
+ * @param key 不需要以'\0'结尾
+ * @param len key的长度
+ * @param hash key_hash(key, len)，对象没有索引时不使用
+ * @return json* 第一个key匹配的成员，未找到返回NULL
+ */
+static json *find_member_hashed(json *first, const char *key, size_t len,
+                                uint32_t hash) {
+  struct json_index *index = object_index(first);
+  if (index) {
+    for (size_t i = hash & index->mask; index->slots[i].node;
+         i = (i + 1) & index->mask) {
+      struct json_slot *slot = &index->slots[i];
+      if (slot->hash == hash && slot->len == len &&
+          !memcmp(slot->node->key, key, len))
+        return slot->node;
+    }
+    return NULL;
+  }
+  // 驻留的key先比较指针
+  for (json *next = first; next; next = next->next)
+    if (next->key == key ||
+        (!strncmp(next->key, key, len) && next->key[len] == '\0'))
+      return next;
+  return NULL;
+}
+
+/**
+ * @brief 在对象中查找成员，只在对象有索引时计算哈希值
+ *
+ * @param first 对象的首个成员节点
+ * @param key 不需要以'\0'结尾
+ * @param len key的长度
+ * @return json* 第一个key匹配的成员，未找到返回NULL
+ */
+static json *find_member(json *first, const char *key, size_t len) {
+  uint32_t hash = 0;
+  if (object_index(first))
+    hash = key_hash(key, len);
+  return find_member_hashed(first, key, len, hash);
+}
+
+/**
+ * @brief 根据key描述该返回值，并通过type告知该值的类型
+ *
+ * @param key 跳转描述，从key指向字符开始到SPLIT或'\0'结束
+ * 描述规则：
+ *   - 当key第一个字符为SPLIT时
+ *     - 如果为 null，bool，number，string，返回该值。
+ *     - 如果为 json 返回第一个值
+ *     - 如果为 array 返回第一个元素
+ *   - 当base值类型为 json 时，按key到SPLIT或`\0`中的字符串查找值并返回
+ *   - 当base值类型为 array 时，
+ * 按key到SPLIT或`\0`的字符串atoi(十进制)为数字n并返回第n+1个元素
+ * @param base 跳转的基点，从value开始搜索
+ * @param type 修改为该返回值的类型
+ * @return union
+ */
+static union json_value jump_value(char *key, json *base,
+                                   enum json_value_type *type) {
+  char *str = key;
+  union json_value ret;
+  json_load(base);
+  if (*str == SPLIT) {
+    if (base->value_type == json_Null || base->value_type == json_Int ||
+        base->value_type == json_Float || base->value_type == json_Bool ||
+        base->value_type == json_String || base->value_type == json_Json) {
+      *type = base->value_type;
+      return base->value;
+    } else if (base->value_type == json_Mix) {
+      *type = base->value.Mix->value_type;
+      return base->value.Mix->value;
+    } else if (base->value_type == json_Strings) {
+      *type = json_String;
+      ret.String = base->value.Strings[0];
+      return ret;
+    } else if (base->value_type == json_Jsons) {
+      *type = json_Json;
+      ret.Json = base->value.Jsons[0];
+      return ret;
+    } else if (base->value_type >= json_Ints &&
+               base->value_type <= json_Ints_end) {
+      *type = json_Int;
+      ret.Int = base->value.Ints[0];
+      return ret;
+    } else if (base->value_type >= json_Floats &&
+               base->value_type <= json_Floats_end) {
+      *type = json_Float;
+      ret.Float = base->value.Floats[0];
+      return ret;
+    } else if (base->value_type >= json_Bools &&
+               base->value_type <= json_Bools_end) {
+      *type = json_Bool;
+      ret.Bool = base->value.Bools[0];
+      return ret;
+    }
+  }
+  if (base->value_type == json_Json) {
+    size_t strn;
+    for (strn = 0; str[strn] != SPLIT && str[strn]; strn++)
+      continue;
+    json *next = json_load(find_member(base->value.Json, str, strn));
+    if (!next) {
+      JSON_NOT_FOUND_ERROR;
+      *type = json_Null;
+      return ret;
+    }
+    *type = next->value_type;
+    return next->value;
+  }
+  if (base->value_type == json_Mix || base->value_type == json_Strings ||
+      base->value_type == json_Jsons) {
+    // 数组长度记录在len中，下标检查为O(1)
+    int n = atoi(str);
+    if (n < 0 || (unsigned int)n >= base->len) {
+      JSON_NOT_FOUND_ERROR;
+      *type = json_Null;
+      return ret;
+    }
+    if (base->value_type == json_Mix) {
+      *type = base->value.Mix[n].value_type;
+      return base->value.Mix[n].value;
+    }
+    if (base->value_type == json_Strings) {
+      *type = json_String;
+      ret.String = base->value.Strings[n];
+      return ret;
+    }
+    *type = json_Json;
+    ret.Json = base->value.Jsons[n];
+    return ret;
+  }
+  *type = json_Null;
+  return ret;
+}
+
+/**
+ * @brief 根据key的描述返回该节点
+ * 操作对象为 json
+ *
+ * @param key 跳转描述，从key指向字符开始到SPLIT或'\0'结束
+ * - 当base值类型为 json 时，按key到SPLIT或`\0`中的字符串查找值并返回
+ * - 若str指向 SPLIT 则返回第一个json节点
+ * @param base 跳转基点，从value开始搜索
+ * @return json* key匹配的json节点
+ */
+static json *jump(char *key, json *base) {
+  char *str = key;
+  json_load(base);
+  if (*str == SPLIT || *str == '\0') {
+    if (base->value_type == json_Json) {
+      return base->value.Json;
+    }
+  }
+  if (base->value_type == json_Json) {
+    size_t strn;
+    for (strn = 0; str[strn] != SPLIT && str[strn]; strn++)
+      continue;
+    json *next = json_load(find_member(base->value.Json, str, strn));
+    if (!next) {
+      JSON_NOT_FOUND_ERROR;
+    }
+    return next;
+  }
+  JSON_NOT_FOUND_ERROR;
+  return NULL;
+}
+
+/**
+ * @brief 根据key返回对应的字符串
+ *
+ * @param key 键
+ * @param base 待操作json树
+ * @return char* 返回key对应的字符串
+ */
+char *json_read_str(char *key, json *base) {
+  char *str = key;
+  json *item = NULL;
+  size_t strn;
+  for (strn = 0; str[strn] != SPLIT && str[strn]; strn++)
+    continue;
+  json_load(base);
+  if (base->value_type == json_Json) {
+    item = jump(key, base);
+  } else if (base->value_type == json_Jsons ||
+             base->value_type == json_Strings) {
+    int n = atoi(str);
+    if (n < 0 || (unsigned int)n >= base->len) {
+      JSON_NOT_FOUND_ERROR;
+      return NULL;
+    }
+    // 字符串数组的元素为最后一段
+    if (base->value_type == json_Strings)
+      return str[strn] ? NULL : base->value.Strings[n];
+    if (!str[strn])
+      return NULL;
+    // 数组元素没有父节点，以临时节点作为下一段的基点
+    json element;
+    element.value_type = json_Json;
+    element.len = 0;
+    element.value.Json = base->value.Jsons[n];
+    return json_read_str(str + strn + 1, &element);
+  } else {
+    return NULL;
+  }
+  if (!item)
+    return NULL;
+  if (str[strn])
+    return json_read_str(str + strn + 1, item);
+  else
+    return item->value.String;
+}
+/**
+ * @brief 编译后路径中的一段
+ *
+ * index 为该段按十进制解析的下标，不全是数字时为-1
+ */
+struct json_path_seg {
+  const char *key;
+  size_t len;
+  uint32_t hash;
+  long index;
+};
+
+/**
+ * @brief 编译后的路径
+ *
+ * 与各段一起申请的还有路径字符串的副本，各段的key指向其中
+ */
+struct json_path {
+  size_t nums;
+  struct json_path_seg segs[];
+};
+
+/**
+ * @brief 编译路径
+ *
+ * @param path 以SPLIT分隔的路径，规则与json_read_str相同，
+ * 空字符串表示基点本身
+ * @return json_path* 由json_path_free释放，失败返回NULL
+ */
+json_path *json_path_compile(const char *path) {
+  size_t len = strlen(path);
+  size_t nums = 0;
+  if (len) {
+    nums = 1;
+    for (size_t i = 0; i < len; i++)
+      nums += path[i] == SPLIT;
+  }
+
+  json_path *ret = malloc(sizeof(json_path) +
+                          sizeof(struct json_path_seg) * nums + len + 1);
+  if (!ret)
+    return NULL;
+  ret->nums = nums;
+  char *str = (char *)(ret->segs + nums);
+  memcpy(str, path, len + 1);
+
+  // 切分各段，并预先计算哈希与下标
+  for (size_t i = 0; i < nums; i++) {
+    struct json_path_seg *seg = &ret->segs[i];
+    size_t strn;
+    for (strn = 0; str[strn] != SPLIT && str[strn]; strn++)
+      continue;
+    seg->key = str;
+    seg->len = strn;
+    seg->hash = key_hash(str, strn);
+    seg->index = strn && strn < 19 ? 0 : -1;
+    for (size_t j = 0; j < strn && seg->index >= 0; j++) {
+      if (str[j] >= '0' && str[j] <= '9')
+        seg->index = seg->index * 10 + (str[j] - '0');
+      else
+        seg->index = -1;
+    }
+    str[strn] = '\0';
+    str += strn + 1;
+  }
+  return ret;
+}
+
+/**
+ * @brief 释放编译后的路径
+ *
+ * @param path
+ */
+void json_path_free(json_path *path) { free(path); }
+
+/**
+ * @brief 按路径的一段跳转
+ *
+ * @param seg 路径中的一段
+ * @param item 当前节点，修改为跳转后的节点，
+ * 数组元素不是节点时只修改value_type, value
+ * @return bool 未找到时返回false
+ */
+static bool path_step(const struct json_path_seg *seg, json *item) {
+  enum json_value_type t = item->value_type;
+  union json_value v = item->value;
+
+  if (t == json_Json) {
+    json *next = find_member_hashed(v.Json, seg->key, seg->len, seg->hash);
+    if (!next)
+      return false;
+    *item = *json_load(next);
+    return true;
+  }
+
+  if (seg->index < 0)
+    return false;
+  size_t n = seg->index;
+  if (t == json_Mix || t == json_Strings || t == json_Jsons) {
+    if (n >= item->len)
+      return false;
+    if (t == json_Mix) {
+      *item = v.Mix[n];
+      return true;
+    }
+    item->value_type = t == json_Strings ? json_String : json_Json;
+    item->value.String = v.Strings[n];
+  } else if (t > json_Ints && t <= json_Ints_end) {
+    if (n >= (size_t)(t - json_Ints))
+      return false;
+    item->value_type = json_Int;
+    item->value.Int = v.Ints[n];
+  } else if (t > json_Floats && t <= json_Floats_end) {
+    if (n >= (size_t)(t - json_Floats))
+      return false;
+    item->value_type = json_Float;
+    item->value.Float = v.Floats[n];
+  } else if (t > json_Bools && t <= json_Bools_end) {
+    if (n >= (size_t)(t - json_Bools))
+      return false;
+    item->value_type = json_Bool;
+    item->value.Bool = v.Bools[n];
+  } else {
+    return false;
+  }
+  item->len = 0;
+  return true;
+}
+
+/**
+ * @brief 按编译后的路径取值
+ *
+ * @param path 编译后的路径
+ * @param base 跳转的基点，从value开始搜索
+ * @param type 修改为该值的类型
+ * @param value 修改为该值
+ * @return bool 未找到时返回false
+ */
+bool json_path_get(const json_path *path, json *base,
+                   enum json_value_type *type, union json_value *value) {
+  json item = *json_load(base);
+  for (size_t i = 0; i < path->nums; i++)
+    if (!path_step(&path->segs[i], &item))
+      return false;
+  *type = item.value_type;
+  *value = item.value;
+  return true;
+}
+
+/**
+ * @brief 按编译后的路径取字符串
+ *
+ * @return char* 未找到或不是字符串时返回NULL
+ */
+char *json_path_get_str(const json_path *path, json *base) {
+  enum json_value_type type;
+  union json_value value;
+  if (!json_path_get(path, base, &type, &value) || type != json_String)
+    return NULL;
+  return value.String;
+}
+
+/**
+ * @brief 按编译后的路径取整数
+ *
+ * @param out 修改为该整数
+ * @return bool 未找到或不是整数时返回false
+ */
+bool json_path_get_int(const json_path *path, json *base, long *out) {
+  enum json_value_type type;
+  union json_value value;
+  if (!json_path_get(path, base, &type, &value) || type != json_Int)
+    return false;
+  *out = value.Int;
+  return true;
+}
+
+/**
+ * @brief 按编译后的路径取浮点数，整数会被转换为浮点数
+ *
+ * @param out 修改为该浮点数
+ * @return bool 未找到或不是数字时返回false
+ */
+bool json_path_get_float(const json_path *path, json *base, double *out) {
+  enum json_value_type type;
+  union json_value value;
+  if (!json_path_get(path, base, &type, &value))
+    return false;
+  if (type == json_Float)
+    *out = value.Float;
+  else if (type == json_Int)
+    *out = value.Int;
+  else
+    return false;
+  return true;
+}
+
+/**
+ * @brief 按编译后的路径取布尔值
+ *
+ * @param out 修改为该布尔值
+ * @return bool 未找到或不是布尔值时返回false
+ */
+bool json_path_get_bool(const json_path *path, json *base, bool *out) {
+  enum json_value_type type;
+  union json_value value;
+  if (!json_path_get(path, base, &type, &value) || type != json_Bool)
+    return false;
+  *out = value.Bool;
+  return true;
+}
+
+/**
+ * @brief 按编译后的路径取对象
+ *
+ * @return json* 对象的首个成员节点，未找到、不是对象或对象为空时返回NULL
+ */
+json *json_path_get_json(const json_path *path, json *base) {
+  enum json_value_type type;
+  union json_value value;
+  if (!json_path_get(path, base, &type, &value) || type != json_Json)
+    return NULL;
+  return value.Json;
+}
+
+/**
+ * @brief 增量解析器的词法状态
+ *
+ * 跨越数据块的记号保存在tok中，状态记录该记号的种类
+ */
+enum parser_state {
+  PARSER_NORMAL,
+  PARSER_STRING,  // 字符串
+  PARSER_NUMBER,  // 数字
+  PARSER_LITERAL, // null, true, false
+  PARSER_SLASH,   // 注释开头的`/`
+  PARSER_LINE,    // 注释 `//`
+  PARSER_BLOCK,   // 注释 `/* */`
+  PARSER_DONE,    // 根对象已结束，忽略之后的输入
+  PARSER_ERROR,
+};
+
+/**
+ * @brief 容器中下一个应出现的记号
+ *
+ * - EXPECT_KEY 对象的key或`}`
+ * - EXPECT_COLON 对象的`:`
+ * - EXPECT_VALUE 值，数组中也可以是`]`
+ * - EXPECT_COMMA `,`或容器的结尾
+ */
+enum parser_expect {
+  EXPECT_KEY,
+  EXPECT_COLON,
+  EXPECT_VALUE,
+  EXPECT_COMMA,
+};
+
+/**
+ * @brief 增量解析器中一层未结束的容器
+ *
+ * 对象的成员链表为first到last，数组的元素与parse_array一样压入临时栈；
+ * headed 为带有 json_head 的成员，with_head 为last之后是否留有头部
+ */
+struct parser_frame {
+  bool object;
+  bool with_head;
+  enum parser_expect expect;
+  json *first;
+  json *last;
+  json *headed;
+  size_t nums;
+  size_t base;
+  enum json_value_type kind;
+};
+
+/**
+ * @brief 增量解析器
+ *
+ * escape 为跨块的字符串中上一块以未配对的`\`结尾，
+ * star 为跨块的注释中上一块以`*`结尾
+ */
+struct json_parser {
+  struct parse_ctx ctx;
+  enum parser_state state;
+  bool escape;
+  bool star;
+  char *tok;
+  size_t tok_len;
+  size_t tok_cap;
+  struct parser_frame *frames;
+  size_t depth;
+  size_t frames_cap;
+  json *root;
+};
+
+/**
+ * @brief 创建增量解析器
+ *
+ * @return json_parser* 失败返回NULL
+ */
+json_parser *json_parser_new(void) {
+  json_parser *p = calloc(1, sizeof(json_parser));
+  if (!p)
+    return NULL;
+  p->state = PARSER_NORMAL;
+  return p;
+}
+
+/**
+ * @brief 追加到跨块的记号
+ *
+ * @return bool 失败返回false
+ */
+static bool parser_tok_append(json_parser *p, const char *buf, size_t len) {
+  if (p->tok_len + len + 1 > p->tok_cap) {
+    size_t cap = p->tok_cap ? p->tok_cap * 2 : 256;
+    while (cap < p->tok_len + len + 1)
+      cap *= 2;
+    char *tok = realloc(p->tok, cap);
+    if (!tok)
+      return false;
+    p->tok = tok;
+    p->tok_cap = cap;
+  }
+  memcpy(p->tok + p->tok_len, buf, len);
+  p->tok_len += len;
+  p->tok[p->tok_len] = '\0';
+  return true;
+}
+
+/**
+ * @brief 在数据块中查找字符串结尾的`"`
+ *
+ * `"`之前连续的`\`为奇数个时该`"`被转义
+ *
+ * @param str 字符串在本块中的开始
+ * @param end 本块的结尾
+ * @param escape 本块之前的部分是否以未配对的`\`结尾，
+ * 未找到结尾时修改为本块的情况
+ * @return const char* 结尾`"`的指针，未找到返回NULL
+ */
+static const char *parser_str_end(const char *str, const char *end,
+                                  bool *escape) {
+  const char *from = str;
+  for (;;) {
+    const char *quote = memchr(from, '"', end - from);
+    const char *stop = quote ? quote : end;
+
+    // 统计stop之前连续的`\`
+    size_t run = 0;
+    while (stop - run > str && *(stop - run - 1) == '\\')
+      run++;
+    bool odd = run & 1;
+    if (stop - run == str)
+      odd ^= *escape;
+
+    if (!quote) {
+      *escape = odd;
+      return NULL;
+    }
+    if (!odd)
+      return quote;
+    from = quote + 1;
+  }
+}
+
+/**
+ * @brief 是否为数字记号中的字符
+ */
+static bool is_number_char(char ch) {
+  return (ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' ||
+         ch == 'e' || ch == 'E';
+}
+
+/**
+ * @brief 是否为null, true, false记号中的字符
+ */
+static bool is_literal_char(char ch) { return ch >= 'a' && ch <= 'z'; }
+
+/**
+ * @brief 当前容器
+ */
+static struct parser_frame *parser_top(json_parser *p) {
+  return p->depth ? &p->frames[p->depth - 1] : NULL;
+}
+
+/**
+ * @brief 将一个完整的值放入当前容器
+ *
+ * @param elem 值，数组元素会被复制
+ * @return bool 语法错误返回false
+ */
+static bool parser_value(json_parser *p, json *elem) {
+  struct parser_frame *top = parser_top(p);
+  if (!top || top->expect != EXPECT_VALUE)
+    return false;
+  top->expect = EXPECT_COMMA;
+  if (top->object) {
+    top->last->value_type = elem->value_type;
+    top->last->value = elem->value;
+    top->last->len = elem->len;
+    if (top->with_head && len_spare(top->last)) {
+      top->last->len |= JSON_LEN_HEAD;
+      top->headed = top->last;
+    }
+    return true;
+  }
+  elem->key = NULL;
+  return array_push(&p->ctx, top->base, &top->nums, &top->kind, elem);
+}
+
+/**
+ * @brief 解析完整的字符串记号，文档中按 JSON_INTERN 与
+ * JSON_INTERN_STRINGS 驻留key与短字符串值
+ *
+ * @param s 从*s开始读取，确保**s为`"`，并修改*s为这个字符串末尾`"`后
+ * @return char* 失败返回NULL
+ */
+static char *parser_parse_str(json_parser *p, char **s) {
+  struct parser_frame *top = parser_top(p);
+  bool key = top && top->object && top->expect == EXPECT_KEY;
+  if (p->ctx.doc && (p->ctx.flags & (key ? JSON_INTERN : JSON_INTERN_STRINGS)))
+    return parse_str_intern(&p->ctx, s, key ? SIZE_MAX : JSON_INTERN_MAX);
+  return parse_str(&p->ctx, s);
+}
+
+/**
+ * @brief 处理完整的字符串记号，作为对象的key或值
+ *
+ * @param str 由parser_parse_str返回的字符串
+ * @return bool 语法错误返回false
+ */
+static bool parser_string(json_parser *p, char *str) {
+  struct parser_frame *top = parser_top(p);
+  if (!str)
+    return false;
+  if (top && top->object && top->expect == EXPECT_KEY) {
+    // 值尚未确定，在找到值不是数组的成员之前都留有头部
+    top->with_head = !top->headed;
+    json *node = json_create_member(&p->ctx, top->with_head, 0);
+    if (!node) {
+      ctx_free(&p->ctx, str);
+      return false;
+    }
+    node->next = NULL;
+    node->key = str;
+    node->value_type = json_Null;
+    node->len = 0;
+    if (top->first)
+      top->last = top->last->next = node;
+    else
+      top->first = top->last = node;
+    top->nums++;
+    top->expect = EXPECT_COLON;
+    return true;
+  }
+
+  json elem;
+  elem.value_type = json_String;
+  elem.value.String = str;
+  elem.len = 0;
+  if (!parser_value(p, &elem)) {
+    ctx_free(&p->ctx, str);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief 处理完整的数字或null, true, false记号
+ *
+ * @param str 记号的开始，记号之后的字符不属于记号
+ * @param len 记号的长度
+ * @return bool 语法错误返回false
+ */
+static bool parser_scalar(json_parser *p, char *str, size_t len) {
+  json elem;
+  elem.len = 0;
+  if (is_literal_char(*str)) {
+    if (len == 4 && !strncmp(str, "null", 4)) {
+      elem.value_type = json_Null;
+    } else if (len == 4 && !strncmp(str, "true", 4)) {
+      elem.value_type = json_Bool;
+      elem.value.Bool = true;
+    } else if (len == 5 && !strncmp(str, "false", 5)) {
+      elem.value_type = json_Bool;
+      elem.value.Bool = false;
+    } else {
+      return false;
+    }
+  } else {
+    char *end = str;
+    if (!parse_number(&end, &elem) || end != str + len)
+      return false;
+  }
+  return parser_value(p, &elem);
+}
+
+/**
+ * @brief 处理`{`或`[`
+ *
+ * @return bool 语法错误返回false
+ */
+static bool parser_open(json_parser *p, bool object) {
+  struct parser_frame *top = parser_top(p);
+  if (top ? top->expect != EXPECT_VALUE : !object)
+    return false;
+
+  if (p->depth == p->frames_cap) {
+    size_t cap = p->frames_cap ? p->frames_cap * 2 : 16;
+    struct parser_frame *frames =
+        realloc(p->frames, sizeof(struct parser_frame) * cap);
+    if (!frames)
+      return false;
+    p->frames = frames;
+    p->frames_cap = cap;
+  }
+  top = &p->frames[p->depth++];
+  top->object = object;
+  top->expect = object ? EXPECT_KEY : EXPECT_VALUE;
+  top->first = top->last = top->headed = NULL;
+  top->with_head = false;
+  top->nums = 0;
+  top->base = p->ctx.top;
+  top->kind = json_Null;
+  return true;
+}
+
+/**
+ * @brief 处理`}`或`]`，结束当前容器并放入上一层
+ *
+ * @return bool 语法错误返回false
+ */
+static bool parser_close(json_parser *p, bool object) {
+  struct parser_frame *top = parser_top(p);
+  if (!top || top->object != object ||
+      !(top->expect == EXPECT_COMMA ||
+        top->expect == (object ? EXPECT_KEY : EXPECT_VALUE)))
+    return false;
+
+  json elem;
+  if (object) {
+    elem.value_type = json_Json;
+    elem.value.Json = top->first;
+    elem.len = 0;
+    if (top->nums >= JSON_INDEX_MIN)
+      build_index(&p->ctx, top->first, top->nums, top->headed);
+  } else {
+    // 申请内存失败时栈中的元素已释放
+    if (!array_finish(&p->ctx, top->base, top->nums, top->kind, &elem)) {
+      p->depth--;
+      return false;
+    }
+  }
+  p->depth--;
+
+  // 根对象结束
+  if (!p->depth) {
+    p->root = json_create(&p->ctx);
+    if (!p->root) {
+      free_value(&elem);
+      return false;
+    }
+    *p->root = elem;
+    p->root->key = NULL;
+    p->root->next = NULL;
+    p->state = PARSER_DONE;
+    return true;
+  }
+  if (!parser_value(p, &elem)) {
+    free_value(&elem);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief 处理`,`和`:`
+ *
+ * 与json_parse一样忽略多余的`,`
+ *
+ * @return bool 语法错误返回false
+ */
+static bool parser_punct(json_parser *p, char ch) {
+  struct parser_frame *top = parser_top(p);
+  if (!top)
+    return false;
+  if (ch == ':') {
+    if (top->expect != EXPECT_COLON)
+      return false;
+    top->expect = EXPECT_VALUE;
+    return true;
+  }
+  if (top->object ? top->expect == EXPECT_KEY || top->expect == EXPECT_COMMA
+                  : top->expect == EXPECT_VALUE ||
+                        top->expect == EXPECT_COMMA) {
+    top->expect = top->object ? EXPECT_KEY : EXPECT_VALUE;
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief 处理一个完整的跨块记号
+ *
+ * @return bool 语法错误返回false
+ */
+static bool parser_tok_finish(json_parser *p) {
+  bool ok;
+  if (p->state == PARSER_STRING) {
+    char *str = p->tok;
+    ok = parser_string(p, parser_parse_str(p, &str));
+  } else {
+    ok = parser_scalar(p, p->tok, p->tok_len);
+  }
+  p->tok_len = 0;
+  p->state = PARSER_NORMAL;
+  return ok;
+}
+
+/**
+ * @brief 向增量解析器输入一块数据
+ *
+ * 数据块可以在任意位置分割，包括字符串、转义、数字和注释的中间，
+ * 只有跨越数据块的记号会被复制
+ *
+ * @param p 增量解析器
+ * @param buf 数据块，不需要以'\0'结尾
+ * @param len 数据块的长度
+ * @return bool 出现语法错误时返回false，之后的输入均被忽略
+ */
+bool json_parser_feed(json_parser *p, const char *buf, size_t len) {
+  const char *str = buf;
+  const char *end = buf + len;
+  while (str < end) {
+    switch (p->state) {
+    case PARSER_DONE:
+      return true;
+    case PARSER_ERROR:
+      return false;
+
+    case PARSER_STRING: {
+      const char *quote = parser_str_end(str, end, &p->escape);
+      const char *stop = quote ? quote + 1 : end;
+      if (!parser_tok_append(p, str, stop - str))
+        goto error;
+      str = stop;
+      if (quote && !parser_tok_finish(p))
+        goto error;
+      break;
+    }
+
+    case PARSER_NUMBER:
+    case PARSER_LITERAL: {
+      bool (*is_tok)(char) =
+          p->state == PARSER_NUMBER ? is_number_char : is_literal_char;
+      const char *stop = str;
+      while (stop < end && is_tok(*stop))
+        stop++;
+      if (!parser_tok_append(p, str, stop - str))
+        goto error;
+      str = stop;
+      if (stop < end && !parser_tok_finish(p))
+        goto error;
+      break;
+    }
+
+    case PARSER_SLASH:
+      if (*str == '/')
+        p->state = PARSER_LINE;
+      else if (*str == '*')
+        p->state = PARSER_BLOCK;
+      else
+        goto error;
+      p->star = false;
+      str++;
+      break;
+
+    case PARSER_LINE: {
+      const char *nl = memchr(str, '\n', end - str);
+      if (!nl)
+        return true;
+      str = nl + 1;
+      p->state = PARSER_NORMAL;
+      break;
+    }
+
+    case PARSER_BLOCK:
+      // 上一块以`*`结尾
+      if (p->star && *str == '/') {
+        str++;
+        p->state = PARSER_NORMAL;
+        break;
+      }
+      p->star = false;
+      while (str < end) {
+        const char *star = memchr(str, '*', end - str);
+        if (!star) {
+          str = end;
+          break;
+        }
+        if (star + 1 == end) {
+          p->star = true;
+          str = end;
+          break;
+        }
+        str = star + 1;
+        if (*str == '/') {
+          str++;
+          p->state = PARSER_NORMAL;
+          break;
+        }
+      }
+      break;
+
+    case PARSER_NORMAL: {
+      char ch = *str;
+      if (ch <= ' ' && ch) {
+        str++;
+      } else if (ch == '{' || ch == '[') {
+        if (!parser_open(p, ch == '{'))
+          goto error;
+        str++;
+      } else if (ch == '}' || ch == ']') {
+        if (!parser_close(p, ch == '}'))
+          goto error;
+        str++;
+      } else if (ch == ',' || ch == ':') {
+        if (!parser_punct(p, ch))
+          goto error;
+        str++;
+      } else if (ch == '/') {
+        p->state = PARSER_SLASH;
+        str++;
+      } else if (ch == '"') {
+        // 字符串在本块中结束时直接解析，否则复制已读取的部分
+        p->escape = false;
+        const char *quote = parser_str_end(str + 1, end, &p->escape);
+        if (quote) {
+          char *s = (char *)str;
+          if (!parser_string(p, parser_parse_str(p, &s)))
+            goto error;
+          str = quote + 1;
+        } else {
+          if (!parser_tok_append(p, str, end - str))
+            goto error;
+          p->state = PARSER_STRING;
+          str = end;
+        }
+      } else if (is_number_char(ch) || is_literal_char(ch)) {
+        bool (*is_tok)(char) =
+            is_literal_char(ch) ? is_literal_char : is_number_char;
+        const char *stop = str;
+        while (stop < end && is_tok(*stop))
+          stop++;
+        if (stop < end) {
+          if (!parser_scalar(p, (char *)str, stop - str))
+            goto error;
+        } else {
+          if (!parser_tok_append(p, str, stop - str))
+            goto error;
+          p->state = is_tok == is_number_char ? PARSER_NUMBER : PARSER_LITERAL;
+        }
+        str = stop;
+      } else {
+        goto error;
+      }
+      break;
+    }
+    }
+  }
+  return p->state != PARSER_ERROR;
+
+error:
+  p->state = PARSER_ERROR;
+  return false;
+}
+
+/**
+ * @brief 释放尚未结束的容器中已解析的部分
+ *
+ * @param p 增量解析器
+ */
+static void parser_discard(json_parser *p) {
+  while (p->depth) {
+    struct parser_frame *top = &p->frames[--p->depth];
+    if (top->object) {
+      free_chain(top->first);
+      continue;
+    }
+    // 临时栈中为节点或同类型的值
+    json elem;
+    for (size_t i = 0; i < top->nums; i++) {
+      if (top->kind == json_Mix) {
+        free_value((json *)(p->ctx.stack + top->base) + i);
+        continue;
+      }
+      elem.value_type = top->kind == json_Strings ? json_String
+                        : top->kind == json_Jsons ? json_Json
+                                                  : json_Null;
+      elem.value = ((union json_value *)(p->ctx.stack + top->base))[i];
+      free_value(&elem);
+    }
+  }
+}
+
+/**
+ * @brief 结束输入，释放增量解析器内部的缓冲区
+ *
+ * @param p 增量解析器
+ * @return json* 解析结果，输入不完整或有语法错误时返回NULL
+ */
+static json *parser_end(json_parser *p) {
+  json *root = p->root;
+  if (p->state != PARSER_DONE) {
+    // arena中的内存随文档一起释放
+    if (!p->ctx.doc) {
+      parser_discard(p);
+      json_free(root);
+    }
+    root = NULL;
+  }
+  free(p->ctx.stack);
+  free(p->tok);
+  free(p->frames);
+  return root;
+}
+
+/**
+ * @brief 结束输入，返回解析结果并释放增量解析器
+ *
+ * @param p 增量解析器
+ * @return json* 与json_parse相同的树，由json_free释放，
+ * 输入不完整或有语法错误时返回NULL
+ */
+json *json_parser_finish(json_parser *p) {
+  if (!p)
+    return NULL;
+  json *root = parser_end(p);
+  free(p);
+  return root;
+}
+
+/**
+ * @brief 在长度范围内解析，不读取buf[len]及之后的内存
+ *
+ * 由增量解析器一次输入整个缓冲区完成，记号均在缓冲区内结束，无需复制。
+ * 向量化的扫描kernel按对齐的块读取，可能读到同一对齐块中len之后的字节，
+ * 但不会跨越页边界
+ *
+ * @param doc 文档，为NULL时由malloc申请
+ * @param flags 文档中只使用 JSON_INTERN 与 JSON_INTERN_STRINGS
+ * @return json* 返回解析后的根节点，若失败返回NULL
+ */
+static json *parse_bounded(json_doc *doc, const char *buf, size_t len,
+                           int flags) {
+  json_parser p = {0};
+  p.ctx.doc = doc;
+  if (doc)
+    p.ctx.flags = doc->flags = flags & (JSON_INTERN | JSON_INTERN_STRINGS);
+  p.state = PARSER_NORMAL;
+  json_parser_feed(&p, buf, len);
+  return parser_end(&p);
+}
+
+/**
+ * @brief 是否可以使用以'\0'为哨兵的解析
+ */
+static bool parse_padded(const char *buf, size_t len, int flags) {
+  return (flags & JSON_PADDED) && buf[len] == '\0';
+}
+
+/**
+ * @brief 从长度为len的缓冲区中解析json，缓冲区不需要以'\0'结尾
+ *
+ * @param buf 输入缓冲区，不会被修改
+ * @param len 输入长度
+ * @param flags 只支持 JSON_PADDED
+ * @return json* 返回解析后的根节点，由json_free释放
+ * 若失败返回NULL
+ */
+json *json_parse_n(const char *buf, size_t len, int flags) {
+  if (parse_padded(buf, len, flags))
+    return json_parse((char *)buf);
+  return parse_bounded(NULL, buf, len, 0);
+}
+
+/**
+ * @brief 从长度为len的缓冲区中解析json文档，缓冲区不需要以'\0'结尾
+ *
+ * JSON_LAZY 与 JSON_PARALLEL 只在以'\0'为哨兵解析时有效
+ *
+ * @param buf 输入缓冲区，不会被修改，因此忽略 JSON_INSITU
+ * @param len 输入长度
+ * @param flags enum json_parse_flag 的组合
+ * @return json_doc* 返回解析后的文档，若失败返回NULL
+ */
+json_doc *json_doc_parse_n(const char *buf, size_t len, int flags) {
+  json_doc *doc = doc_new(doc_reserve(len, flags & ~JSON_INSITU));
+  if (!doc)
+    return NULL;
+
+  if (parse_padded(buf, len, flags)) {
+    doc_parse(doc, (char *)buf, len, flags & ~JSON_INSITU);
+  } else if (!(flags & JSON_STRICT) || strict_check(buf, buf + len, false)) {
+    doc->root = parse_bounded(doc, buf, len, flags);
+  }
+  if (!doc->root) {
+    json_doc_free(doc);
+    return NULL;
+  }
+  return doc;
+}
+
+/**
+ * @brief 线程池中的一个工作线程
+ */
+struct pool_worker {
+  struct json_pool *pool;
+  int index;
+#ifdef JSON_POSIX
+  pthread_t thread;
+#endif
+};
+
+/**
+ * @brief 线程池
+ *
+ * 每次pool_run时所有工作线程与调用者一起执行同一个task，
+ * task内部自行划分工作，调用者的编号为nums
+ */
+struct json_pool {
+  struct pool_worker *workers;
+  int nums; // 工作线程数，不含调用者
+#ifdef JSON_POSIX
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  pthread_cond_t done;
+#endif
+  void (*task)(void *arg, int worker);
+  void *arg;
+  unsigned long gen; // 每次pool_run加1
+  int busy;          // 尚未完成本次task的工作线程数
+  bool quit;
+};
+
+#ifdef JSON_POSIX
+static void *pool_main(void *arg) {
+  struct pool_worker *w = arg;
+  struct json_pool *pool = w->pool;
+  unsigned long gen = 0;
+  pthread_mutex_lock(&pool->lock);
+  for (;;) {
+    while (pool->gen == gen && !pool->quit)
+      pthread_cond_wait(&pool->start, &pool->lock);
+    if (pool->quit)
+      break;
+    gen = pool->gen;
+    pthread_mutex_unlock(&pool->lock);
+    pool->task(pool->arg, w->index);
+    pthread_mutex_lock(&pool->lock);
+    if (!--pool->busy)
+      pthread_cond_signal(&pool->done);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+#endif
+
+/**
+ * @brief 启动线程池
+ *
+ * 线程创建失败时以已创建的线程继续，不支持线程时只由调用者执行
+ *
+ * @param threads 总线程数，包含调用者，不大于0时为CPU核数
+ */
+static void pool_start(struct json_pool *pool, int threads) {
+  memset(pool, 0, sizeof(*pool));
+#ifdef JSON_POSIX
+  if (threads <= 0)
+    threads = sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads <= 1)
+    return;
+  pool->workers = malloc(sizeof(struct pool_worker) * (threads - 1));
+  if (!pool->workers)
+    return;
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->done, NULL);
+  for (int i = 0; i < threads - 1; i++) {
+    struct pool_worker *w = &pool->workers[pool->nums];
+    w->pool = pool;
+    w->index = pool->nums;
+    if (pthread_create(&w->thread, NULL, pool_main, w))
+      break;
+    pool->nums++;
+  }
+#else
+  (void)threads;
+#endif
+}
+
+/**
+ * @brief 由所有线程执行task，返回时均已完成
+ *
+ * @param task task(arg, worker)，worker 为 0 到 nums 的线程编号
+ */
+static void pool_run(struct json_pool *pool, void (*task)(void *, int),
+                     void *arg) {
+#ifdef JSON_POSIX
+  if (pool->nums) {
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->arg = arg;
+    pool->gen++;
+    pool->busy = pool->nums;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+  }
+#endif
+  task(arg, pool->nums);
+#ifdef JSON_POSIX
+  if (pool->nums) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy)
+      pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+  }
+#endif
+}
+
+/**
+ * @brief 结束所有工作线程并释放线程池
+ */
+static void pool_stop(struct json_pool *pool) {
+#ifdef JSON_POSIX
+  if (!pool->workers)
+    return;
+  pthread_mutex_lock(&pool->lock);
+  pool->quit = true;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+  for (int i = 0; i < pool->nums; i++)
+    pthread_join(pool->workers[i].thread, NULL);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->start);
+  pthread_cond_destroy(&pool->done);
+  free(pool->workers);
+#endif
+}
+
+/**
+ * @brief 释放解析上下文的临时栈与线程池
+ */
+static void ctx_release(struct parse_ctx *ctx) {
+  free(ctx->stack);
+  if (ctx->pool) {
+    pool_stop(ctx->pool);
+    free(ctx->pool);
+  }
+}
+
+/**
+ * @brief 并行解析的数组中的一段元素
+ *
+ * 由一个线程按顺序解析，elems 为解析结果，stop 为解析结束的位置，
+ * failed 为在stop处解析失败
+ */
+struct array_chunk {
+  char *str;
+  json *elems;
+  size_t nums;
+  size_t cap;
+  char *stop;
+  bool failed;
+};
+
+/**
+ * @brief 并行解析数组的一次工作
+ *
+ * 每个线程使用独立的上下文和arena，按顺序领取各段
+ */
+struct array_job {
+  struct array_chunk *chunks;
+  size_t nums;
+  size_t next; // 下一个未领取的段
+  char *end;   // 数组结尾的`]`
+  struct parse_ctx *ctxs;
+};
+
+static void array_chunk_parse(struct parse_ctx *ctx, struct array_chunk *c,
+                              char *limit) {
+  char *str = c->str;
+  while (str < limit) {
+    if (*str == ',') {
+      str = skip(str + 1);
+      continue;
+    }
+    if (c->nums == c->cap) {
+      size_t cap = c->cap ? c->cap * 2 : 64;
+      json *elems = realloc(c->elems, cap * sizeof(json));
+      if (!elems)
+        break;
+      c->elems = elems;
+      c->cap = cap;
+    }
+    json *elem = &c->elems[c->nums];
+    elem->key = NULL;
+    if (!parse_value(ctx, &str, elem))
+      break;
+    c->nums++;
+    str = skip(str);
+  }
+  c->stop = str;
+  c->failed = str < limit;
+}
+
+static void array_task(void *arg, int worker) {
+  struct array_job *job = arg;
+  struct parse_ctx *ctx = &job->ctxs[worker];
+  for (;;) {
+    size_t i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+    if (i >= job->nums)
+      return;
+    struct array_chunk *c = &job->chunks[i];
+    char *limit = i + 1 < job->nums ? job->chunks[i + 1].str - 1 : job->end;
+    // 首块按第一个领取的段估计，之后的段由arena按两倍增长
+    if (!ctx->doc &&
+        !(ctx->doc = doc_new(doc_reserve(limit - c->str, ctx->flags)))) {
+      c->stop = c->str;
+      c->failed = true;
+      ctx->nomem = true;
+      continue;
+    }
+    array_chunk_parse(ctx, c, limit);
+  }
+}
+
+/**
+ * @brief 划分数组
+ *
+ * 按64字节一块计算引号和括号的位掩码，去掉字符串中的字符后按顺序
+ * 维护嵌套层数，找到数组结尾的`]`；经过每个划分点之后，
+ * 在第一个属于本数组的`,`之后开始新的一段
+ *
+ * @param str 数组开头的`[`
+ * @param end 输入的结尾
+ * @param step 每段的字节数
+ * @param chunks 修改为由malloc申请的各段
+ * @param nums 修改为段数
+ * @return char* 数组结尾的`]`，含有注释或数组未结束时返回NULL
+ */
+static char *array_split(char *str, char *end, size_t step,
+                         struct array_chunk **chunks, size_t *nums) {
+  size_t len = end - str;
+  size_t cap = 16;
+  struct array_chunk *c = malloc(cap * sizeof(*c));
+  if (!c)
+    return NULL;
+  size_t n = 0;
+  c[n++].str = skip(str + 1);
+  size_t target = step;
+  long depth = 0;
+  uint64_t carry = 0;
+  uint64_t in_str = 0;
+  for (size_t i = 0; i < len; i += 64) {
+    struct block_masks m;
+    if (len - i >= 64) {
+      scan.block(str + i, &m);
+    } else {
+      char tail[64] = {0};
+      memcpy(tail, str + i, len - i);
+      scan.block(tail, &m);
+    }
+    uint64_t quote = m.quote & ~escaped_mask(m.backslash, &carry);
+    uint64_t in = prefix_xor(quote) ^ in_str;
+    in_str = (uint64_t)((int64_t)in >> 63);
+    if (m.slash & ~in)
+      break;
+
+    // 本块没有越过划分点时只需处理括号
+    uint64_t bits = (m.open | m.close | (i + 64 > target ? m.comma : 0)) & ~in;
+    while (bits) {
+      int b = ctz64(bits);
+      uint64_t bit = (uint64_t)1 << b;
+      bits &= bits - 1;
+      if (m.open & bit) {
+        depth++;
+      } else if (m.close & bit) {
+        if (--depth == 0) {
+          *chunks = c;
+          *nums = n;
+          return str + i + b;
+        }
+      } else if (depth == 1 && i + b >= target) {
+        if (n == cap) {
+          cap *= 2;
+          struct array_chunk *p = realloc(c, cap * sizeof(*c));
+          if (!p)
+            goto fail;
+          c = p;
+        }
+        c[n++].str = skip(str + i + b + 1);
+        target = i + b + step;
+      }
+    }
+  }
+fail:
+  free(c);
+  return NULL;
+}
+
+/**
+ * @brief 由线程池并行解析数组
+ *
+ * 先用向量化的扫描把数组划分为若干段，各段由线程按顺序领取并解析，
+ * 各线程的arena在完成后并入文档，元素按原顺序压入临时栈生成数组。
+ * 元素中嵌套的数组不再并行
+ *
+ * @param s 确保**s为`[`，成功时修改*s指向数组结束的下一个字符
+ * @param item 将修改value, value_type, len
+ * @return bool 无法划分或单核时返回false，由调用者逐个解析
+ */
+static bool parse_array_parallel(struct parse_ctx *ctx, char **s, json *item) {
+  char *str = *s;
+  struct array_job job = {NULL};
+  if (!ctx->pool) {
+    if (!(ctx->pool = malloc(sizeof(struct json_pool))))
+      return false;
+    pool_start(ctx->pool, (ctx->flags >> 8) & 0xFF);
+  }
+  int threads = ctx->pool->nums + 1;
+  if (threads == 1 ||
+      !(job.end = array_split(str, ctx->end, JSON_PARALLEL_MIN / 16,
+                              &job.chunks, &job.nums))) {
+    ctx->flags &= ~JSON_PARALLEL;
+    return false;
+  }
+
+  if (job.end - str < JSON_PARALLEL_MIN) {
+    // 较小的数组中嵌套的数组更小，整体按顺序解析
+    free(job.chunks);
+    ctx->flags &= ~JSON_PARALLEL;
+    parse_array(ctx, s, item);
+    ctx->flags |= JSON_PARALLEL;
+    return true;
+  }
+
+  job.ctxs = calloc(threads, sizeof(struct parse_ctx));
+  if (!job.ctxs) {
+    free(job.chunks);
+    return false;
+  }
+  int flags = ctx->flags & ~(JSON_PARALLEL | JSON_LAZY);
+  for (int i = 0; i < threads; i++)
+    job.ctxs[i].flags = flags;
+  for (size_t i = 0; i < job.nums; i++) {
+    job.chunks[i].elems = NULL;
+    job.chunks[i].nums = job.chunks[i].cap = 0;
+  }
+  pool_run(ctx->pool, array_task, &job);
+
+  // 各线程的内存块接在当前块之后，随文档一起释放；
+  // 驻留的字符串并入文档的驻留表，其他线程的重复副本保持原样
+  json_doc *doc = ctx->doc;
+  for (int i = 0; i < threads; i++) {
+    free(job.ctxs[i].stack);
+    if (job.ctxs[i].nomem)
+      ctx->nomem = true;
+    if (!job.ctxs[i].doc)
+      continue;
+    struct json_intern *t = job.ctxs[i].doc->intern;
+    for (size_t j = 0; t && j <= t->mask; j++) {
+      char *str = t->strs[j];
+      if (str && !intern_find(doc->intern, str, intern_head(str)->len,
+                              intern_head(str)->hash))
+        intern_insert(doc, str);
+    }
+    intern_free(t);
+    struct json_block *last = job.ctxs[i].doc->block;
+    while (last->next)
+      last = last->next;
+    last->next = doc->block->next;
+    doc->block->next = job.ctxs[i].doc->block;
+  }
+
+  // 按顺序生成数组，在第一个解析失败的位置停止
+  size_t base = ctx->top;
+  size_t nums = 0;
+  enum json_value_type kind = json_Null;
+  char *stop = job.end + 1;
+  bool ok = true;
+  for (size_t i = 0; i < job.nums; i++) {
+    struct array_chunk *c = &job.chunks[i];
+    for (size_t j = 0; ok && j < c->nums; j++)
+      ok = array_push(ctx, base, &nums, &kind, &c->elems[j]);
+    free(c->elems);
+    if (ok && c->failed) {
+      stop = c->stop;
+      ok = false;
+    }
+  }
+  array_finish(ctx, base, nums, kind, item);
+  *s = stop;
+  free(job.ctxs);
+  free(job.chunks);
+  return true;
+}
+
+/**
+ * @brief 查找记录的结尾
+ *
+ * 每个'\n'都结束记录，json的字符串中不能含有未转义的换行，
+ * 截断的记录不会影响之后的记录
+ *
+ * @param str 记录的开始
+ * @param end 缓冲区的结尾
+ * @return const char* 结尾'\n'的指针，没有时返回end
+ */
+static const char *line_end(const char *str, const char *end) {
+  const char *nl = memchr(str, '\n', end - str);
+  return nl ? nl : end;
+}
+
+/**
+ * @brief json_parse_lines 中的一条记录
+ */
+struct line_rec {
+  const char *str;
+  size_t len;
+  json_doc *doc;
+};
+
+/**
+ * @brief 线程私有的复制缓冲区，记录复制到其中后以'\0'为哨兵解析
+ */
+struct line_buf {
+  char *buf;
+  size_t cap;
+};
+
+/**
+ * @brief json_parse_lines 一轮的工作
+ */
+struct lines_job {
+  struct line_rec *recs;
+  size_t nums;
+  size_t next; // 下一条未领取的记录
+  struct line_buf *bufs;
+};
+
+static void lines_task(void *arg, int worker) {
+  struct lines_job *job = arg;
+  struct line_buf *scratch = &job->bufs[worker];
+  for (;;) {
+    size_t i = __atomic_fetch_add(&job->next, JSON_LINES_BATCH,
+                                  __ATOMIC_RELAXED);
+    if (i >= job->nums)
+      return;
+    size_t stop = i + JSON_LINES_BATCH < job->nums ? i + JSON_LINES_BATCH
+                                                   : job->nums;
+    for (; i < stop; i++) {
+      struct line_rec *rec = &job->recs[i];
+      if (rec->len + 1 > scratch->cap) {
+        size_t cap = (rec->len + 1) * 2;
+        char *buf = realloc(scratch->buf, cap);
+        if (!buf) {
+          // 无法复制时按长度解析
+          rec->doc = json_doc_parse_n(rec->str, rec->len, 0);
+          continue;
+        }
+        scratch->buf = buf;
+        scratch->cap = cap;
+      }
+      memcpy(scratch->buf, rec->str, rec->len);
+      scratch->buf[rec->len] = '\0';
+      rec->doc = json_doc_parse_n(scratch->buf, rec->len, JSON_PADDED);
+    }
+  }
+}
+
+/**
+ * @brief 并行解析以换行分隔的多条json记录（NDJSON / JSON Lines）
+ *
+ * 每轮切分一批记录，由线程池并行解析，每条记录为独立的文档，
+ * 使用各自的arena；解析完成后按输入顺序交给fn
+ *
+ * @param buf 输入缓冲区，不需要以'\0'结尾
+ * @param len 输入长度
+ * @param threads 线程数，不大于0时为CPU核数
+ * @param fn 按输入顺序对每条记录调用，fn(arg, index, doc)，
+ * doc 由fn负责以json_doc_free释放，解析失败时为NULL
+ * @param arg 传给fn
+ * @return size_t 记录数，只含空白的行不计入
+ */
+size_t json_parse_lines(const char *buf, size_t len, int threads,
+                        void (*fn)(void *arg, size_t index, json_doc *doc),
+                        void *arg) {
+  struct json_pool pool;
+  pool_start(&pool, threads);
+  size_t window = JSON_LINES_WINDOW * (pool.nums + 1);
+  struct lines_job job;
+  job.recs = malloc(sizeof(struct line_rec) * window);
+  job.bufs = calloc(pool.nums + 1, sizeof(struct line_buf));
+  size_t count = 0;
+  if (!job.recs || !job.bufs)
+    goto out;
+
+  const char *str = buf;
+  const char *end = buf + len;
+  while (str < end) {
+    // 切分一轮的记录，跳过只含空白的行
+    job.nums = 0;
+    job.next = 0;
+    while (job.nums < window && str < end) {
+      const char *stop = line_end(str, end);
+      while (str < stop && (unsigned char)*str <= ' ')
+        str++;
+      if (str < stop) {
+        struct line_rec *rec = &job.recs[job.nums++];
+        rec->str = str;
+        rec->len = stop - str;
+        rec->doc = NULL;
+      }
+      str = stop + 1;
+    }
+
+    pool_run(&pool, lines_task, &job);
+    for (size_t i = 0; i < job.nums; i++)
+      fn(arg, count++, job.recs[i].doc);
+  }
+
+out:
+  if (job.bufs)
+    for (int i = 0; i <= pool.nums; i++)
+      free(job.bufs[i].buf);
+  free(job.bufs);
+  free(job.recs);
+  pool_stop(&pool);
+  return count;
+}
+
+/**
+ * @brief 两位十进制数字的查找表，"00"到"99"
+ */
+static const char digits2[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// 10的幂，下标0为0使u64_len对0返回1
+static const uint64_t pow10_u64[20] = {
+    0, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+    100000000ull, 1000000000ull, 10000000000ull, 100000000000ull,
+    1000000000000ull, 10000000000000ull, 100000000000000ull,
+    1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+    1000000000000000000ull, 10000000000000000000ull};
+
+/**
+ * @brief 无符号整数的十进制位数
+ *
+ * 由二进制位数乘log10(2)估算，再与10的幂比较一次修正，没有循环
+ */
+static int u64_len(uint64_t v) {
+  int bits = 64 - __builtin_clzll(v | 1);
+  int n = (bits * 1233) >> 12;
+  return n + (v >= pow10_u64[n]);
+}
+
+/**
+ * @brief 写入无符号整数，每次写入两位
+ *
+ * @return char* 写入的最后一个字符的下一字符
+ */
+static char *write_u64(char *out, uint64_t v) {
+  char *end = out + u64_len(v);
+  char *p = end;
+  while (v >= 100) {
+    p -= 2;
+    memcpy(p, digits2 + v % 100 * 2, 2);
+    v /= 100;
+  }
+  if (v >= 10) {
+    p -= 2;
+    memcpy(p, digits2 + v * 2, 2);
+  } else {
+    *--p = '0' + v;
+  }
+  return end;
+}
+
+/**
+ * @brief 写入整数
+ *
+ * @return char* 写入的最后一个字符的下一字符
+ */
+static char *write_long(char *out, long v) {
+  if (v < 0) {
+    *out++ = '-';
+    return write_u64(out, 0 - (uint64_t)v);
+  }
+  return write_u64(out, v);
+}
+
+/**
+ * @brief 整数的十进制长度
+ */
+static size_t long_len(long v) {
+  return v < 0 ? 1 + u64_len(0 - (uint64_t)v) : u64_len(v);
+}
+
+/**
+ * @brief 浮点数 f * 2^e，f 为64位整数
+ */
+struct diy_fp {
+  uint64_t f;
+  int e;
+};
+
+/**
+ * @brief 两个diy_fp相乘，结果取高64位并舍入
+ */
+static struct diy_fp diy_mul(struct diy_fp a, struct diy_fp b) {
+  uint64_t hi;
+  uint64_t lo = mul128(a.f, b.f, &hi);
+  hi += lo >> 63;
+  return (struct diy_fp){hi, a.e + b.e + 64};
+}
+
+/**
+ * @brief 规格化，使f的最高位为1
+ */
+static struct diy_fp diy_norm(struct diy_fp v) {
+  int shift = __builtin_clzll(v.f);
+  return (struct diy_fp){v.f << shift, v.e - shift};
+}
+
+/**
+ * @brief 10^(8i - 348) 的规格化近似值，用于Grisu2
+ */
+static const uint64_t grisu_pow_f[87] = {
+    0xfa8fd5a0081c0288, 0xbaaee17fa23ebf76, 0x8b16fb203055ac76,
+    0xcf42894a5dce35ea, 0x9a6bb0aa55653b2d, 0xe61acf033d1a45df,
+    0xab70fe17c79ac6ca, 0xff77b1fcbebcdc4f, 0xbe5691ef416bd60c,
+    0x8dd01fad907ffc3c, 0xd3515c2831559a83, 0x9d71ac8fada6c9b5,
+    0xea9c227723ee8bcb, 0xaecc49914078536d, 0x823c12795db6ce57,
+    0xc21094364dfb5637, 0x9096ea6f3848984f, 0xd77485cb25823ac7,
+    0xa086cfcd97bf97f4, 0xef340a98172aace5, 0xb23867fb2a35b28e,
+    0x84c8d4dfd2c63f3b, 0xc5dd44271ad3cdba, 0x936b9fcebb25c996,
+    0xdbac6c247d62a584, 0xa3ab66580d5fdaf6, 0xf3e2f893dec3f126,
+    0xb5b5ada8aaff80b8, 0x87625f056c7c4a8b, 0xc9bcff6034c13053,
+    0x964e858c91ba2655, 0xdff9772470297ebd, 0xa6dfbd9fb8e5b88f,
+    0xf8a95fcf88747d94, 0xb94470938fa89bcf, 0x8a08f0f8bf0f156b,
+    0xcdb02555653131b6, 0x993fe2c6d07b7fac, 0xe45c10c42a2b3b06,
+    0xaa242499697392d3, 0xfd87b5f28300ca0e, 0xbce5086492111aeb,
+    0x8cbccc096f5088cc, 0xd1b71758e219652c, 0x9c40000000000000,
+    0xe8d4a51000000000, 0xad78ebc5ac620000, 0x813f3978f8940984,
+    0xc097ce7bc90715b3, 0x8f7e32ce7bea5c70, 0xd5d238a4abe98068,
+    0x9f4f2726179a2245, 0xed63a231d4c4fb27, 0xb0de65388cc8ada8,
+    0x83c7088e1aab65db, 0xc45d1df942711d9a, 0x924d692ca61be758,
+    0xda01ee641a708dea, 0xa26da3999aef774a, 0xf209787bb47d6b85,
+    0xb454e4a179dd1877, 0x865b86925b9bc5c2, 0xc83553c5c8965d3d,
+    0x952ab45cfa97a0b3, 0xde469fbd99a05fe3, 0xa59bc234db398c25,
+    0xf6c69a72a3989f5c, 0xb7dcbf5354e9bece, 0x88fcf317f22241e2,
+    0xcc20ce9bd35c78a5, 0x98165af37b2153df, 0xe2a0b5dc971f303a,
+    0xa8d9d1535ce3b396, 0xfb9b7cd9a4a7443c, 0xbb764c4ca7a44410,
+    0x8bab8eefb6409c1a, 0xd01fef10a657842c, 0x9b10a4e5e9913129,
+    0xe7109bfba19c0c9d, 0xac2820d9623bf429, 0x80444b5e7aa7cf85,
+    0xbf21e44003acdd2d, 0x8e679c2f5e44ff8f, 0xd433179d9c8cb841,
+    0x9e19db92b4e31ba9, 0xeb96bf6ebadf77d9, 0xaf87023b9bf0ee6b,
+};
+static const int16_t grisu_pow_e[87] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954,
+    -927, -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635,
+    -608, -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316,
+    -289, -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30, 56,
+    83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348, 375, 402, 428, 455,
+    481, 508, 534, 561, 588, 614, 641, 667, 694, 720, 747, 774, 800, 827, 853,
+    880, 907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+/**
+ * @brief 取一个10的幂c，使 v * c 的二进制指数落在 [-60, -32] 附近
+ *
+ * @param e 乘数的二进制指数
+ * @param k 修改为c的十进制指数的相反数
+ */
+static struct diy_fp grisu_pow(int e, int *k) {
+  double dk = (-61 - e) * 0.30102999566398114 + 347;
+  int ik = (int)dk;
+  if (dk - ik > 0.0)
+    ik++;
+  unsigned index = (ik >> 3) + 1;
+  *k = -(-348 + (int)(index << 3));
+  return (struct diy_fp){grisu_pow_f[index], grisu_pow_e[index]};
+}
+
+/**
+ * @brief 在误差范围内把最后一位向精确值调整
+ */
+static void grisu_round(char *buf, int len, uint64_t delta, uint64_t rest,
+                        uint64_t ten_kappa, uint64_t wp_w) {
+  while (rest < wp_w && delta - rest >= ten_kappa &&
+         (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+    buf[len - 1]--;
+    rest += ten_kappa;
+  }
+}
+
+/**
+ * @brief 生成在 [mp - delta, mp] 范围内的最短数字串
+ */
+static void grisu_digits(struct diy_fp w, struct diy_fp mp, uint64_t delta,
+                         char *buf, int *len, int *k) {
+  static const uint32_t pow10_u32[] = {1,      10,      100,      1000,
+                                       10000,  100000,  1000000,  10000000,
+                                       100000000, 1000000000};
+  struct diy_fp one = {(uint64_t)1 << -mp.e, mp.e};
+  uint64_t wp_w = mp.f - w.f;
+  uint32_t p1 = (uint32_t)(mp.f >> -one.e);
+  uint64_t p2 = mp.f & (one.f - 1);
+  int kappa = u64_len(p1);
+  *len = 0;
+
+  // 整数部分，除数为常量时编译器可以转为乘法
+  while (kappa > 0) {
+    uint32_t d;
+    switch (kappa) {
+#define GRISU_DIGIT(n, p)                                                      \
+  case n:                                                                      \
+    d = p1 / p;                                                                \
+    p1 %= p;                                                                   \
+    break;
+      GRISU_DIGIT(10, 1000000000)
+      GRISU_DIGIT(9, 100000000)
+      GRISU_DIGIT(8, 10000000)
+      GRISU_DIGIT(7, 1000000)
+      GRISU_DIGIT(6, 100000)
+      GRISU_DIGIT(5, 10000)
+      GRISU_DIGIT(4, 1000)
+      GRISU_DIGIT(3, 100)
+      GRISU_DIGIT(2, 10)
+#undef GRISU_DIGIT
+    default:
+      d = p1;
+      p1 = 0;
+    }
+    if (d || *len)
+      buf[(*len)++] = '0' + d;
+    kappa--;
+    uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+    if (rest <= delta) {
+      *k += kappa;
+      grisu_round(buf, *len, delta, rest, (uint64_t)pow10_u32[kappa] << -one.e,
+                  wp_w);
+      return;
+    }
+  }
+
+  // 小数部分
+  for (;;) {
+    p2 *= 10;
+    delta *= 10;
+    char d = (char)(p2 >> -one.e);
+    if (d || *len)
+      buf[(*len)++] = '0' + d;
+    p2 &= one.f - 1;
+    kappa--;
+    if (p2 < delta) {
+      *k += kappa;
+      grisu_round(buf, *len, delta, p2, one.f,
+                  wp_w * (-kappa < 10 ? pow10_u32[-kappa] : 0));
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Grisu2，生成正数v的十进制数字，v = buf * 10^k
+ *
+ * 结果总能精确转换回v，绝大多数情况下为最短表示
+ *
+ * @param buf 写入数字，最多17位
+ * @param len 修改为数字位数
+ * @param k 修改为十进制指数
+ */
+static void grisu2(double v, char *buf, int *len, int *k) {
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  struct diy_fp w = {bits & 0xFFFFFFFFFFFFFull, (int)(bits >> 52 & 0x7FF)};
+  if (w.e) {
+    w.f |= 1ull << 52;
+    w.e -= 1075;
+  } else {
+    w.e = -1074;
+  }
+
+  // 与相邻浮点数的中点为边界
+  struct diy_fp plus = diy_norm((struct diy_fp){(w.f << 1) + 1, w.e - 1});
+  struct diy_fp minus = w.f == 1ull << 52
+                            ? (struct diy_fp){(w.f << 2) - 1, w.e - 2}
+                            : (struct diy_fp){(w.f << 1) - 1, w.e - 1};
+  minus.f <<= minus.e - plus.e;
+  minus.e = plus.e;
+
+  struct diy_fp c = grisu_pow(plus.e, k);
+  struct diy_fp wc = diy_mul(diy_norm(w), c);
+  struct diy_fp wp = diy_mul(plus, c);
+  struct diy_fp wm = diy_mul(minus, c);
+  wm.f++;
+  wp.f--;
+  grisu_digits(wc, wp, wp.f - wm.f, buf, len, k);
+}
+
+/**
+ * @brief 写入十进制指数
+ */
+static char *write_exp(char *out, int e) {
+  if (e < 0) {
+    *out++ = '-';
+    e = -e;
+  }
+  return write_u64(out, e);
+}
+
+// write_double 最多写入的字节数
+#define JSON_DOUBLE_MAX 32
+
+/**
+ * @brief 写入浮点数的最短表示
+ *
+ * 结果总带有`.`或`e`，重新解析后仍为浮点数；
+ * JSON 不能表示的 NaN 和无穷写为null
+ *
+ * @param out 至少有 JSON_DOUBLE_MAX 字节
+ * @return char* 写入的最后一个字符的下一字符
+ */
+static char *write_double(char *out, double v) {
+  if (v != v || v - v != 0) {
+    memcpy(out, "null", 4);
+    return out + 4;
+  }
+  if (signbit(v)) {
+    *out++ = '-';
+    v = -v;
+  }
+  if (v == 0) {
+    memcpy(out, "0.0", 3);
+    return out + 3;
+  }
+
+  char *buf = out;
+  int len, k;
+  grisu2(v, buf, &len, &k);
+  int kk = len + k; // 10^(kk-1) <= v < 10^kk
+  if (k >= 0 && kk <= 21) {
+    // 1234e7 -> 12340000000.0
+    memset(buf + len, '0', kk - len);
+    memcpy(buf + kk, ".0", 2);
+    return buf + kk + 2;
+  }
+  if (kk > 0 && kk <= 21) {
+    // 1234e-2 -> 12.34
+    memmove(buf + kk + 1, buf + kk, len - kk);
+    buf[kk] = '.';
+    return buf + len + 1;
+  }
+  if (kk > -6 && kk <= 0) {
+    // 1234e-6 -> 0.001234
+    int offset = 2 - kk;
+    memmove(buf + offset, buf, len);
+    buf[0] = '0';
+    buf[1] = '.';
+    memset(buf + 2, '0', offset - 2);
+    return buf + len + offset;
+  }
+  if (len == 1) {
+    // 1e30
+    buf[1] = 'e';
+    return write_exp(buf + 2, kk - 1);
+  }
+  // 1234e30 -> 1.234e33
+  memmove(buf + 2, buf + 1, len - 1);
+  buf[1] = '.';
+  buf[len + 1] = 'e';
+  return write_exp(buf + len + 2, kk - 1);
+}
+
+// 控制字符的短转义，为0时使用\u00XX
+static const char escape_ctrl[32] = {
+    0, 0, 0,   0, 0,   0,   0, 0, 'b', 't', 'n', 0, 'f', 'r', 0, 0,
+    0, 0, 0,   0, 0,   0,   0, 0, 0,   0,   0,   0, 0,   0,   0, 0};
+
+/**
+ * @brief 字符串转义后的长度，包括两端的`"`
+ *
+ * 不需要转义的片段由扫描kernel整块跳过
+ */
+static size_t str_len_escaped(const char *str) {
+  size_t len = 2;
+  for (;;) {
+    const char *stop = scan.escape((char *)str);
+    len += stop - str;
+    unsigned char ch = *stop;
+    if (!ch)
+      return len;
+    len += ch == '"' || ch == '\\' || escape_ctrl[ch] ? 2 : 6;
+    str = stop + 1;
+  }
+}
+
+/**
+ * @brief 写入一个字符的转义，最多6字节
+ *
+ * @param ch scan.escape 停止处的字符，不为'\0'
+ * @return char* 写入的最后一个字符的下一字符
+ */
+static char *write_escape(char *out, unsigned char ch) {
+  *out++ = '\\';
+  if (ch == '"' || ch == '\\') {
+    *out++ = ch;
+  } else if (escape_ctrl[ch]) {
+    *out++ = escape_ctrl[ch];
+  } else {
+    memcpy(out, "u00", 3);
+    out[3] = "0123456789abcdef"[ch >> 4];
+    out[4] = "0123456789abcdef"[ch & 0xF];
+    out += 5;
+  }
+  return out;
+}
+
+/**
+ * @brief 写入转义后的字符串，包括两端的`"`
+ *
+ * 不需要转义的片段整块复制，非ASCII的UTF-8字节原样输出
+ *
+ * @return char* 写入的最后一个字符的下一字符
+ */
+static char *write_str(char *out, const char *str) {
+  *out++ = '"';
+  for (;;) {
+    const char *stop = scan.escape((char *)str);
+    memcpy(out, str, stop - str);
+    out += stop - str;
+    if (!*stop)
+      break;
+    out = write_escape(out, *stop);
+    str = stop + 1;
+  }
+  *out++ = '"';
+  return out;
+}
+
+/**
+ * @brief 序列化的上下文
+ *
+ * out 为NULL时只计算长度，否则写入out + len
+ */
+struct dump_ctx {
+  char *out;
+  size_t len;
+  bool pretty;
+};
+
+static void dump_raw(struct dump_ctx *d, const char *str, size_t len) {
+  if (d->out)
+    memcpy(d->out + d->len, str, len);
+  d->len += len;
+}
+
+static void dump_long(struct dump_ctx *d, long v) {
+  if (d->out)
+    d->len = write_long(d->out + d->len, v) - d->out;
+  else
+    d->len += long_len(v);
+}
+
+static void dump_double(struct dump_ctx *d, double v) {
+  char buf[JSON_DOUBLE_MAX];
+  char *out = d->out ? d->out + d->len : buf;
+  d->len += write_double(out, v) - out;
+}
+
+static void dump_str(struct dump_ctx *d, const char *str) {
+  if (!str)
+    dump_raw(d, "null", 4);
+  else if (d->out)
+    d->len = write_str(d->out + d->len, str) - d->out;
+  else
+    d->len += str_len_escaped(str);
+}
+
+/**
+ * @brief 格式化输出时换行并缩进
+ *
+ * @param depth 缩进层数，每层两个空格
+ */
+static void dump_newline(struct dump_ctx *d, int depth) {
+  if (!d->pretty)
+    return;
+  if (d->out) {
+    d->out[d->len] = '\n';
+    memset(d->out + d->len + 1, ' ', depth * 2);
+  }
+  d->len += 1 + depth * 2;
+}
+
+static void dump_value(struct dump_ctx *d, const json *item, int depth);
+
+/**
+ * @brief 序列化对象
+ *
+ * @param first 对象的首个成员节点
+ */
+static void dump_object(struct dump_ctx *d, const json *first, int depth) {
+  if (!first) {
+    dump_raw(d, "{}", 2);
+    return;
+  }
+  dump_raw(d, "{", 1);
+  for (const json *node = first; node; node = node->next) {
+    if (node != first)
+      dump_raw(d, ",", 1);
+    dump_newline(d, depth + 1);
+    dump_str(d, node->key ? node->key : "");
+    dump_raw(d, ": ", d->pretty ? 2 : 1);
+    dump_value(d, node, depth + 1);
+  }
+  dump_newline(d, depth);
+  dump_raw(d, "}", 1);
+}
+
+/**
+ * @brief 数组的元素个数
+ *
+ * Mix, Strings 和 Jsons 以len为准，其中可能含有NULL，其余由类型得到
+ */
+static size_t array_count(const json *item) {
+  enum json_value_type type = item->value_type;
+  size_t nums = 0;
+  if (type == json_Mix || type == json_Strings || type == json_Jsons) {
+    nums = item->value.Mix ? item->len : 0;
+  } else if (type >= json_Ints && type <= json_Ints_end) {
+    nums = type - json_Ints;
+  } else if (type >= json_Floats && type <= json_Floats_end) {
+    nums = type - json_Floats;
+  } else if (type >= json_Bools && type <= json_Bools_end) {
+    nums = type - json_Bools;
+  }
+  return nums;
+}
+
+/**
+ * @brief 序列化数组，包括各种同类型数组
+ */
+static void dump_array(struct dump_ctx *d, const json *item, int depth) {
+  enum json_value_type type = item->value_type;
+  size_t nums = array_count(item);
+  if (!nums) {
+    dump_raw(d, "[]", 2);
+    return;
+  }
+  dump_raw(d, "[", 1);
+  for (size_t i = 0; i < nums; i++) {
+    if (i)
+      dump_raw(d, ",", 1);
+    dump_newline(d, depth + 1);
+    if (type == json_Mix) {
+      dump_value(d, &item->value.Mix[i], depth + 1);
+    } else if (type == json_Strings) {
+      dump_str(d, item->value.Strings[i]);
+    } else if (type == json_Jsons && !item->value.Jsons[i]) {
+      // 列中缺少的行
+      dump_raw(d, "null", 4);
+    } else if (type == json_Jsons) {
+      dump_object(d, item->value.Jsons[i], depth + 1);
+    } else if (type <= json_Ints_end) {
+      dump_long(d, item->value.Ints[i]);
+    } else if (type <= json_Floats_end) {
+      dump_double(d, item->value.Floats[i]);
+    } else if (item->value.Bools[i]) {
+      dump_raw(d, "true", 4);
+    } else {
+      dump_raw(d, "false", 5);
+    }
+  }
+  dump_newline(d, depth);
+  dump_raw(d, "]", 1);
+}
+
+/**
+ * @brief 序列化节点的值，忽略key
+ */
+static void dump_value(struct dump_ctx *d, const json *item, int depth) {
+  json_load((json *)item);
+  switch (item->value_type) {
+  case json_Null:
+    dump_raw(d, "null", 4);
+    break;
+  case json_Int:
+    dump_long(d, item->value.Int);
+    break;
+  case json_Float:
+    dump_double(d, item->value.Float);
+    break;
+  case json_Bool:
+    if (item->value.Bool)
+      dump_raw(d, "true", 4);
+    else
+      dump_raw(d, "false", 5);
+    break;
+  case json_String:
+    dump_str(d, item->value.String);
+    break;
+  case json_Json:
+    dump_object(d, item->value.Json, depth);
+    break;
+  default:
+    dump_array(d, item, depth);
+  }
+}
+
+/**
+ * @brief 将json树序列化到调用者提供的缓冲区
+ *
+ * 先计算精确长度，缓冲区足够时再写入，不会写入部分结果
+ *
+ * @param buf 输出缓冲区
+ * @param cap 缓冲区大小
+ * @param item 序列化该节点的值，通常为根节点
+ * @param flags enum json_dump_flag 的组合
+ * @return size_t 结果的长度，不含'\0'；不小于cap时未写入
+ */
+size_t json_dump_into(char *buf, size_t cap, const json *item, int flags) {
+  struct dump_ctx d = {NULL, 0, flags & JSON_PRETTY};
+  dump_value(&d, item, 0);
+  if (d.len < cap) {
+    d.out = buf;
+    d.len = 0;
+    dump_value(&d, item, 0);
+    buf[d.len] = '\0';
+  }
+  return d.len;
+}
+
+/**
+ * @brief 将json树序列化为字符串
+ *
+ * 先计算精确长度，只申请一次内存
+ *
+ * @param item 序列化该节点的值，通常为根节点
+ * @param flags enum json_dump_flag 的组合
+ * @return char* 由malloc申请，以'\0'结尾，失败返回NULL
+ */
+char *json_dump(const json *item, int flags) {
+  struct dump_ctx d = {NULL, 0, flags & JSON_PRETTY};
+  dump_value(&d, item, 0);
+  d.out = malloc(d.len + 1);
+  if (!d.out)
+    return NULL;
+  d.len = 0;
+  dump_value(&d, item, 0);
+  d.out[d.len] = '\0';
+  return d.out;
+}
+
+// json_writer 中每层容器的状态位
+#define WRITER_OBJECT 1 // 为对象，否则为数组
+#define WRITER_ITEMS 2  // 已写入至少一个成员或元素
+#define WRITER_VALUE 4  // 对象已写入key，等待值
+
+/**
+ * @brief 流式写入器
+ *
+ * 输出先写入固定大小的buf，满时交给flush，内存占用与输出大小无关。
+ * stack 记录每层未结束的容器，用于检查嵌套与插入分隔符
+ */
+struct json_writer {
+  bool (*flush)(void *arg, const char *buf, size_t len);
+  void *arg;
+  bool pretty;
+  bool error; // 出错后之后的调用均失败
+  bool done;  // 根值已写完
+  size_t depth;
+  unsigned char stack[JSON_WRITER_DEPTH];
+  size_t len;
+  char buf[JSON_WRITER_BUF];
+};
+
+/**
+ * @brief 创建写入到回调的写入器
+ *
+ * @param flush 缓冲区满或结束时调用，flush(arg, buf, len)，失败返回false
+ * @param arg 传给flush
+ * @param flags enum json_dump_flag 的组合
+ * @return json_writer* 失败返回NULL
+ */
+json_writer *json_writer_new(bool (*flush)(void *arg, const char *buf,
+                                           size_t len),
+                             void *arg, int flags) {
+  json_writer *w = malloc(sizeof(json_writer));
+  if (!w)
+    return NULL;
+  w->flush = flush;
+  w->arg = arg;
+  w->pretty = flags & JSON_PRETTY;
+  w->error = false;
+  w->done = false;
+  w->depth = 0;
+  w->len = 0;
+  return w;
+}
+
+#ifdef JSON_POSIX
+/**
+ * @brief 写入文件描述符，处理部分写入与EINTR
+ */
+static bool writer_fd_flush(void *arg, const char *buf, size_t len) {
+  int fd = (int)(intptr_t)arg;
+  while (len) {
+    ssize_t n = write(fd, buf, len);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    buf += n;
+    len -= n;
+  }
+  return true;
+}
+
+/**
+ * @brief 创建写入到文件描述符的写入器
+ *
+ * @param fd 已打开的文件描述符，不会被关闭
+ * @param flags enum json_dump_flag 的组合
+ * @return json_writer* 失败返回NULL
+ */
+json_writer *json_writer_new_fd(int fd, int flags) {
+  return json_writer_new(writer_fd_flush, (void *)(intptr_t)fd, flags);
+}
+#endif
+
+/**
+ * @brief 将缓冲区交给flush
+ */
+static bool writer_flush(json_writer *w) {
+  if (w->len && !w->error && !w->flush(w->arg, w->buf, w->len))
+    w->error = true;
+  w->len = 0;
+  return !w->error;
+}
+
+/**
+ * @brief 确保缓冲区至少还有size字节，size 不大于 JSON_WRITER_BUF
+ *
+ * @return char* 写入位置，失败返回NULL
+ */
+static char *writer_reserve(json_writer *w, size_t size) {
+  if (w->len + size > JSON_WRITER_BUF && !writer_flush(w))
+    return NULL;
+  return w->buf + w->len;
+}
+
+/**
+ * @brief 写入任意长度的原文，超过缓冲区时分段写入
+ */
+static bool writer_raw(json_writer *w, const char *str, size_t len) {
+  while (len) {
+    size_t n = JSON_WRITER_BUF - w->len;
+    if (!n) {
+      if (!writer_flush(w))
+        return false;
+      n = JSON_WRITER_BUF;
+    }
+    if (n > len)
+      n = len;
+    memcpy(w->buf + w->len, str, n);
+    w->len += n;
+    str += n;
+    len -= n;
+  }
+  return true;
+}
+
+/**
+ * @brief 格式化输出时换行并缩进
+ */
+static bool writer_newline(json_writer *w, size_t depth) {
+  if (!w->pretty)
+    return true;
+  char *out = writer_reserve(w, 1 + depth * 2);
+  if (!out)
+    return false;
+  *out = '\n';
+  memset(out + 1, ' ', depth * 2);
+  w->len += 1 + depth * 2;
+  return true;
+}
+
+/**
+ * @brief 写入转义后的字符串，包括两端的`"`
+ *
+ * 与write_str共用扫描kernel与转义，长字符串分段写入
+ */
+static bool writer_str(json_writer *w, const char *str) {
+  if (!writer_raw(w, "\"", 1))
+    return false;
+  for (;;) {
+    const char *stop = scan.escape((char *)str);
+    if (!writer_raw(w, str, stop - str))
+      return false;
+    if (!*stop)
+      break;
+    char *out = writer_reserve(w, 6);
+    if (!out)
+      return false;
+    w->len = write_escape(out, *stop) - w->buf;
+    str = stop + 1;
+  }
+  return writer_raw(w, "\"", 1);
+}
+
+/**
+ * @brief 写入值之前检查位置并写入分隔符
+ *
+ * 值可以是根值、数组元素，或对象中key之后的值
+ */
+static bool writer_before_value(json_writer *w) {
+  if (w->error)
+    return false;
+  if (!w->depth) {
+    if (w->done)
+      w->error = true;
+    return !w->error;
+  }
+  unsigned char *top = &w->stack[w->depth - 1];
+  if (*top & WRITER_OBJECT) {
+    if (!(*top & WRITER_VALUE))
+      w->error = true;
+    return !w->error;
+  }
+  if ((*top & WRITER_ITEMS) && !writer_raw(w, ",", 1))
+    return false;
+  return writer_newline(w, w->depth);
+}
+
+/**
+ * @brief 值写完之后更新当前容器的状态
+ */
+static bool writer_after_value(json_writer *w) {
+  if (!w->depth) {
+    w->done = true;
+    return true;
+  }
+  unsigned char *top = &w->stack[w->depth - 1];
+  *top = (*top & ~WRITER_VALUE) | WRITER_ITEMS;
+  return true;
+}
+
+/**
+ * @brief 写入对象的key
+ *
+ * @param key 以'\0'结尾的key
+ * @return bool 不在对象中、上一个key没有值或写入失败时返回false
+ */
+bool json_writer_key(json_writer *w, const char *key) {
+  if (w->error)
+    return false;
+  unsigned char *top = w->depth ? &w->stack[w->depth - 1] : NULL;
+  if (!top || !(*top & WRITER_OBJECT) || (*top & WRITER_VALUE)) {
+    w->error = true;
+    return false;
+  }
+  if (((*top & WRITER_ITEMS) && !writer_raw(w, ",", 1)) ||
+      !writer_newline(w, w->depth) || !writer_str(w, key) ||
+      !writer_raw(w, ": ", w->pretty ? 2 : 1))
+    return false;
+  *top |= WRITER_VALUE;
+  return true;
+}
+
+/**
+ * @brief 开始对象或数组
+ */
+static bool writer_begin(json_writer *w, bool object) {
+  if (!writer_before_value(w))
+    return false;
+  if (w->depth == JSON_WRITER_DEPTH) {
+    w->error = true;
+    return false;
+  }
+  if (!writer_raw(w, object ? "{" : "[", 1))
+    return false;
+  w->stack[w->depth++] = object ? WRITER_OBJECT : 0;
+  return true;
+}
+
+/**
+ * @brief 结束对象或数组
+ */
+static bool writer_end(json_writer *w, bool object) {
+  if (w->error)
+    return false;
+  unsigned char *top = w->depth ? &w->stack[w->depth - 1] : NULL;
+  if (!top || (bool)(*top & WRITER_OBJECT) != object ||
+      (*top & WRITER_VALUE)) {
+    w->error = true;
+    return false;
+  }
+  bool items = *top & WRITER_ITEMS;
+  w->depth--;
+  if ((items && !writer_newline(w, w->depth)) ||
+      !writer_raw(w, object ? "}" : "]", 1))
+    return false;
+  return writer_after_value(w);
+}
+
+/**
+ * @brief 开始对象
+ */
+bool json_writer_begin_object(json_writer *w) { return writer_begin(w, true); }
+
+/**
+ * @brief 结束对象
+ */
+bool json_writer_end_object(json_writer *w) { return writer_end(w, true); }
+
+/**
+ * @brief 开始数组
+ */
+bool json_writer_begin_array(json_writer *w) { return writer_begin(w, false); }
+
+/**
+ * @brief 结束数组
+ */
+bool json_writer_end_array(json_writer *w) { return writer_end(w, false); }
+
+/**
+ * @brief 写入整数
+ */
+bool json_writer_int(json_writer *w, long v) {
+  if (!writer_before_value(w))
+    return false;
+  char *out = writer_reserve(w, 21);
+  if (!out)
+    return false;
+  w->len = write_long(out, v) - w->buf;
+  return writer_after_value(w);
+}
+
+/**
+ * @brief 写入浮点数，格式与json_dump相同
+ */
+bool json_writer_double(json_writer *w, double v) {
+  if (!writer_before_value(w))
+    return false;
+  char *out = writer_reserve(w, JSON_DOUBLE_MAX);
+  if (!out)
+    return false;
+  w->len = write_double(out, v) - w->buf;
+  return writer_after_value(w);
+}
+
+/**
+ * @brief 写入布尔值
+ */
+bool json_writer_bool(json_writer *w, bool v) {
+  if (!writer_before_value(w) ||
+      !writer_raw(w, v ? "true" : "false", v ? 4 : 5))
+    return false;
+  return writer_after_value(w);
+}
+
+/**
+ * @brief 写入null
+ */
+bool json_writer_null(json_writer *w) {
+  if (!writer_before_value(w) || !writer_raw(w, "null", 4))
+    return false;
+  return writer_after_value(w);
+}
+
+/**
+ * @brief 写入字符串，NULL 写为null
+ */
+bool json_writer_string(json_writer *w, const char *str) {
+  if (!str)
+    return json_writer_null(w);
+  if (!writer_before_value(w) || !writer_str(w, str))
+    return false;
+  return writer_after_value(w);
+}
+
+/**
+ * @brief 写入json树中节点的值
+ *
+ * 与json_dump使用相同的序列化，格式化输出时按当前层数缩进
+ */
+bool json_writer_value(json_writer *w, const json *item) {
+  if (!writer_before_value(w))
+    return false;
+  struct dump_ctx d = {NULL, 0, w->pretty};
+  dump_value(&d, item, w->depth);
+  size_t len = d.len;
+
+  // 能放入缓冲区时直接写入，否则单独申请
+  if (len <= JSON_WRITER_BUF) {
+    d.out = writer_reserve(w, len);
+    if (!d.out)
+      return false;
+    d.len = 0;
+    dump_value(&d, item, w->depth);
+    w->len += len;
+  } else {
+    d.out = malloc(len);
+    if (!d.out) {
+      w->error = true;
+      return false;
+    }
+    d.len = 0;
+    dump_value(&d, item, w->depth);
+    bool ok = writer_raw(w, d.out, len);
+    free(d.out);
+    if (!ok)
+      return false;
+  }
+  return writer_after_value(w);
+}
+
+/**
+ * @brief 写入剩余的输出并释放写入器
+ *
+ * @return bool 所有写入均成功且根值已完整结束时返回true
+ */
+bool json_writer_finish(json_writer *w) {
+  if (!w)
+    return false;
+  bool ok = writer_flush(w) && w->done && !w->depth;
+  free(w);
+  return ok;
+}
+
+static bool sax_value(char **s, const struct json_sax_handler *h, void *arg);
+
+/**
+ * @brief 扫描字符串并产生key或string事件
+ *
+ * 事件中的字符串为输入中两端`"`之间的原文，不复制也不解码
+ *
+ * @param s 确保**s为`"`，修改为字符串末尾`"`之后
+ * @param key 是否为对象的key
+ */
+static bool sax_string(char **s, bool key, const struct json_sax_handler *h,
+                       void *arg) {
+  char *str = *s + 1;
+  char *end = str;
+  bool escaped = false;
+  for (;;) {
+    end = scan.quote(end);
+    if (*end == '"')
+      break;
+    if (!*end || !*(end + 1))
+      return false;
+    escaped = true;
+    end += 2;
+  }
+  *s = end + 1;
+  bool (*fn)(void *, const char *, size_t, bool) = key ? h->key : h->string;
+  return !fn || fn(arg, str, end - str, escaped);
+}
+
+/**
+ * @brief 按parse_number的语法找到数字的结尾，不转换数值
+ *
+ * @param str 数字开始
+ * @return char* 数字结束的下一个字符，不是数字时返回NULL
+ */
+static char *number_end(char *str) {
+  if (*str == '-')
+    str++;
+  if (*str < '0' || *str > '9')
+    return NULL;
+  while (*str >= '0' && *str <= '9')
+    str++;
+  if (*str == '.')
+    for (str++; *str >= '0' && *str <= '9'; str++)
+      ;
+  if (*str == 'e' || *str == 'E') {
+    str++;
+    if (*str == '-' || *str == '+')
+      str++;
+    while (*str >= '0' && *str <= '9')
+      str++;
+  }
+  return str;
+}
+
+/**
+ * @brief 扫描数字，有number回调时交出原文，否则转换后交给integer或real；
+ * 两种方式接受的数字相同
+ */
+static bool sax_number(char **s, const struct json_sax_handler *h,
+                       void *arg) {
+  char *str = *s;
+  if (h->number) {
+    char *end = number_end(str);
+    if (!end)
+      return false;
+    *s = end;
+    return h->number(arg, str, end - str);
+  }
+  json item;
+  if (!parse_number(s, &item))
+    return false;
+  if (item.value_type == json_Int)
+    return !h->integer || h->integer(arg, item.value.Int);
+  return !h->real || h->real(arg, item.value.Float);
+}
+
+/**
+ * @brief 扫描对象，与parse_object一样忽略多余的`,`
+ *
+ * @param s 确保**s为`{`，修改为对象结束的下一个字符
+ */
+static bool sax_object(char **s, const struct json_sax_handler *h,
+                       void *arg) {
+  if (h->start_object && !h->start_object(arg))
+    return false;
+  char *str = skip(*s + 1);
+  while (*str != '}') {
+    if (*str == ',') {
+      str = skip(str + 1);
+      continue;
+    }
+    if (*str != '"' || !sax_string(&str, true, h, arg))
+      return false;
+    str = skip(str);
+    if (*str != ':')
+      return false;
+    str = skip(str + 1);
+    if (!sax_value(&str, h, arg))
+      return false;
+    str = skip(str);
+  }
+  *s = str + 1;
+  return !h->end_object || h->end_object(arg);
+}
+
+/**
+ * @brief 扫描数组，与parse_array一样忽略多余的`,`
+ *
+ * @param s 确保**s为`[`，修改为数组结束的下一个字符
+ */
+static bool sax_array(char **s, const struct json_sax_handler *h, void *arg) {
+  if (h->start_array && !h->start_array(arg))
+    return false;
+  char *str = skip(*s + 1);
+  while (*str != ']') {
+    if (*str == ',') {
+      str = skip(str + 1);
+      continue;
+    }
+    if (!sax_value(&str, h, arg))
+      return false;
+    str = skip(str);
+  }
+  *s = str + 1;
+  return !h->end_array || h->end_array(arg);
+}
+
+/**
+ * @brief 扫描一个值并产生对应的事件
+ *
+ * @param s 从*s开始，修改为值结束的下一个字符
+ */
+static bool sax_value(char **s, const struct json_sax_handler *h, void *arg) {
+  char *str = *s;
+  if (*str == '"')
+    return sax_string(s, false, h, arg);
+  if ((*str >= '0' && *str <= '9') || *str == '-')
+    return sax_number(s, h, arg);
+  if (*str == '{')
+    return sax_object(s, h, arg);
+  if (*str == '[')
+    return sax_array(s, h, arg);
+
+  if (!strncmp("null", str, 4)) {
+    *s = str + 4;
+    return !h->null || h->null(arg);
+  }
+  if (!strncmp("true", str, 4)) {
+    *s = str + 4;
+    return !h->boolean || h->boolean(arg, true);
+  }
+  if (!strncmp("false", str, 5)) {
+    *s = str + 5;
+    return !h->boolean || h->boolean(arg, false);
+  }
+  return false;
+}
+
+/**
+ * @brief 以事件的方式扫描json，不构建json树，不申请内存
+ *
+ * 使用与json_parse相同的扫描kernel，根值可以是任意类型
+ *
+ * @param s 以'\0'结尾的输入
+ * @param h 事件回调，为NULL的回调被忽略，回调返回false时停止扫描
+ * @param arg 传给每个回调
+ * @return bool 扫描完整个值时返回true，语法错误或被回调停止时返回false
+ */
+bool json_sax_parse(const char *s, const struct json_sax_handler *h,
+                    void *arg) {
+  char *str = skip((char *)s);
+  return sax_value(&str, h, arg);
+}
+
+/**
+ * @brief 解码string或key事件中的字符串
+ *
+ * @param out 至少有len + 1字节，写入以'\0'结尾的结果
+ * @param str 事件中的字符串，必须仍指向原输入
+ * @param len 事件中的长度
+ * @return size_t 解码后的长度，不含'\0'
+ */
+size_t json_sax_unescape(char *out, const char *str, size_t len) {
+  char *from = (char *)str;
+  (void)len;
+  return unescape_str(out, &from) - out - 1;
+}
+
+/*
+ * tape 中每个值占一个或两个64位的字，高8位为标记，低56位为参数：
+ * - `{` `[` 参数为对应结尾的下一个字的下标，跳过整个容器只需一步
+ * - `}` `]` 参数为对应开头的下标
+ * - `"` 参数为字符串在字符串缓冲区中的偏移，对象的key同样以`"`记录
+ * - `l` `d` 下一个字为整数或浮点数的二进制表示
+ * - `t` `f` `n` 为true, false, null
+ */
+#define TAPE_SHIFT 56
+#define TAPE_TAG(w) ((char)((w) >> TAPE_SHIFT))
+#define TAPE_ARG(w) ((w) & (((uint64_t)1 << TAPE_SHIFT) - 1))
+
+/**
+ * @brief 扁平的文档
+ *
+ * 整个文档按出现顺序储存在words中，根值从下标0开始；
+ * strs 中每个字符串为4字节的长度、解码后的内容和'\0'
+ */
+struct json_tape {
+  uint64_t *words;
+  size_t nums;
+  size_t cap;
+  char *strs;
+  size_t strs_len;
+  size_t strs_cap;
+};
+
+/**
+ * @brief 由SAX事件构建tape时的状态
+ *
+ * stack 为尚未结束的容器开头的下标
+ */
+struct tape_builder {
+  json_tape *t;
+  size_t *stack;
+  size_t depth;
+  size_t cap;
+};
+
+static bool tape_push(json_tape *t, uint64_t word) {
+  if (t->nums == t->cap) {
+    size_t cap = t->cap * 2;
+    uint64_t *words = realloc(t->words, cap * sizeof(uint64_t));
+    if (!words)
+      return false;
+    t->words = words;
+    t->cap = cap;
+  }
+  t->words[t->nums++] = word;
+  return true;
+}
+
+static bool tape_tag(json_tape *t, char tag, uint64_t arg) {
+  return tape_push(t, (uint64_t)(unsigned char)tag << TAPE_SHIFT | arg);
+}
+
+static bool tape_open(void *arg, char tag) {
+  struct tape_builder *b = arg;
+  if (b->depth == b->cap) {
+    size_t cap = b->cap ? b->cap * 2 : 64;
+    size_t *stack = realloc(b->stack, cap * sizeof(size_t));
+    if (!stack)
+      return false;
+    b->stack = stack;
+    b->cap = cap;
+  }
+  b->stack[b->depth++] = b->t->nums;
+  return tape_tag(b->t, tag, 0);
+}
+
+// 结尾记录开头的下标，开头回填结尾之后的下标
+static bool tape_close(void *arg, char tag) {
+  struct tape_builder *b = arg;
+  json_tape *t = b->t;
+  size_t open = b->stack[--b->depth];
+  if (!tape_tag(t, tag, open))
+    return false;
+  t->words[open] |= t->nums;
+  return true;
+}
+
+static bool tape_start_object(void *arg) { return tape_open(arg, '{'); }
+static bool tape_end_object(void *arg) { return tape_close(arg, '}'); }
+static bool tape_start_array(void *arg) { return tape_open(arg, '['); }
+static bool tape_end_array(void *arg) { return tape_close(arg, ']'); }
+
+static bool tape_string(void *arg, const char *str, size_t len,
+                        bool escaped) {
+  json_tape *t = ((struct tape_builder *)arg)->t;
+  if (len > UINT32_MAX)
+    return false;
+  size_t need = t->strs_len + sizeof(uint32_t) + len + 1;
+  if (need > t->strs_cap) {
+    size_t cap = t->strs_cap * 2 > need ? t->strs_cap * 2 : need;
+    char *strs = realloc(t->strs, cap);
+    if (!strs)
+      return false;
+    t->strs = strs;
+    t->strs_cap = cap;
+  }
+  size_t off = t->strs_len;
+  char *out = t->strs + off + sizeof(uint32_t);
+  uint32_t n = (uint32_t)len;
+  if (escaped)
+    n = (uint32_t)json_sax_unescape(out, str, len);
+  else
+    memcpy(out, str, len);
+  out[n] = '\0';
+  memcpy(t->strs + off, &n, sizeof(uint32_t));
+  t->strs_len = off + sizeof(uint32_t) + n + 1;
+  return tape_tag(t, '"', off);
+}
+
+static bool tape_integer(void *arg, long v) {
+  json_tape *t = ((struct tape_builder *)arg)->t;
+  return tape_tag(t, 'l', 0) && tape_push(t, (uint64_t)v);
+}
+
+static bool tape_real(void *arg, double v) {
+  json_tape *t = ((struct tape_builder *)arg)->t;
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  return tape_tag(t, 'd', 0) && tape_push(t, bits);
+}
+
+static bool tape_boolean(void *arg, bool v) {
+  return tape_tag(((struct tape_builder *)arg)->t, v ? 't' : 'f', 0);
+}
+
+static bool tape_null(void *arg) {
+  return tape_tag(((struct tape_builder *)arg)->t, 'n', 0);
+}
+
+/**
+ * @brief 释放tape
+ *
+ * @param t 可以为NULL
+ */
+void json_tape_free(json_tape *t) {
+  if (!t)
+    return;
+  free(t->words);
+  free(t->strs);
+  free(t);
+}
+
+/**
+ * @brief 解析为扁平的tape，而不是由节点链接的json树
+ *
+ * 由SAX事件依次写入，容器结束时回填开头，只申请少量连续的内存
+ *
+ * @param s 以'\0'结尾的输入，根值可以是任意类型
+ * @return json_tape* 由json_tape_free释放，失败返回NULL
+ */
+json_tape *json_tape_parse(const char *s) {
+  static const struct json_sax_handler h = {
+      tape_start_object, tape_end_object, tape_start_array,
+      tape_end_array,    tape_string,     tape_string,
+      NULL,              tape_integer,    tape_real,
+      tape_boolean,      tape_null,
+  };
+  size_t len = strlen(s);
+  json_tape *t = calloc(1, sizeof(json_tape));
+  if (!t)
+    return NULL;
+  // 按输入长度估算，多数文档不需要扩容
+  t->cap = len / 4 + 16;
+  t->strs_cap = len / 2 + 16;
+  t->words = malloc(t->cap * sizeof(uint64_t));
+  t->strs = malloc(t->strs_cap);
+  struct tape_builder b = {t, NULL, 0, 0};
+  bool ok = t->words && t->strs && json_sax_parse(s, &h, &b);
+  free(b.stack);
+  if (!ok) {
+    json_tape_free(t);
+    return NULL;
+  }
+  return t;
+}
+
+/**
+ * @brief 下标i处的值之后的下标
+ */
+static size_t tape_next(const json_tape *t, size_t i) {
+  char tag = TAPE_TAG(t->words[i]);
+  if (tag == '{' || tag == '[')
+    return TAPE_ARG(t->words[i]);
+  if (tag == 'l' || tag == 'd')
+    return i + 2;
+  return i + 1;
+}
+
+static char *tape_str(const json_tape *t, size_t i) {
+  return t->strs + TAPE_ARG(t->words[i]) + sizeof(uint32_t);
+}
+
+static uint32_t tape_str_len(const json_tape *t, size_t i) {
+  uint32_t n;
+  memcpy(&n, t->strs + TAPE_ARG(t->words[i]), sizeof(uint32_t));
+  return n;
+}
+
+/**
+ * @brief 按路径的一段跳转
+ *
+ * 对象中依次比较key，不匹配的值整体跳过；数组中跳过前index个元素
+ *
+ * @param i 当前值的下标
+ * @param key 该段的key
+ * @param len key的长度
+ * @param index 该段按十进制解析的下标，不全是数字时为-1
+ * @return size_t 跳转后的下标，未找到时返回SIZE_MAX
+ */
+static size_t tape_step(const json_tape *t, size_t i, const char *key,
+                        size_t len, long index) {
+  char tag = TAPE_TAG(t->words[i]);
+  if (tag == '{') {
+    for (size_t j = i + 1; TAPE_TAG(t->words[j]) != '}';
+         j = tape_next(t, j + 1))
+      if (tape_str_len(t, j) == len && !memcmp(tape_str(t, j), key, len))
+        return j + 1;
+  } else if (tag == '[' && index >= 0) {
+    for (size_t j = i + 1; TAPE_TAG(t->words[j]) != ']'; j = tape_next(t, j))
+      if (!index--)
+        return j;
+  }
+  return SIZE_MAX;
+}
+
+/**
+ * @brief 按编译后的路径在tape中取值
+ *
+ * @param path 编译后的路径，段的规则与json_path_get相同
+ * @param t tape，从根值开始搜索
+ * @param type 修改为该值的类型，对象为 json_Json，数组为 json_Mix
+ * @param value 修改为该值，对象和数组为其在tape中的下标
+ * @return bool 未找到时返回false
+ */
+bool json_tape_path_get(const json_path *path, const json_tape *t,
+                        enum json_value_type *type, union json_value *value) {
+  size_t i = 0;
+  for (size_t k = 0; k < path->nums && i != SIZE_MAX; k++) {
+    const struct json_path_seg *seg = &path->segs[k];
+    i = tape_step(t, i, seg->key, seg->len, seg->index);
+  }
+  if (i == SIZE_MAX)
+    return false;
+
+  uint64_t w = t->words[i];
+  switch (TAPE_TAG(w)) {
+  case '{':
+    *type = json_Json;
+    value->Int = (long)i;
+    break;
+  case '[':
+    *type = json_Mix;
+    value->Int = (long)i;
+    break;
+  case '"':
+    *type = json_String;
+    value->String = tape_str(t, i);
+    break;
+  case 'l':
+    *type = json_Int;
+    value->Int = (long)t->words[i + 1];
+    break;
+  case 'd':
+    *type = json_Float;
+    memcpy(&value->Float, &t->words[i + 1], sizeof(double));
+    break;
+  case 't':
+  case 'f':
+    *type = json_Bool;
+    value->Bool = TAPE_TAG(w) == 't';
+    break;
+  default:
+    *type = json_Null;
+  }
+  return true;
+}
+
+/**
+ * @brief 在tape中读取字符串，路径规则与json_read_str相同
+ *
+ * @param key 以SPLIT分隔的路径
+ * @param t tape
+ * @return char* 未找到或不是字符串时返回NULL
+ */
+char *json_tape_read_str(char *key, const json_tape *t) {
+  size_t i = 0;
+  char *str = key;
+  for (;;) {
+    size_t strn;
+    long index = 0;
+    for (strn = 0; str[strn] != SPLIT && str[strn]; strn++)
+      if (index >= 0 && str[strn] >= '0' && str[strn] <= '9' && strn < 18)
+        index = index * 10 + (str[strn] - '0');
+      else
+        index = -1;
+    if (!strn)
+      index = -1;
+    i = tape_step(t, i, str, strn, index);
+    if (i == SIZE_MAX)
+      return NULL;
+    if (!str[strn])
+      break;
+    str += strn + 1;
+  }
+  return TAPE_TAG(t->words[i]) == '"' ? tape_str(t, i) : NULL;
+}
+
+/**
+ * @brief 序列化tape中的一个值
+ *
+ * @param i 值的下标
+ * @return size_t 值之后的下标
+ */
+static size_t dump_tape(struct dump_ctx *d, const json_tape *t, size_t i,
+                        int depth) {
+  uint64_t w = t->words[i];
+  char tag = TAPE_TAG(w);
+  switch (tag) {
+  case '{':
+  case '[': {
+    char close = tag == '{' ? '}' : ']';
+    size_t j = i + 1;
+    if (TAPE_TAG(t->words[j]) == close) {
+      dump_raw(d, tag == '{' ? "{}" : "[]", 2);
+      return j + 1;
+    }
+    dump_raw(d, &tag, 1);
+    while (TAPE_TAG(t->words[j]) != close) {
+      if (j != i + 1)
+        dump_raw(d, ",", 1);
+      dump_newline(d, depth + 1);
+      if (tag == '{') {
+        dump_str(d, tape_str(t, j));
+        dump_raw(d, ": ", d->pretty ? 2 : 1);
+        j++;
+      }
+      j = dump_tape(d, t, j, depth + 1);
+    }
+    dump_newline(d, depth);
+    dump_raw(d, &close, 1);
+    return j + 1;
+  }
+  case '"':
+    dump_str(d, tape_str(t, i));
+    break;
+  case 'l':
+    dump_long(d, (long)t->words[i + 1]);
+    return i + 2;
+  case 'd': {
+    double v;
+    memcpy(&v, &t->words[i + 1], sizeof(double));
+    dump_double(d, v);
+    return i + 2;
+  }
+  case 't':
+    dump_raw(d, "true", 4);
+    break;
+  case 'f':
+    dump_raw(d, "false", 5);
+    break;
+  default:
+    dump_raw(d, "null", 4);
+  }
+  return i + 1;
+}
+
+/**
+ * @brief 将tape序列化为字符串
+ *
+ * 与json_dump的输出相同，按顺序扫描tape
+ *
+ * @param t tape
+ * @param flags enum json_dump_flag 的组合
+ * @return char* 由malloc申请，以'\0'结尾，失败返回NULL
+ */
+char *json_tape_dump(const json_tape *t, int flags) {
+  struct dump_ctx d = {NULL, 0, flags & JSON_PRETTY};
+  dump_tape(&d, t, 0, 0);
+  d.out = malloc(d.len + 1);
+  if (!d.out)
+    return NULL;
+  d.len = 0;
+  dump_tape(&d, t, 0, 0);
+  d.out[d.len] = '\0';
+  return d.out;
+}
+
+/**
+ * @brief 构建中的一列
+ *
+ * vals 为各行的值，nums 为已填写的行数，之前未出现的行填为null
+ */
+struct column_build {
+  char *key;
+  size_t len;
+  json *vals;
+  size_t nums;
+  size_t cap;
+};
+
+/**
+ * @brief 构建中的各列
+ *
+ * fixed 为true时只投影给定的key，否则每个新出现的key增加一列；
+ * hint 为上一次匹配的列之后的一列，结构相同的记录通常按顺序命中
+ */
+struct columns_build {
+  struct column_build *cols;
+  size_t nums;
+  size_t cap;
+  size_t hint;
+  bool fixed;
+};
 
-    str = skip(str);
+/**
+ * @brief 增加一列，列名复制到文档中
+ *
+ * @return size_t 新列的序号，失败返回SIZE_MAX
+ */
+static size_t columns_add(struct columns_build *b, json_doc *doc,
+                          const char *key, size_t len) {
+  if (b->nums == b->cap) {
+    size_t cap = b->cap ? b->cap * 2 : 8;
+    struct column_build *cols = realloc(b->cols, cap * sizeof(*cols));
+    if (!cols)
+      return SIZE_MAX;
+    b->cols = cols;
+    b->cap = cap;
   }
-  head->next = NULL;
-  return ret;
+  char *copy = arena_alloc(doc, len + 1);
+  if (!copy)
+    return SIZE_MAX;
+  memcpy(copy, key, len);
+  copy[len] = '\0';
+  struct column_build *c = &b->cols[b->nums];
+  c->key = copy;
+  c->len = len;
+  c->vals = NULL;
+  c->nums = c->cap = 0;
+  return b->nums++;
 }
 
 /**
- * @brief 解析array
+ * @brief 查找key对应的列，先尝试hint
  *
- * @param s 从*s字符串中解析，确保**s为`[`
- * 并修改*s指向array对象结束的下一个字符
- * @param item 父json节点指针，将修改value, value_type
+ * @param key 不需要以'\0'结尾
+ * @return size_t 列的序号，未找到返回SIZE_MAX
  */
-static void parse_array(char **s, json *item) {
-  char *str = *s;
-  if (*str != '[')
-    return;
-  str++;
-  str = skip(str);
-  if (*str == ']') {
-    item->value_type = json_Mix;
-    item->value.Mix = NULL;
-    *s = str + 1;
-    return;
-  }
-
-  // 类型判断
-  enum json_value_type type = json_Null;
-  size_t nums = 0;
-  do {
-    // 忽略`,`
-    while (*str == ',') {
-      str++;
-      str = skip(str);
+static size_t columns_find(struct columns_build *b, const char *key,
+                           size_t len) {
+  for (size_t k = 0; k < b->nums; k++) {
+    size_t i = (b->hint + k) % b->nums;
+    struct column_build *c = &b->cols[i];
+    if (c->len == len && !memcmp(c->key, key, len)) {
+      b->hint = i + 1;
+      return i;
     }
+  }
+  return SIZE_MAX;
+}
 
-    //判断是否结束
-    if (*str == ']')
-      break;
-
-    if (*str == '"') {
-      // 数组元素为字符串
-      str = nest_match_str(str);
-
-      if (type == json_Null || type == json_Strings)
-        type = json_Strings;
-      else
-        type = json_Mix;
+/**
+ * @brief 查找key对应的列，非fixed时没有则增加一列
+ *
+ * @return size_t 列的序号，不投影或失败时返回SIZE_MAX
+ */
+static size_t columns_match(struct columns_build *b, json_doc *doc,
+                            const char *key, size_t len) {
+  size_t i = columns_find(b, key, len);
+  if (i == SIZE_MAX && !b->fixed)
+    i = columns_add(b, doc, key, len);
+  return i;
+}
 
-    } else if (*str >= '0' && *str <= '9') {
-      // 数组元素为数字
-      bool isfloat = false;
-      while (str++) {
-        if (*str >= '0' && *str <= '9' || *str == '-')
-          continue;
-        else if (*str == '.' || *str == 'e' || *str == 'E')
-          isfloat = true;
-        else
-          break;
-      }
+/**
+ * @brief 填写一列中的一行，之前未填写的行填为null
+ *
+ * @return bool 失败返回false
+ */
+static bool column_set(struct column_build *c, size_t row, const json *val) {
+  if (row >= c->cap) {
+    size_t cap = c->cap ? c->cap * 2 : 64;
+    while (cap <= row)
+      cap *= 2;
+    json *vals = realloc(c->vals, cap * sizeof(json));
+    if (!vals)
+      return false;
+    c->vals = vals;
+    c->cap = cap;
+  }
+  for (; c->nums < row; c->nums++) {
+    c->vals[c->nums].value_type = json_Null;
+    c->vals[c->nums].len = 0;
+  }
+  c->vals[row] = *val;
+  c->vals[row].key = NULL;
+  // 复制的节点之后没有 json_head，去掉成员的标记
+  if (len_spare(val))
+    c->vals[row].len &= ~JSON_LEN_FLAGS;
+  c->nums = row + 1;
+  return true;
+}
 
-      if (isfloat) {
-        if (type == json_Null)
-          type = json_Floats + 1;
-        else if (type >= json_Floats && type <= json_Floats_end)
-          type = type + 1;
-        else
-          type = json_Mix;
-      } else {
-        if (type == json_Null)
-          type = json_Ints + 1;
-        else if (type >= json_Ints && type <= json_Ints_end)
-          type = type + 1;
-        else
-          type = json_Mix;
-      }
+static void columns_release(struct columns_build *b) {
+  for (size_t i = 0; i < b->nums; i++)
+    free(b->cols[i].vals);
+  free(b->cols);
+}
 
-    } else if (*str == '{') {
-      // 数组元素为 object
-      str = nest_match(str);
+/**
+ * @brief 由一列的各行生成类型化数组与位图
+ *
+ * 除null外的值类型相同时为 Ints, Floats, Bools, Strings 或 Jsons，
+ * null 的行为0, false 或 NULL；否则为Mix
+ *
+ * @param col 修改col的value, value_type, len
+ * @param valid 修改为位图
+ * @return bool 失败返回false
+ */
+static bool column_finish(json_doc *doc, struct column_build *c, size_t rows,
+                          json *col, uint64_t **valid) {
+  json null = {.value_type = json_Null};
+  if (c->nums < rows && !column_set(c, rows - 1, &null))
+    return false;
 
-      if (type == json_Null || type == json_Jsons)
-        type = json_Jsons;
-      else
-        type = json_Mix;
-    } else if (*str == '[') {
-      // 数组元素为 array
-      str = nest_match(str);
-      type = json_Mix;
-    } else {
-      // 数组元素为 null 或 bool
-      if (!strncmp("null", str, 4)) {
-        str += 4;
-        type = json_Mix;
-      } else if (!strncmp("true", str, 4)) {
-        str += 4;
-        if (type == json_Null)
-          type = json_Bools + 1;
-        else if (type >= json_Bools && type < json_Bools_end)
-          type = type + 1;
-        else
-          type = json_Mix;
-      } else if (!strncmp("false", str, 5)) {
-        str += 5;
-        if (type == json_Null)
-          type = json_Bools + 1;
-        else if (type >= json_Bools && type < json_Bools_end)
-          type = type + 1;
-        else
-          type = json_Mix;
-      }
-    }
+  size_t words = (rows + 63) / 64;
+  uint64_t *bits = arena_alloc(doc, words * sizeof(uint64_t));
+  if (!bits)
+    return false;
+  memset(bits, 0, words * sizeof(uint64_t));
+  enum json_value_type kind = json_Null;
+  for (size_t i = 0; i < rows; i++) {
+    if (c->vals[i].value_type == json_Null)
+      continue;
+    bits[i / 64] |= (uint64_t)1 << (i % 64);
+    enum json_value_type k = array_kind(&c->vals[i]);
+    if (kind == json_Null)
+      kind = k;
+    else if (k != kind)
+      kind = json_Mix;
+  }
+  *valid = bits;
+  // Ints, Floats, Bools 的长度编码在类型中，超出范围时转为Mix
+  if (kind == json_Null ||
+      ((kind == json_Ints || kind == json_Floats || kind == json_Bools) &&
+       rows >= json_Ints_end - json_Ints))
+    kind = json_Mix;
 
-    str = skip(str);
-    nums++;
-  } while (*str == ',');
-  if (type == json_Strings)
-    item->value = parse_array_strings(*s, nums);
-  else if (type == json_Jsons)
-    item->value = parse_array_jsons(*s, nums);
-  else if (type >= json_Ints && type <= json_Ints_end)
-    item->value = parse_array_ints(*s, nums);
-  else if (type >= json_Floats && type <= json_Floats_end)
-    item->value = parse_array_floats(*s, nums);
-  else if (type >= json_Bools && type <= json_Bools_end)
-    item->value = parse_array_bools(*s, nums);
-  else if (type == json_Mix)
-    item->value = parse_array_Mix(*s, nums);
-
-  item->value_type = type;
-  if (*str == ']')
-    *s = str + 1;
-  else
-    *s = str;
-  return;
+  col->len = rows;
+  if (!rows) {
+    col->value_type = json_Mix;
+    col->value.Mix = NULL;
+    return true;
+  }
+  if (kind == json_Strings || kind == json_Jsons) {
+    char **strs = arena_alloc(doc, sizeof(char *) * (rows + 1));
+    if (!strs)
+      return false;
+    for (size_t i = 0; i < rows; i++)
+      strs[i] = c->vals[i].value_type == json_Null ? NULL
+                                                   : c->vals[i].value.String;
+    strs[rows] = NULL;
+    col->value_type = kind;
+    col->value.Strings = strs;
+  } else if (kind == json_Ints) {
+    long *ints = arena_alloc(doc, sizeof(long) * rows);
+    if (!ints)
+      return false;
+    for (size_t i = 0; i < rows; i++)
+      ints[i] = c->vals[i].value_type == json_Null ? 0 : c->vals[i].value.Int;
+    col->value_type = json_Ints + rows;
+    col->value.Ints = ints;
+  } else if (kind == json_Floats) {
+    double *floats = arena_alloc(doc, sizeof(double) * rows);
+    if (!floats)
+      return false;
+    for (size_t i = 0; i < rows; i++)
+      floats[i] =
+          c->vals[i].value_type == json_Null ? 0 : c->vals[i].value.Float;
+    col->value_type = json_Floats + rows;
+    col->value.Floats = floats;
+  } else if (kind == json_Bools) {
+    bool *bools = arena_alloc(doc, sizeof(bool) * rows);
+    if (!bools)
+      return false;
+    for (size_t i = 0; i < rows; i++)
+      bools[i] = c->vals[i].value_type != json_Null && c->vals[i].value.Bool;
+    col->value_type = json_Bools + rows;
+    col->value.Bools = bools;
+  } else {
+    json *mix = arena_alloc(doc, sizeof(json) * rows);
+    if (!mix)
+      return false;
+    memcpy(mix, c->vals, sizeof(json) * rows);
+    for (size_t i = 0; i < rows; i++)
+      mix[i].next = i + 1 < rows ? &mix[i + 1] : NULL;
+    col->value_type = json_Mix;
+    col->value.Mix = mix;
+  }
+  return true;
 }
 
 /**
- * @brief 从字符串中解析json
+ * @brief 由构建中的各列生成结果，结果位于文档中
  *
- * @param s
- * @return json* 返回解析后的根节点
- * 若失败返回NULL
+ * @return json_columns* 失败返回NULL
  */
-json *json_parse(char *s) {
-  char *str = s;
-  str = skip(str);
-  if (*str != '{')
+static json_columns *columns_finish(json_doc *doc, struct columns_build *b,
+                                    size_t rows) {
+  // 行数记录在各列的len中
+  if (rows > UINT_MAX)
     return NULL;
-  json *ret = json_create();
-  if (!ret)
+  json_columns *ret = arena_alloc(doc, sizeof(json_columns));
+  json *cols = arena_alloc(doc, sizeof(json) * b->nums);
+  uint64_t **valid = arena_alloc(doc, sizeof(uint64_t *) * b->nums);
+  if (!ret || !cols || !valid)
     return NULL;
-  ret->key = NULL;
-  ret->next = NULL;
-  ret->value_type = json_Json;
-  ret->value.Json = parse_object(&str);
+  for (size_t i = 0; i < b->nums; i++) {
+    if (!column_finish(doc, &b->cols[i], rows, &cols[i], &valid[i]))
+      return NULL;
+    cols[i].key = b->cols[i].key;
+    cols[i].next = i + 1 < b->nums ? &cols[i + 1] : NULL;
+  }
+  ret->rows = rows;
+  ret->nums = b->nums;
+  ret->cols = b->nums ? cols : NULL;
+  ret->valid = valid;
+  ret->doc = doc;
   return ret;
 }
 
 /**
- * @brief 释放json树的内存
+ * @brief 开始构建，给定key时按顺序建立各列
  *
- * @param root json树的根节点
+ * @return bool 失败返回false
  */
-void json_free(json *root) {
-  json *next = root;
-  while (next) {
-    // 释放key
-    free(next->key);
-
-    // 释放value
-    if (next->value_type == json_String) {
-      free(next->value.String);
-    } else if (next->value_type == json_Json) {
-      json_free(next->value.Json);
-    } else if (next->value_type >= json_Ints &&
-               next->value_type <= json_Ints_end) {
-      free(next->value.Ints);
-    } else if (next->value_type >= json_Floats &&
-               next->value_type <= json_Floats_end) {
-      free(next->value.Floats);
-    } else if (next->value_type >= json_Bools &&
-               next->value_type <= json_Bools_end) {
-      free(next->value.Bools);
-    } else if (next->value_type == json_Strings) {
-      for (size_t i = 0; next->value.Strings[i]; i++)
-        free(next->value.Strings[i]);
-      free(next->value.Strings);
-    } else if (next->value_type == json_Jsons) {
-      for (size_t i = 0; next->value.Jsons[i]; i++)
-        json_free(next->value.Jsons[i]);
-      free(next->value.Jsons);
-    } else if (next->value_type == json_Mix) {
-      json_free(next->value.Mix);
-    }
-
-    // 并释放本节点
-    json *temp = next;
-    next = next->next;
-    free(temp);
-  }
+static bool columns_init(struct columns_build *b, json_doc *doc,
+                         const char *const *keys, size_t nums) {
+  b->fixed = keys != NULL;
+  for (size_t i = 0; keys && i < nums; i++)
+    if (columns_add(b, doc, keys[i], strlen(keys[i])) == SIZE_MAX)
+      return false;
+  return true;
 }
 
 /**
- * @brief 根据key描述该返回值，并通过type告知该值的类型
+ * @brief 将数组中的对象按key转置为列
  *
- * @param key 跳转描述，从key指向字符开始到SPLIT或'\0'结束
- * 描述规则：
- *   - 当key第一个字符为SPLIT时
- *     - 如果为 null，bool，number，string，返回该值。
- *     - 如果为 json 返回第一个值
- *     - 如果为 array 返回第一个元素
- *   - 当base值类型为 json 时，按key到SPLIT或`\0`中的字符串查找值并返回
- *   - 当base值类型为 array 时，
- * 按key到SPLIT或`\0`的字符串atoi(十进制)为数字n并返回第n+1个元素
- * @param base 跳转的基点，从value开始搜索
- * @param type 修改为该返回值的类型
- * @return union
+ * 值为浅复制，字符串与嵌套的对象仍指向原来的树，需在原树释放前使用
+ *
+ * @param array 值为 Jsons 或元素为对象的 Mix 的节点，
+ * 其他元素视为没有成员的记录
+ * @param keys 投影的key，为NULL时为所有出现过的key，按第一次出现的顺序
+ * @param nums keys的个数
+ * @return json_columns* 由json_columns_free释放，失败返回NULL
  */
-static union json_value jump_value(char *key, json *base,
-                                   enum json_value_type *type) {
-  char *str = key;
-  union json_value ret;
-  if (*str == SPLIT) {
-    if (base->value_type == json_Null || base->value_type == json_Int ||
-        base->value_type == json_Float || base->value_type == json_Bool ||
-        base->value_type == json_String || base->value_type == json_Json) {
-      *type = base->value_type;
-      return base->value;
-    } else if (base->value_type == json_Mix) {
-      *type = base->value.Mix->value_type;
-      return base->value.Mix->value;
-    } else if (base->value_type == json_Strings) {
-      *type = json_String;
-      ret.String = base->value.Strings[0];
-      return ret;
-    } else if (base->value_type == json_Jsons) {
-      *type = json_Json;
-      ret.Json = base->value.Jsons[0];
-      return ret;
-    } else if (base->value_type >= json_Ints &&
-               base->value_type <= json_Ints_end) {
-      *type = json_Int;
-      ret.Int = base->value.Ints[0];
-      return ret;
-    } else if (base->value_type >= json_Floats &&
-               base->value_type <= json_Floats_end) {
-      *type = json_Float;
-      ret.Float = base->value.Floats[0];
-      return ret;
-    } else if (base->value_type >= json_Bools &&
-               base->value_type <= json_Bools_end) {
-      *type = json_Bool;
-      ret.Bool = base->value.Bools[0];
-      return ret;
+json_columns *json_columns_from(json *array, const char *const *keys,
+                                size_t nums) {
+  json_load(array);
+  if (!array ||
+      (array->value_type != json_Jsons && array->value_type != json_Mix))
+    return NULL;
+  size_t rows = array->len;
+  json_doc *doc = doc_new(rows * 16);
+  struct columns_build b = {NULL};
+  json_columns *ret = NULL;
+  if (!doc || !columns_init(&b, doc, keys, nums))
+    goto out;
+
+  for (size_t r = 0; r < rows; r++) {
+    json *first;
+    if (array->value_type == json_Jsons)
+      first = array->value.Jsons[r];
+    else
+      first = array->value.Mix[r].value_type == json_Json
+                  ? array->value.Mix[r].value.Json
+                  : NULL;
+    for (json *m = first; m; m = m->next) {
+      size_t i = columns_match(&b, doc, m->key, strlen(m->key));
+      if (i == SIZE_MAX) {
+        if (b.fixed)
+          continue;
+        goto out;
+      }
+      // 重复的key取第一个，与查找一致
+      if (b.cols[i].nums <= r && !column_set(&b.cols[i], r, json_load(m)))
+        goto out;
     }
   }
-  if (base->value_type == json_Json) {
-    json *next = base->value.Json;
-    size_t strn;
-    for (strn = 0; str[strn] != SPLIT && str[strn]; strn++)
+  ret = columns_finish(doc, &b, rows);
+out:
+  columns_release(&b);
+  if (!ret)
+    json_doc_free(doc);
+  return ret;
+}
+
+/**
+ * @brief 将一个对象的成员解析到各列中，不投影的值直接跳过
+ *
+ * @param s 从*s开始解析，确保**s为`{`，并修改*s指向对象结束的下一个字符
+ * @param row 行号
+ * @return bool 失败返回false
+ */
+static bool parse_record(struct parse_ctx *ctx, struct columns_build *b,
+                         char **s, size_t row) {
+  char *str = skip(*s + 1);
+  while (*str != '}') {
+    if (*str == ',') {
+      str = skip(str + 1);
       continue;
-  find:
-    while (strncmp(str, next->key, strn) && next != NULL)
-      next = next->next;
-    if (!next) {
-      JSON_NOT_FOUND_ERROR;
-    }
-    if (next->key[strn] != '\0') {
-      next = next->next;
-      goto find;
     }
-    *type = next->value_type;
-    return next->value;
-  }
-  if (base->value_type == json_Mix) {
-    int n = atoi(str);
-    if (n < 0) {
-      JSON_NOT_FOUND_ERROR;
-    }
-    json *next = base->value.Mix;
-    for (int i = n; i && next; i--)
-      next = next->next;
-    if (!next) {
-      JSON_NOT_FOUND_ERROR;
-    }
-    *type = next->value_type;
-    return next->value;
-  }
-  if (base->value_type == json_Strings) {
-    int n = atoi(str);
-    if (n < 0) {
-      JSON_NOT_FOUND_ERROR;
-    }
-    char **strs = base->value.Strings;
-    size_t i = 0;
-    while (strs[i])
-      i++;
-    if (n > i) {
-      JSON_NOT_FOUND_ERROR;
-    }
-    *type = json_String;
-    ret.String = strs[n];
-    return ret;
-  }
-  if (base->value_type == json_Jsons) {
-    int n = atoi(str);
-    if (n < 0) {
-      JSON_NOT_FOUND_ERROR;
-    }
-    json **jsons = base->value.Jsons;
-    size_t i = 0;
-    while (jsons[i]) {
-      i++;
+    if (*str != '"')
+      return false;
+
+    // 不含转义的key直接与列名比较，不复制
+    char *end = str_end(str + 1);
+    if (!end)
+      return false;
+    char *key = str + 1;
+    size_t len = end - key;
+    if (memchr(key, '\\', len)) {
+      if (!(key = parse_str(ctx, &str)))
+        return false;
+      len = strlen(key);
+    } else {
+      str = end + 1;
     }
-    if (n > i) {
-      JSON_NOT_FOUND_ERROR;
+    str = skip(str);
+    if (*str != ':')
+      return false;
+    str = skip(str + 1);
+
+    size_t i = columns_match(b, ctx->doc, key, len);
+    if (i == SIZE_MAX && !b->fixed)
+      return false;
+    if (i == SIZE_MAX || b->cols[i].nums > row) {
+      char *next = skip_value(ctx->doc, str);
+      if (next == str)
+        return false;
+      str = next;
+    } else {
+      json val = {NULL};
+      if (!parse_value(ctx, &str, &val) || !column_set(&b->cols[i], row, &val))
+        return false;
     }
-    *type = json_Json;
-    ret.Json = jsons[n];
-    return ret;
+    str = skip(str);
   }
-  *type = json_Null;
-  return ret;
+  *s = str + 1;
+  return true;
 }
 
 /**
- * @brief 根据key的描述返回该节点
- * 操作对象为 json
+ * @brief 将对象的数组直接解析为列，不为每个记录建立节点
  *
- * @param key 跳转描述，从key指向字符开始到SPLIT或'\0'结束
- * - 当base值类型为 json 时，按key到SPLIT或`\0`中的字符串查找值并返回
- * - 若str指向 SPLIT 则返回第一个json节点
- * @param base 跳转基点，从value开始搜索
- * @return json* key匹配的json节点
+ * 投影的值解析到列中，其余的值只跳过。
+ * 类型与null的规则与json_columns_from相同
+ *
+ * @param s 以'\0'结尾的输入，根值为元素均为对象的数组
+ * @param keys 投影的key，为NULL时为所有出现过的key，按第一次出现的顺序
+ * @param nums keys的个数
+ * @param flags JSON_INSITU, JSON_INTERN 与 JSON_INTERN_STRINGS 的组合
+ * @return json_columns* 由json_columns_free释放，失败返回NULL
  */
-static json *jump(char *key, json *base) {
-  char *str = key;
-  if (*str == SPLIT || *str == '\0') {
-    if (base->value_type == json_Json) {
-      return base->value.Json;
-    }
-  }
-  if (base->value_type == json_Json) {
-    json *next = base->value.Json;
-    size_t strn;
-    for (strn = 0; str[strn] != SPLIT && str[strn]; strn++)
+json_columns *json_columns_parse(char *s, const char *const *keys,
+                                 size_t nums, int flags) {
+  // 只保存投影的列，首块较小，不足时按两倍增长
+  json_doc *doc = doc_new(strlen(s) / 8);
+  struct parse_ctx ctx = {
+      .doc = doc,
+      .flags = flags & (JSON_INSITU | JSON_INTERN | JSON_INTERN_STRINGS)};
+  struct columns_build b = {NULL};
+  json_columns *ret = NULL;
+  if (!doc || !columns_init(&b, doc, keys, nums))
+    goto out;
+
+  char *str = skip(s);
+  if (*str != '[')
+    goto out;
+  str = skip(str + 1);
+  size_t rows = 0;
+  while (*str != ']') {
+    if (*str == ',') {
+      str = skip(str + 1);
       continue;
-  find:
-    while (strncmp(str, next->key, strn) && next != NULL)
-      next = next->next;
-    if (!next) {
-      JSON_NOT_FOUND_ERROR;
     }
-    if (next->key[strn] != '\0') {
-      next = next->next;
-      goto find;
-    }
-    return next;
+    if (*str != '{' || !parse_record(&ctx, &b, &str, rows))
+      goto out;
+    rows++;
+    str = skip(str);
   }
-  JSON_NOT_FOUND_ERROR;
-  return NULL;
+  ret = columns_finish(doc, &b, rows);
+out:
+  columns_release(&b);
+  ctx_release(&ctx);
+  if (!ret)
+    json_doc_free(doc);
+  return ret;
 }
 
 /**
- * @brief 根据key返回对应的字符串
+ * @brief 释放列
  *
- * @param key 键
- * @param base 待操作json树
- * @return char* 返回key对应的字符串
+ * @param c 可以为NULL
  */
-char *json_read_str(char *key, json *base) {
-  char *str = key;
-  json *item = NULL;
-  size_t strn;
-  for (strn = 0; str[strn] != SPLIT && str[strn]; strn++)
-    continue;
-  if (base->value_type == json_Json) {
-    item = jump(key, base);
-  } else if (base->value_type == json_Jsons) {
-    int n = atoi(str);
-    if (n < 0) {
-      JSON_NOT_FOUND_ERROR;
-    }
-    json **items = base->value.Jsons;
-    size_t i = 0;
-    while (items[i])
-      i++;
-    if (n >= i) {
-      JSON_NOT_FOUND_ERROR;
-    }
-    item = base->value.Jsons[n];
-    str = str + strn + 1;
-    return json_read_str(str, item);
-  } else {
-    return NULL;
-  }
-  if (str[strn])
-    return json_read_str(str + strn + 1, item);
-  else
-    return item->value.String;
-}
\ No newline at end of file
+void json_columns_free(json_columns *c) {
+  if (c)
+    json_doc_free(c->doc);
+}
@@ -1,6 +1,10 @@
 #ifndef _JSON_H_
 #define _JSON_H_
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #define SPLIT ':'
 
 #define JSON_NOT_FOUND_ERROR
@@ -10,10 +14,15 @@
  *
  * Json 值为指向json结构体的指针，可理解为子对象
  *
- * Mix 为混合列表，值为json指针，但key无意义
+ * Mix 为混合列表，值为连续储存的json节点数组，节点间同时以next链接，
+ * 但key无意义
+ *
+ * Strings 值为字符串指针数组，Jsons 值为json结构体指针的数组，
+ * 元素个数为len，数组末尾另有一个NULL；
+ * json_columns 的列中可能含有NULL元素，遍历时以len为准
  *
- * Strings 值为字符串指针数组，数组末尾为NULL
- * Jsons 值为json结构体指针的数组，数组末尾为NULL
+ * Lazy 为 JSON_LAZY 文档中尚未解析的值，值为所属文档，
+ * len 为值在原文中的偏移，由json_load解析
  *
  * json_value_type 在Ints和Ints_end之间的为整数数组
  * json_value_type - Ints 代表数组长度
@@ -29,6 +38,7 @@ enum json_value_type {
   json_Mix,
   json_Strings,
   json_Jsons,
+  json_Lazy,
   json_Ints,
   json_Ints_end = 0x10000000,
   json_Floats,
@@ -53,6 +63,7 @@ union json_value {
   long *Ints;
   double *Floats;
   bool *Bools;
+  struct json_doc *Doc;
 };
 
 /**
@@ -62,11 +73,79 @@ union json_value {
 struct json {
   struct json *next;
   enum json_value_type value_type;
+  // 值为数组时的元素个数，延迟的值为原文中的偏移；
+  // 值不是数组时高3位为解析器对成员节点的标记，手动建立的节点为0
+  unsigned int len;
   union json_value value;
   char *key;
 };
 typedef struct json json;
 
+/**
+ * @brief json_doc_parse 的解析选项
+ *
+ * JSON_INSITU 将key和字符串原地解码在输入缓冲区中，树中的字符串
+ * 直接指向输入，输入缓冲区需在文档释放前保持有效
+ *
+ * JSON_PADDED 用于json_parse_n，调用者保证buf[len]可读，
+ * 其为'\0'时以其为哨兵解析，否则按长度解析
+ *
+ * JSON_LAZY 对象的成员只解析key，值只记录在原文中的位置，
+ * 第一次被查找时才解析，未访问的子树由结构索引直接跳过；
+ * 含有注释或括号不匹配时按普通方式解析。
+ * 输入需在文档释放前保持有效；读取会修改文档，不能多线程同时读取
+ *
+ * JSON_PARALLEL 较大的数组(1MiB以上)的元素划分后由线程池并行解析，
+ * 线程数为CPU核数，结果与顺序解析相同；JSON_THREADS(n) 指定线程数。
+ * 含有注释的输入和 JSON_LAZY 延迟的值按顺序解析
+ *
+ * JSON_INTERN 驻留对象的key，文档中相同的key共用一份，
+ * 用于大量结构相同的对象；JSON_INTERN_STRINGS 同时驻留不长于16字节的
+ * 字符串值。json_doc_intern 返回的key在查找时直接比较指针
+ *
+ * JSON_STRICT 输入必须为合法的utf8，转义必须合法，`\u`的代理项必须成对，
+ * 否则解析失败。ASCII的部分按块跳过，开销接近复制输入
+ */
+enum json_parse_flag {
+  JSON_INSITU = 1,
+  JSON_PADDED = 2,
+  JSON_LAZY = 4,
+  JSON_PARALLEL = 8,
+  JSON_INTERN = 16,
+  JSON_INTERN_STRINGS = 32,
+  JSON_STRICT = 64,
+};
+
+// 以n个线程并行解析，n记录在flags的8到15位，不大于0时为CPU核数
+#define JSON_THREADS(n) (JSON_PARALLEL | ((n) & 0xFF) << 8)
+
+/**
+ * @brief json_dump 的输出选项
+ *
+ * JSON_PRETTY 每个成员与元素单独一行，每层缩进两个空格
+ */
+enum json_dump_flag {
+  JSON_PRETTY = 1,
+};
+
+/**
+ * @brief json文档
+ *
+ * 文档中的节点、key、字符串和数组均从arena的大块内存中切分，
+ * 不能对其中的节点调用json_free，应使用json_doc_free整体释放
+ */
+struct json_doc {
+  json *root;                 // 根节点
+  struct json_block *block;   // arena内存块链表，首个为当前块
+  void *input;                // json_parse_file 原地解析时的输入
+  size_t input_map;           // input 的映射长度，为0时由malloc申请
+  char *text;                 // JSON_LAZY 时的原文
+  int flags;                  // 解析选项
+  struct json_tokens *tokens; // JSON_LAZY 时的结构索引，为NULL时逐字节匹配
+  struct json_intern *intern; // JSON_INTERN 时的字符串驻留表
+};
+typedef struct json_doc json_doc;
+
 /**
  * @brief 从字符串中解析json
  *
@@ -83,4 +162,495 @@ json *json_parse(char *s);
  */
 void json_free(json *root);
 
+/**
+ * @brief 从字符串中解析json文档，所有节点与字符串由文档的arena分配
+ *
+ * @param s
+ * @param flags enum json_parse_flag 的组合
+ * @return json_doc* 返回解析后的文档，根节点为doc->root
+ * 若失败返回NULL
+ */
+json_doc *json_doc_parse(char *s, int flags);
+
+/**
+ * @brief 释放json文档，一次性归还arena中的所有内存块
+ *
+ * @param doc 由json_doc_parse返回的文档
+ */
+void json_doc_free(json_doc *doc);
+
+/**
+ * @brief 查找文档中驻留的字符串
+ *
+ * 以返回值作为key查找成员时先比较指针，不需要逐字节比较
+ *
+ * @param doc 以 JSON_INTERN 解析的文档
+ * @param str 以'\0'结尾
+ * @return char* 文档中与str相同的驻留字符串，没有时返回NULL
+ */
+char *json_doc_intern(const json_doc *doc, const char *str);
+
+/**
+ * @brief 可复用的解析上下文
+ *
+ * 同一线程依次解析大量文档时使用，arena与临时栈在两次解析之间保留，
+ * 稳定后解析不再申请内存。每次解析或重置后上一次的文档失效，
+ * 不能多线程同时使用
+ */
+typedef struct json_parser_ctx json_parser_ctx;
+
+/**
+ * @brief 创建可复用的解析上下文
+ *
+ * @return json_parser_ctx* 由json_ctx_free释放，失败返回NULL
+ */
+json_parser_ctx *json_ctx_new(void);
+
+/**
+ * @brief 使用上下文解析json文档
+ *
+ * @param c 解析上下文
+ * @param s 输入，以'\0'结尾
+ * @param flags enum json_parse_flag 的组合
+ * @return json_doc* 属于上下文，在下一次解析或重置前有效，
+ * 不能用json_doc_free释放，失败返回NULL
+ */
+json_doc *json_ctx_parse(json_parser_ctx *c, char *s, int flags);
+
+/**
+ * @brief 重置上下文，上一次解析的文档失效，内存保留给下一次解析
+ *
+ * @param c 解析上下文
+ */
+void json_ctx_reset(json_parser_ctx *c);
+
+/**
+ * @brief 归还上下文保留的内存，用于空闲时
+ *
+ * @param c 解析上下文
+ */
+void json_ctx_shrink(json_parser_ctx *c);
+
+/**
+ * @brief 释放解析上下文
+ *
+ * @param c 解析上下文，可以为NULL
+ */
+void json_ctx_free(json_parser_ctx *c);
+
+/**
+ * @brief 确保节点的值已解析
+ *
+ * JSON_LAZY 文档中直接访问value之前需要调用，
+ * json_read_str, json_path_get 等查找函数会自动调用
+ *
+ * @param item 节点，可以为NULL
+ * @return json* 返回item
+ */
+json *json_load(json *item);
+
+/**
+ * @brief 从文件中解析json文档
+ *
+ * 普通文件映射到内存后直接解析，JSON_INSITU 时在写入时复制的私有映射上
+ * 原地解码，不会修改文件；管道等无法映射的输入以大块读取
+ *
+ * @param path 文件路径
+ * @param flags enum json_parse_flag 的组合
+ * @return json_doc* 返回解析后的文档，由json_doc_free释放
+ * 若失败返回NULL
+ */
+json_doc *json_parse_file(const char *path, int flags);
+
+/**
+ * @brief 从长度为len的缓冲区中解析json，缓冲区不需要以'\0'结尾
+ *
+ * 按长度解析时不读取buf[len]及之后的内存，可直接解析内存映射的文件
+ * 或网络帧中的一段
+ *
+ * @param buf 输入缓冲区，不会被修改
+ * @param len 输入长度
+ * @param flags 只支持 JSON_PADDED
+ * @return json* 返回解析后的根节点，由json_free释放
+ * 若失败返回NULL
+ */
+json *json_parse_n(const char *buf, size_t len, int flags);
+
+/**
+ * @brief 从长度为len的缓冲区中解析json文档，缓冲区不需要以'\0'结尾
+ *
+ * JSON_LAZY 与 JSON_PARALLEL 只在以'\0'为哨兵(JSON_PADDED)解析时有效，
+ * JSON_INTERN, JSON_INTERN_STRINGS 与 JSON_STRICT 总是有效
+ *
+ * @param buf 输入缓冲区，不会被修改，因此忽略 JSON_INSITU
+ * @param len 输入长度
+ * @param flags enum json_parse_flag 的组合
+ * @return json_doc* 返回解析后的文档，若失败返回NULL
+ */
+json_doc *json_doc_parse_n(const char *buf, size_t len, int flags);
+
+/**
+ * @brief 并行解析以换行分隔的多条json记录（NDJSON / JSON Lines）
+ *
+ * 记录以换行分隔，有误的记录不影响之后的记录，每条记录解析为独立的文档，
+ * 由线程池并行解析后按输入顺序交给fn
+ *
+ * @param buf 输入缓冲区，不需要以'\0'结尾
+ * @param len 输入长度
+ * @param threads 线程数，不大于0时为CPU核数
+ * @param fn 按输入顺序对每条记录调用，fn(arg, index, doc)，
+ * doc 由fn负责以json_doc_free释放，解析失败时为NULL
+ * @param arg 传给fn
+ * @return size_t 记录数，只含空白的行不计入
+ */
+size_t json_parse_lines(const char *buf, size_t len, int threads,
+                        void (*fn)(void *arg, size_t index, json_doc *doc),
+                        void *arg);
+
+/**
+ * @brief 增量解析器，可以分块输入数据
+ */
+typedef struct json_parser json_parser;
+
+/**
+ * @brief 创建增量解析器
+ *
+ * @return json_parser* 失败返回NULL
+ */
+json_parser *json_parser_new(void);
+
+/**
+ * @brief 向增量解析器输入一块数据
+ *
+ * 数据块可以在任意位置分割，包括字符串、转义、数字和注释的中间，
+ * 只有跨越数据块的记号会被复制
+ *
+ * @param p 增量解析器
+ * @param buf 数据块，不需要以'\0'结尾
+ * @param len 数据块的长度
+ * @return bool 出现语法错误时返回false，之后的输入均被忽略
+ */
+bool json_parser_feed(json_parser *p, const char *buf, size_t len);
+
+/**
+ * @brief 结束输入，返回解析结果并释放增量解析器
+ *
+ * @param p 增量解析器
+ * @return json* 与json_parse相同的树，由json_free释放，
+ * 输入不完整或有语法错误时返回NULL
+ */
+json *json_parser_finish(json_parser *p);
+
+/**
+ * @brief 将json树序列化为字符串
+ *
+ * 浮点数输出为能精确还原的最短形式，并总带有`.`或`e`
+ *
+ * @param item 序列化该节点的值，通常为根节点
+ * @param flags enum json_dump_flag 的组合
+ * @return char* 由malloc申请，以'\0'结尾，失败返回NULL
+ */
+char *json_dump(const json *item, int flags);
+
+/**
+ * @brief 将json树序列化到调用者提供的缓冲区
+ *
+ * @param buf 输出缓冲区
+ * @param cap 缓冲区大小
+ * @param item 序列化该节点的值，通常为根节点
+ * @param flags enum json_dump_flag 的组合
+ * @return size_t 结果的长度，不含'\0'；不小于cap时未写入
+ */
+size_t json_dump_into(char *buf, size_t cap, const json *item, int flags);
+
+/**
+ * @brief 流式写入器，不需要构建json树即可输出
+ *
+ * 输出写入固定大小的内部缓冲区，满时交给回调或文件描述符，
+ * 内存占用与输出大小无关。嵌套关系由内部的栈检查，
+ * 任何调用出错后之后的调用均返回false
+ */
+typedef struct json_writer json_writer;
+
+/**
+ * @brief 创建写入到回调的写入器
+ *
+ * @param flush 缓冲区满或结束时调用，flush(arg, buf, len)，失败返回false
+ * @param arg 传给flush
+ * @param flags enum json_dump_flag 的组合
+ * @return json_writer* 失败返回NULL
+ */
+json_writer *json_writer_new(bool (*flush)(void *arg, const char *buf,
+                                           size_t len),
+                             void *arg, int flags);
+
+/**
+ * @brief 创建写入到文件描述符的写入器
+ *
+ * @param fd 已打开的文件描述符，不会被关闭
+ * @param flags enum json_dump_flag 的组合
+ * @return json_writer* 失败返回NULL
+ */
+json_writer *json_writer_new_fd(int fd, int flags);
+
+bool json_writer_begin_object(json_writer *w);
+bool json_writer_end_object(json_writer *w);
+bool json_writer_begin_array(json_writer *w);
+bool json_writer_end_array(json_writer *w);
+
+/**
+ * @brief 写入对象的key，之后必须写入一个值
+ *
+ * @return bool 不在对象中、上一个key没有值或写入失败时返回false
+ */
+bool json_writer_key(json_writer *w, const char *key);
+
+bool json_writer_int(json_writer *w, long v);
+
+/**
+ * @brief 写入浮点数，格式与json_dump相同
+ */
+bool json_writer_double(json_writer *w, double v);
+
+bool json_writer_bool(json_writer *w, bool v);
+bool json_writer_null(json_writer *w);
+
+/**
+ * @brief 写入字符串，NULL 写为null
+ */
+bool json_writer_string(json_writer *w, const char *str);
+
+/**
+ * @brief 写入json树中节点的值，与json_dump使用相同的序列化
+ */
+bool json_writer_value(json_writer *w, const json *item);
+
+/**
+ * @brief 写入剩余的输出并释放写入器
+ *
+ * @return bool 所有写入均成功且根值已完整结束时返回true
+ */
+bool json_writer_finish(json_writer *w);
+
+/**
+ * @brief json_sax_parse 的事件回调
+ *
+ * 回调可以为NULL，返回false时停止扫描。
+ * key 和 string 交出输入中两端`"`之间的原文，escaped 为其中是否含有转义，
+ * 需要时由json_sax_unescape解码。
+ * number 不为NULL时交出数字的原文，否则转换后交给integer或real
+ */
+struct json_sax_handler {
+  bool (*start_object)(void *arg);
+  bool (*end_object)(void *arg);
+  bool (*start_array)(void *arg);
+  bool (*end_array)(void *arg);
+  bool (*key)(void *arg, const char *str, size_t len, bool escaped);
+  bool (*string)(void *arg, const char *str, size_t len, bool escaped);
+  bool (*number)(void *arg, const char *str, size_t len);
+  bool (*integer)(void *arg, long v);
+  bool (*real)(void *arg, double v);
+  bool (*boolean)(void *arg, bool v);
+  bool (*null)(void *arg);
+};
+
+/**
+ * @brief 以事件的方式扫描json，不构建json树，不申请内存
+ *
+ * @param s 以'\0'结尾的输入，根值可以是任意类型
+ * @param h 事件回调
+ * @param arg 传给每个回调
+ * @return bool 扫描完整个值时返回true，语法错误或被回调停止时返回false
+ */
+bool json_sax_parse(const char *s, const struct json_sax_handler *h,
+                    void *arg);
+
+/**
+ * @brief 解码string或key事件中的字符串
+ *
+ * @param out 至少有len + 1字节，写入以'\0'结尾的结果
+ * @param str 事件中的字符串，必须仍指向原输入
+ * @param len 事件中的长度
+ * @return size_t 解码后的长度，不含'\0'
+ */
+size_t json_sax_unescape(char *out, const char *str, size_t len);
+
+/**
+ * @brief 编译后的路径，可对不同的json树重复使用
+ */
+typedef struct json_path json_path;
+
+/**
+ * @brief 编译路径
+ *
+ * @param path 以SPLIT分隔的路径，规则与json_read_str相同，
+ * 空字符串表示基点本身
+ * @return json_path* 由json_path_free释放，失败返回NULL
+ */
+json_path *json_path_compile(const char *path);
+
+/**
+ * @brief 释放编译后的路径
+ *
+ * @param path
+ */
+void json_path_free(json_path *path);
+
+/**
+ * @brief 按编译后的路径取值
+ *
+ * 对象按key查找，数组按下标查找
+ *
+ * @param path 编译后的路径
+ * @param base 跳转的基点，从value开始搜索
+ * @param type 修改为该值的类型
+ * @param value 修改为该值
+ * @return bool 未找到时返回false
+ */
+bool json_path_get(const json_path *path, json *base,
+                   enum json_value_type *type, union json_value *value);
+
+/**
+ * @brief 按编译后的路径取字符串
+ *
+ * @return char* 未找到或不是字符串时返回NULL
+ */
+char *json_path_get_str(const json_path *path, json *base);
+
+/**
+ * @brief 按编译后的路径取整数
+ *
+ * @param out 修改为该整数
+ * @return bool 未找到或不是整数时返回false
+ */
+bool json_path_get_int(const json_path *path, json *base, long *out);
+
+/**
+ * @brief 按编译后的路径取浮点数，整数会被转换为浮点数
+ *
+ * @param out 修改为该浮点数
+ * @return bool 未找到或不是数字时返回false
+ */
+bool json_path_get_float(const json_path *path, json *base, double *out);
+
+/**
+ * @brief 按编译后的路径取布尔值
+ *
+ * @param out 修改为该布尔值
+ * @return bool 未找到或不是布尔值时返回false
+ */
+bool json_path_get_bool(const json_path *path, json *base, bool *out);
+
+/**
+ * @brief 按编译后的路径取对象
+ *
+ * @return json* 对象的首个成员节点，未找到、不是对象或对象为空时返回NULL
+ */
+json *json_path_get_json(const json_path *path, json *base);
+
+/**
+ * @brief 扁平的文档
+ *
+ * 整个文档为一段连续的64位字，容器记录对应结尾的位置，
+ * 跳过子树只需一步，遍历和序列化为顺序的内存访问。
+ * 字符串解码后储存在单独的缓冲区中
+ */
+typedef struct json_tape json_tape;
+
+/**
+ * @brief 解析为tape
+ *
+ * @param s 以'\0'结尾的输入，根值可以是任意类型
+ * @return json_tape* 由json_tape_free释放，失败返回NULL
+ */
+json_tape *json_tape_parse(const char *s);
+
+/**
+ * @brief 释放tape
+ *
+ * @param t 可以为NULL
+ */
+void json_tape_free(json_tape *t);
+
+/**
+ * @brief 按编译后的路径在tape中取值
+ *
+ * @param path 编译后的路径
+ * @param t tape，从根值开始搜索
+ * @param type 修改为该值的类型，对象为 json_Json，数组为 json_Mix
+ * @param value 修改为该值，对象和数组为其在tape中的下标
+ * @return bool 未找到时返回false
+ */
+bool json_tape_path_get(const json_path *path, const json_tape *t,
+                        enum json_value_type *type, union json_value *value);
+
+/**
+ * @brief 在tape中读取字符串，路径规则与json_read_str相同
+ *
+ * @return char* 未找到或不是字符串时返回NULL
+ */
+char *json_tape_read_str(char *key, const json_tape *t);
+
+/**
+ * @brief 将tape序列化为字符串，输出与json_dump相同
+ *
+ * @param flags enum json_dump_flag 的组合
+ * @return char* 由malloc申请，以'\0'结尾，失败返回NULL
+ */
+char *json_tape_dump(const json_tape *t, int flags);
+
+/**
+ * @brief 按key转置的对象数组
+ *
+ * cols 为各列，key为列名，值为类型化数组，len为行数，
+ * 各列以next链接，可作为对象的成员访问：
+ * 以value_type为json_Json、value.Json为cols的节点作为查找的基点。
+ * 除null外的值类型相同时为 Ints, Floats, Bools, Strings 或 Jsons，
+ * null 和缺少的行为0, false 或 NULL；否则为Mix，缺少的行为null节点。
+ * Strings 与 Jsons 中可能含有NULL，以len为准
+ *
+ * valid[i] 为第i列的位图，第j行有非null的值时
+ * valid[i][j / 64] 的第 j % 64 位(即 (uint64_t)1 << (j % 64))为1
+ */
+struct json_columns {
+  size_t rows;      // 行数，即记录个数
+  size_t nums;      // 列数
+  json *cols;       // 各列
+  uint64_t **valid; // 各列的位图
+  json_doc *doc;    // 列的内存
+};
+typedef struct json_columns json_columns;
+
+/**
+ * @brief 将数组中的对象按key转置为列
+ *
+ * 值为浅复制，字符串与嵌套的对象仍指向原来的树，需在原树释放前使用
+ *
+ * @param array 值为 Jsons 或元素为对象的 Mix 的节点
+ * @param keys 投影的key，为NULL时为所有出现过的key，按第一次出现的顺序
+ * @param nums keys的个数
+ * @return json_columns* 由json_columns_free释放，失败返回NULL
+ */
+json_columns *json_columns_from(json *array, const char *const *keys,
+                                size_t nums);
+
+/**
+ * @brief 将对象的数组直接解析为列，不为每个记录建立节点
+ *
+ * @param s 以'\0'结尾的输入，根值为元素均为对象的数组
+ * @param keys 投影的key，为NULL时为所有出现过的key，其余的值只跳过
+ * @param nums keys的个数
+ * @param flags JSON_INSITU, JSON_INTERN 与 JSON_INTERN_STRINGS 的组合
+ * @return json_columns* 由json_columns_free释放，失败返回NULL
+ */
+json_columns *json_columns_parse(char *s, const char *const *keys,
+                                 size_t nums, int flags);
+
+/**
+ * @brief 释放列
+ *
+ * @param c 可以为NULL
+ */
+void json_columns_free(json_columns *c);
+
 #endif
\ No newline at end of file
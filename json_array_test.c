@@ -0,0 +1,129 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief 检查混合数组的节点：next依次链接，key为NULL，非数组的len为0
+ *
+ * @return bool 有误时返回false
+ */
+static bool check_mix(const json *item) {
+  if (item->value_type != json_Mix)
+    return true;
+  for (unsigned int i = 0; i < item->len; i++) {
+    const json *node = &item->value.Mix[i];
+    if (node->key || node->next != (i + 1 < item->len ? node + 1 : NULL))
+      return false;
+    enum json_value_type t = node->value_type;
+    if ((t == json_Null || t == json_Int || t == json_Float ||
+         t == json_Bool || t == json_String || t == json_Json) &&
+        node->len)
+      return false;
+    if (!check_mix(node))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * @brief 以三种方式解析数组，检查类型与序列化的结果
+ *
+ * @param array 不含空白的数组
+ * @param type 期望的数组类型
+ * @return int 失败的个数
+ */
+static int check(const char *array, enum json_value_type type) {
+  size_t len = strlen(array);
+  char *s = malloc(len + 16);
+  sprintf(s, "{\"a\":%s}", array);
+  json *trees[3];
+  trees[0] = json_parse(s);
+  json_doc *doc = json_doc_parse(s, 0);
+  trees[1] = doc ? doc->root : NULL;
+  json_parser *p = json_parser_new();
+  json_parser_feed(p, s, len / 2 + 3);
+  json_parser_feed(p, s + len / 2 + 3, strlen(s) - len / 2 - 3);
+  trees[2] = json_parser_finish(p);
+
+  int failed = 0;
+  for (int i = 0; i < 3; i++) {
+    json *a = trees[i] ? trees[i]->value.Json : NULL;
+    char *dump = trees[i] ? json_dump(trees[i], 0) : NULL;
+    if (!a || a->value_type != type || !check_mix(a) || !dump ||
+        strcmp(dump, s)) {
+      printf("%s (%d): type %x, %s\n", array, i, a ? a->value_type : 0,
+             dump ? dump : "(null)");
+      failed++;
+    }
+    free(dump);
+  }
+  json_free(trees[0]);
+  json_doc_free(doc);
+  json_free(trees[2]);
+  free(s);
+  return failed;
+}
+
+/**
+ * @brief 测试数组的类型推断与类型冲突时转为混合数组
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  int failed = 0;
+
+  // 同类型数组
+  failed += check("[1,2,3]", json_Ints + 3);
+  failed += check("[1.5,-2.5]", json_Floats + 2);
+  failed += check("[true,false]", json_Bools + 2);
+  failed += check("[\"a\",\"b\"]", json_Strings);
+  failed += check("[{\"x\":1},{\"y\":[2]}]", json_Jsons);
+
+  // 空数组与null
+  failed += check("[]", json_Mix);
+  failed += check("[null]", json_Mix);
+  failed += check("[null,null,null]", json_Mix);
+  failed += check("[null,1,2]", json_Mix);
+  failed += check("[{},{}]", json_Mix);
+  failed += check("[\"a\",{\"x\":1}]", json_Mix);
+
+  // 若干个同类型元素之后类型改变
+  failed += check("[1,2,3,\"x\"]", json_Mix);
+  failed += check("[1,2,1.5]", json_Mix);
+  failed += check("[1.5,2.5,true,null]", json_Mix);
+  failed += check("[true,false,0]", json_Mix);
+  failed += check("[\"a\",\"b\",null,\"c\"]", json_Mix);
+  failed += check("[{\"x\":1},{\"y\":2},3,{\"z\":4}]", json_Mix);
+
+  // 嵌套的数组，内外层各自转换
+  failed += check("[[1,2],[3],[4,5,6]]", json_Mix);
+  failed += check("[1,2,[3,4],5]", json_Mix);
+  failed += check("[[1,[2,\"x\"]],[true,[null]],[]]", json_Mix);
+  failed += check("[\"a\",[\"b\",[\"c\",1]],\"d\"]", json_Mix);
+
+  // 较长的同类型序列之后转换，含有带索引的对象
+  char *s = malloc(1 << 16);
+  size_t n = sprintf(s, "[");
+  for (int i = 0; i < 1000; i++)
+    n += sprintf(s + n, "%d,", i);
+  sprintf(s + n, "\"end\"]");
+  failed += check(s, json_Mix);
+  n = sprintf(s, "[");
+  for (int i = 0; i < 3; i++) {
+    n += sprintf(s + n, "{");
+    for (int j = 0; j < 20; j++)
+      n += sprintf(s + n, "%s\"k%d\":%d", j ? "," : "", j, j);
+    n += sprintf(s + n, "},");
+  }
+  sprintf(s + n, "1]");
+  failed += check(s, json_Mix);
+  free(s);
+
+  if (failed)
+    printf("%d failed\n", failed);
+  else
+    puts("ok");
+  return failed != 0;
+}
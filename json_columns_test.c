@@ -0,0 +1,168 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+static bool valid(const json_columns *c, size_t col, size_t row) {
+  return c->valid[col][row / 64] >> (row % 64) & 1;
+}
+
+/**
+ * @brief 检查由示例记录得到的列
+ *
+ * @return int 失败的个数
+ */
+static int check(const char *name, json_columns *c) {
+  int failed = 0;
+  if (!c || c->rows != 4 || c->nums != 6) {
+    printf("%s: shape\n", name);
+    return 1;
+  }
+  json *id = &c->cols[0], *name_ = &c->cols[1], *score = &c->cols[2];
+  json *ok = &c->cols[3], *tags = &c->cols[4], *extra = &c->cols[5];
+  if (strcmp(id->key, "id") || strcmp(extra->key, "extra") ||
+      id->next != name_ || extra->next) {
+    printf("%s: keys\n", name);
+    failed++;
+  }
+  if (id->value_type != json_Ints + 4 || id->value.Ints[2] != 3 ||
+      id->value.Ints[3] != 0 || valid(c, 0, 3) || !valid(c, 0, 2)) {
+    printf("%s: id\n", name);
+    failed++;
+  }
+  if (name_->value_type != json_Strings || name_->len != 4 ||
+      strcmp(name_->value.Strings[1], "b\n") || name_->value.Strings[2]) {
+    printf("%s: name\n", name);
+    failed++;
+  }
+  if (score->value_type != json_Floats + 4 || score->value.Floats[0] != 1.5 ||
+      valid(c, 2, 1)) {
+    printf("%s: score\n", name);
+    failed++;
+  }
+  if (ok->value_type != json_Bools + 4 || !ok->value.Bools[0] ||
+      ok->value.Bools[1] || !valid(c, 3, 1) || valid(c, 3, 2)) {
+    printf("%s: ok\n", name);
+    failed++;
+  }
+  // 类型不同的值为Mix
+  if (tags->value_type != json_Mix || tags->len != 4 ||
+      tags->value.Mix[0].value_type != json_Ints + 2 ||
+      tags->value.Mix[1].value_type != json_String ||
+      tags->value.Mix[3].value_type != json_Null ||
+      tags->value.Mix[2].next != &tags->value.Mix[3]) {
+    printf("%s: tags\n", name);
+    failed++;
+  }
+  if (extra->value_type != json_Jsons || extra->value.Jsons[0] ||
+      !extra->value.Jsons[3] || strcmp(extra->value.Jsons[3]->key, "x")) {
+    printf("%s: extra\n", name);
+    failed++;
+  }
+
+  // 序列化以len为准，缺少的行为null
+  char *dx = json_dump(extra, 0);
+  char *dn = json_dump(name_, 0);
+  if (!dx || strcmp(dx, "[null,null,null,{\"x\":[1]}]") || !dn ||
+      strcmp(dn, "[\"a\",\"b\\n\",null,null]")) {
+    printf("%s: dump %s %s\n", name, dx, dn);
+    failed++;
+  }
+  free(dx);
+  free(dn);
+
+  // 各列作为对象的成员查找
+  json obj = {.value_type = json_Json, .value.Json = c->cols};
+  char *b = json_read_str("name:1", &obj);
+  json_path *path = json_path_compile("score:0");
+  json_path *x = json_path_compile("extra:3:x");
+  double f = 0;
+  enum json_value_type t = json_Null;
+  union json_value v;
+  if (!b || strcmp(b, "b\n") || json_read_str("name:2", &obj) ||
+      json_read_str("missing", &obj) ||
+      !json_path_get_float(path, &obj, &f) || f != 1.5 ||
+      !json_path_get(x, &obj, &t, &v) || t != json_Ints + 1) {
+    printf("%s: lookup\n", name);
+    failed++;
+  }
+  json_path_free(path);
+  json_path_free(x);
+  return failed;
+}
+
+/**
+ * @brief 测试对象数组按key转置为列
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  const char *records =
+      "[{\"id\": 1, \"name\": \"a\", \"score\": 1.5, \"ok\": true,"
+      " \"tags\": [1, 2]},"
+      " {\"id\": 2, \"n\\u0061me\": \"b\\n\", \"score\": null, \"ok\": false,"
+      " \"tags\": \"t\", \"id\": 9},"
+      " {\"score\": 2.5, \"id\": 3, \"tags\": {\"a\": 1}},"
+      " {\"name\": null, \"extra\": {\"x\": [1]}, \"ok\": null}]";
+  int failed = 0;
+
+  // 直接解析
+  char *s = strdup(records);
+  json_columns *c = json_columns_parse(s, NULL, 0, 0);
+  failed += check("parse", c);
+  json_columns_free(c);
+  strcpy(s, records);
+  c = json_columns_parse(s, NULL, 0, JSON_INSITU | JSON_INTERN);
+  failed += check("parse insitu", c);
+  json_columns_free(c);
+
+  // 由json树转置
+  char *doc_s = malloc(strlen(records) + 16);
+  sprintf(doc_s, "{\"r\": %s}", records);
+  json_doc *doc = json_doc_parse(doc_s, 0);
+  c = doc ? json_columns_from(doc->root->value.Json, NULL, 0) : NULL;
+  failed += check("from", c);
+  json_columns_free(c);
+
+  // 只投影给定的key，其余的值跳过
+  const char *keys[] = {"score", "missing", "id"};
+  strcpy(s, records);
+  c = json_columns_parse(s, keys, 3, 0);
+  json_columns *d = json_columns_from(doc->root->value.Json, keys, 3);
+  for (int i = 0; i < 2; i++) {
+    json_columns *p = i ? d : c;
+    if (!p || p->nums != 3 || p->rows != 4 ||
+        p->cols[0].value_type != json_Floats + 4 ||
+        p->cols[1].value_type != json_Mix || p->valid[1][0] ||
+        p->cols[2].value.Ints[1] != 2) {
+      printf("projection %d\n", i);
+      failed++;
+    }
+  }
+  json_columns_free(c);
+  json_columns_free(d);
+  json_doc_free(doc);
+  free(doc_s);
+
+  // 不是对象的数组
+  char bad[] = "[{\"a\": 1}, 2]";
+  char empty[] = " [ ] ";
+  if (json_columns_parse(bad, NULL, 0, 0)) {
+    puts("non-object record accepted");
+    failed++;
+  }
+  c = json_columns_parse(empty, NULL, 0, 0);
+  if (!c || c->rows || c->nums) {
+    puts("empty array");
+    failed++;
+  }
+  json_columns_free(c);
+  free(s);
+
+  if (failed)
+    printf("%d failed\n", failed);
+  else
+    puts("ok");
+  return failed != 0;
+}
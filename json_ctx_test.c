@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 统计解析过程中申请内存的次数
+static size_t allocs;
+static void *count_malloc(size_t size) {
+  allocs++;
+  return malloc(size);
+}
+static void *count_realloc(void *ptr, size_t size) {
+  allocs++;
+  return realloc(ptr, size);
+}
+#define malloc(size) count_malloc(size)
+#define realloc(ptr, size) count_realloc(ptr, size)
+
+#include "json.c"
+#include "json.h"
+
+/**
+ * @brief 测试可复用的解析上下文
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  int failed = 0;
+  json_parser_ctx *c = json_ctx_new();
+  if (!c) {
+    puts("json_ctx_new failed");
+    return 1;
+  }
+
+  // 形状相近的文档，稳定后不再申请内存
+  char buf[4096];
+  size_t steady = 0;
+  for (int i = 0; i < 1000; i++) {
+    int n = i % 50 + 20;
+    size_t len = sprintf(buf, "{\"id\": %d, \"name\": \"doc\\n%d\", \"v\": [", i,
+                         i);
+    for (int j = 0; j < n; j++)
+      len += sprintf(buf + len, "%s{\"k%d\": %d.5}", j ? "," : "", j, j);
+    sprintf(buf + len, "], \"ints\": [1, 2, 3]}");
+
+    if (i == 100)
+      steady = allocs;
+    json_doc *doc = json_ctx_parse(c, buf, 0);
+    char *name = doc ? json_read_str("name", doc->root) : NULL;
+    char expect[32];
+    sprintf(expect, "doc\n%d", i);
+    if (!name || strcmp(name, expect)) {
+      printf("doc %d: %s\n", i, name ? name : "(null)");
+      failed++;
+      break;
+    }
+  }
+  if (allocs != steady) {
+    printf("%zu allocations in steady state\n", allocs - steady);
+    failed++;
+  }
+
+  // 更大的文档使上下文增长，之后同样不再申请内存
+  char *big = malloc(1 << 20);
+  size_t len = sprintf(big, "{\"a\": [");
+  for (int i = 0; i < 20000; i++)
+    len += sprintf(big + len, "%s\"s%d\"", i ? "," : "", i);
+  sprintf(big + len, "]}");
+  char *copy = malloc(len + 3);
+  for (int i = 0; i < 3; i++) {
+    memcpy(copy, big, len + 3);
+    steady = allocs;
+    json_doc *doc = json_ctx_parse(c, copy, JSON_INSITU);
+    if (!doc || doc->root->value.Json->len != 20000) {
+      puts("big doc");
+      failed++;
+    }
+    if (i && allocs != steady) {
+      printf("big doc %d: %zu allocations\n", i, allocs - steady);
+      failed++;
+    }
+  }
+
+  // 失败时返回NULL，上下文仍可继续使用
+  char bad[] = "[1, 2]";
+  if (json_ctx_parse(c, bad, 0)) {
+    puts("array root accepted");
+    failed++;
+  }
+  json_ctx_shrink(c);
+  char small[] = "{\"x\": true}";
+  json_doc *doc = json_ctx_parse(c, small, 0);
+  if (!doc || doc->root->value.Json->value_type != json_Bool) {
+    puts("after shrink");
+    failed++;
+  }
+
+  // 节点多于输入时arena有多个块，释放与缩小时不先合并
+  len = sprintf(big, "{\"m\": [");
+  for (int i = 0; i < 20000; i++)
+    len += sprintf(big + len, "%s", i ? ",1,\"x\"" : "1,\"x\"");
+  sprintf(big + len, "]}");
+  for (int i = 0; i < 2; i++) {
+    memcpy(copy, big, len + 3);
+    doc = json_ctx_parse(c, copy, JSON_INSITU);
+    if (!doc || !c->doc.block->next) {
+      puts("multiple blocks");
+      failed++;
+    }
+    steady = allocs;
+    if (i)
+      json_ctx_free(c);
+    else
+      json_ctx_shrink(c);
+    if (allocs - steady != (i ? 0 : 1)) {
+      printf("%s: %zu allocations\n", i ? "free" : "shrink", allocs - steady);
+      failed++;
+    }
+  }
+
+  free(big);
+  free(copy);
+  if (failed)
+    printf("%d failed\n", failed);
+  else
+    puts("ok");
+  return failed != 0;
+}
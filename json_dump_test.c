@@ -0,0 +1,92 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief 测试json_dump与json_dump_into
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  char s[] = "{\"i\":-12,\"f\":0.1,\"e\":1e300,\"t\":true,\"n\":null,"
+             "\"s\":\"a\\\"\\\\\\n\\u0001中\",\"ints\":[1,22,333],"
+             "\"floats\":[1.5,-0.25],\"bools\":[true,false],"
+             "\"strs\":[\"x\",\"y\"],\"objs\":[{\"a\":1},{}],"
+             "\"mix\":[1,\"two\",[]],\"obj\":{}}";
+  const char *compact =
+      "{\"i\":-12,\"f\":0.1,\"e\":1e300,\"t\":true,\"n\":null,"
+      "\"s\":\"a\\\"\\\\\\n\\u0001中\",\"ints\":[1,22,333],"
+      "\"floats\":[1.5,-0.25],\"bools\":[true,false],"
+      "\"strs\":[\"x\",\"y\"],\"objs\":[{\"a\":1},{}],"
+      "\"mix\":[1,\"two\",[]],\"obj\":{}}";
+  int failed = 0;
+  json *root = json_parse(s);
+
+  char *out = json_dump(root, 0);
+  if (!out || strcmp(out, compact)) {
+    printf("compact: %s\n", out);
+    failed++;
+  }
+
+  // 重新解析后结果相同
+  json *again = json_parse(out);
+  char *out2 = json_dump(again, 0);
+  if (!out2 || strcmp(out, out2)) {
+    printf("round trip: %s\n", out2);
+    failed++;
+  }
+  free(out2);
+  json_free(again);
+
+  // 缓冲区不足时不写入
+  char buf[512];
+  size_t len = json_dump_into(buf, 8, root, 0);
+  if (len != strlen(compact)) {
+    printf("json_dump_into length %zu\n", len);
+    failed++;
+  }
+  len = json_dump_into(buf, sizeof(buf), root, 0);
+  if (len != strlen(compact) || strcmp(buf, compact)) {
+    printf("json_dump_into: %s\n", buf);
+    failed++;
+  }
+  free(out);
+
+  char t[] = "{\"a\":[1,{\"b\":null}],\"c\":{}}";
+  json *small = json_parse(t);
+  out = json_dump(small, JSON_PRETTY);
+  const char *pretty = "{\n"
+                       "  \"a\": [\n"
+                       "    1,\n"
+                       "    {\n"
+                       "      \"b\": null\n"
+                       "    }\n"
+                       "  ],\n"
+                       "  \"c\": {}\n"
+                       "}";
+  if (!out || strcmp(out, pretty)) {
+    printf("pretty: %s\n", out);
+    failed++;
+  }
+  free(out);
+  json_free(small);
+  json_free(root);
+
+  // 浮点数的最短表示
+  const double values[] = {0.3, 1.0, -0.0, 1e21, 1e-7, 123.456, 5e-324};
+  const char *expect[] = {"0.3",  "1.0",     "-0.0",  "1e21",
+                          "1e-7", "123.456", "5e-324"};
+  for (size_t i = 0; i < sizeof(values) / sizeof(*values); i++) {
+    char num[JSON_DOUBLE_MAX + 1];
+    *write_double(num, values[i]) = '\0';
+    if (strcmp(num, expect[i])) {
+      printf("double %s: %s\n", expect[i], num);
+      failed++;
+    }
+  }
+
+  printf("%s\n", failed ? "failed" : "passed");
+  return failed != 0;
+}
@@ -0,0 +1,189 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief 生成含有n个成员的对象，成员k0为重复的key，
+ * 开头为arrays个值为数组的成员
+ *
+ * @return char* 由malloc申请
+ */
+static char *make_object(int n, int arrays) {
+  char *s = malloc((size_t)(n + arrays) * 32 + 64);
+  size_t len = sprintf(s, "{");
+  for (int i = 0; i < arrays; i++)
+    len += sprintf(s + len, "\"a%d\": [%d], ", i, i);
+  for (int i = 0; i < n; i++)
+    len += sprintf(s + len, "%s\"k%d\": \"v%d\"", i ? ", " : "", i, i);
+  sprintf(s + len, ", \"k0\": \"dup\"}");
+  return s;
+}
+
+/**
+ * @brief 检查对象中每个成员可以查找到，重复的key返回第一个，缺少的key为NULL
+ *
+ * @param name 出错时输出的名称
+ * @param obj 值为对象的节点
+ * @param n 成员个数
+ * @return int 失败的个数
+ */
+static int check_lookup(const char *name, json *obj, int n) {
+  char key[16], value[16];
+  for (int i = 0; i < n; i++) {
+    sprintf(key, "k%d", i);
+    sprintf(value, "v%d", i);
+    char *str = json_read_str(key, obj);
+    if (!str || strcmp(str, value)) {
+      printf("%s: %s\n", name, key);
+      return 1;
+    }
+  }
+  if (json_read_str("missing", obj) || json_read_str("k", obj)) {
+    printf("%s: missing key\n", name);
+    return 1;
+  }
+  json_path *path = json_path_compile("k1");
+  char *str = json_path_get_str(path, obj);
+  json_path_free(path);
+  if (!str || strcmp(str, "v1")) {
+    printf("%s: path\n", name);
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief 手动建立含有n个成员的对象，节点与字符串分别由malloc申请
+ *
+ * @return json* 根节点，由json_free释放
+ */
+static json *build_object(int n) {
+  json *root = calloc(1, sizeof(json));
+  root->value_type = json_Json;
+  json **tail = &root->value.Json;
+  for (int i = 0; i < n; i++) {
+    json *node = calloc(1, sizeof(json));
+    char buf[16];
+    sprintf(buf, "k%d", i);
+    node->key = strdup(buf);
+    sprintf(buf, "v%d", i);
+    node->value_type = json_String;
+    node->value.String = strdup(buf);
+    *tail = node;
+    tail = &node->next;
+  }
+  return root;
+}
+
+/**
+ * @brief 测试对象的成员索引，以及手动建立的对象不读取索引头部
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  int failed = 0;
+  const int n = 40;
+
+  // json_parse 与文档解析的对象都建立索引
+  char *s = make_object(n, 0);
+  json *root = json_parse(s);
+  if (!root || !object_index(root->value.Json)) {
+    puts("json_parse: no index");
+    failed++;
+  } else {
+    failed += check_lookup("json_parse", root, n);
+  }
+  json_free(root);
+  json_doc *doc = json_doc_parse(s, 0);
+  if (!doc || !object_index(doc->root->value.Json)) {
+    puts("json_doc_parse: no index");
+    failed++;
+  } else {
+    failed += check_lookup("json_doc_parse", doc->root, n);
+  }
+  json_doc_free(doc);
+  free(s);
+
+  // 成员较少的对象沿链表查找，同样返回第一个重复的key
+  s = make_object(3, 0);
+  root = json_parse(s);
+  if (!root || object_index(root->value.Json) ||
+      strcmp(json_read_str("k0", root), "v0")) {
+    puts("small object");
+    failed++;
+  }
+  json_free(root);
+  free(s);
+
+  // 头部在成员节点中，Jsons与Mix中的对象都保留索引
+  s = make_object(n, 0);
+  size_t len = strlen(s);
+  char *arr = malloc(len * 3 + 64);
+  sprintf(arr, "{\"a\": [%s, %s], \"m\": [1, %s]}", s, s, s);
+  root = json_parse(arr);
+  json *a = root ? jump("a", root) : NULL;
+  json *m = root ? jump("m", root) : NULL;
+  if (!a || a->value_type != json_Jsons || !m || m->value_type != json_Mix ||
+      !object_index(a->value.Jsons[1]) ||
+      !object_index(m->value.Mix[1].value.Json)) {
+    puts("arrays of objects");
+    failed++;
+  } else {
+    json obj = {.value_type = json_Json, .value.Json = a->value.Jsons[1]};
+    failed += check_lookup("Jsons", &obj, n);
+    failed += check_lookup("Mix", &m->value.Mix[1], n);
+    char *str = json_read_str("a:1:k5", root);
+    if (!str || strcmp(str, "v5")) {
+      puts("Jsons path");
+      failed++;
+    }
+  }
+  json_free(root);
+  free(arr);
+  free(s);
+
+  // 开头的成员值为数组时，头部在之后的成员中
+  s = make_object(n, 3);
+  root = json_parse(s);
+  doc = json_doc_parse(s, JSON_LAZY);
+  if (!root || !object_index(root->value.Json) || !doc ||
+      !object_index(doc->root->value.Json)) {
+    puts("leading arrays: no index");
+    failed++;
+  } else {
+    failed += check_lookup("leading arrays", root, n);
+    failed += check_lookup("leading arrays lazy", doc->root, n);
+  }
+  json_free(root);
+  json_doc_free(doc);
+  free(s);
+
+  // 增量解析的对象同样带有索引
+  s = make_object(n, 0);
+  json_parser *p = json_parser_new();
+  json_parser_feed(p, s, strlen(s) / 2);
+  json_parser_feed(p, s + strlen(s) / 2, strlen(s) - strlen(s) / 2);
+  root = json_parser_finish(p);
+  if (!root || !object_index(root->value.Json)) {
+    puts("json_parser: no index");
+    failed++;
+  } else {
+    failed += check_lookup("json_parser", root, n);
+  }
+  json_free(root);
+  free(s);
+
+  // 手动建立的对象没有头部，查找与释放不越界，不读取值节点的len
+  root = build_object(n);
+  root->len = 1;
+  failed += check_lookup("hand-built", root, n);
+  json_free(root);
+
+  if (failed)
+    printf("%d failed\n", failed);
+  else
+    puts("ok");
+  return failed != 0;
+}
@@ -0,0 +1,131 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief 生成含有n个结构相同的记录的文档
+ *
+ * 每个记录有20个成员，其中一个key含有转义，kind 为重复的短字符串
+ *
+ * @return char* 由malloc申请
+ */
+static char *make_doc(int n) {
+  char *s = malloc((size_t)n * 512 + 64);
+  size_t len = sprintf(s, "{\"recs\": [");
+  for (int i = 0; i < n; i++) {
+    len += sprintf(s + len, "%s{\"id\": %d, \"kind\": \"%s\", \"k\\u0065y\": 1,"
+                   " \"note\": \"a long string value %d\"",
+                   i ? "," : "", i, i % 3 ? "user" : "admin", i);
+    for (int j = 0; j < 16; j++)
+      len += sprintf(s + len, ", \"f%d\": %d", j, j);
+    len += sprintf(s + len, "}");
+  }
+  sprintf(s + len, "]}");
+  return s;
+}
+
+/**
+ * @brief 检查以flags解析的文档与普通解析的结果相同，key共用一份
+ *
+ * @return int 失败的个数
+ */
+static int check(int n, int flags) {
+  int failed = 0;
+  char *a = make_doc(n);
+  char *b = strdup(a);
+  json_doc *plain = json_doc_parse(a, flags & JSON_INSITU);
+  json_doc *doc = json_doc_parse(b, flags);
+  char *x = plain ? json_dump(plain->root, 0) : NULL;
+  char *y = doc ? json_dump(doc->root, 0) : NULL;
+  if (!x || !y || strcmp(x, y)) {
+    printf("flags %d: dump differs\n", flags);
+    failed++;
+    goto out;
+  }
+
+  json **recs = doc->root->value.Json->value.Jsons;
+  char *key = json_doc_intern(doc, "key");
+  char *kind = json_doc_intern(doc, "kind");
+  if (!key || !kind || json_doc_intern(doc, "missing")) {
+    printf("flags %d: json_doc_intern\n", flags);
+    failed++;
+    goto out;
+  }
+  // 并行解析时每个线程有一份副本，只比较内容
+  bool exact = !(flags & JSON_PARALLEL);
+  for (int i = 0; i < n; i++) {
+    json *first = recs[i];
+    if (exact ? first->next->key != kind : strcmp(first->next->key, kind)) {
+      printf("flags %d: rec %d key not shared\n", flags, i);
+      failed++;
+      break;
+    }
+    // 驻留的key先比较指针，Jsons的元素同样使用索引
+    json *k = find_member(first, key, 3);
+    json *f = find_member(first, "f15", 3);
+    if (!k || (exact && k->key != key) || !f || f->value.Int != 15) {
+      printf("flags %d: rec %d lookup\n", flags, i);
+      failed++;
+      break;
+    }
+  }
+
+  // 短字符串值只在 JSON_INTERN_STRINGS 时共用
+  char *u1 = recs[1]->next->value.String;
+  char *u2 = recs[2]->next->value.String;
+  char *n1 = recs[1]->next->next->next->value.String;
+  bool shared = u1 == u2 && u1 == json_doc_intern(doc, "user");
+  if (shared != !!(flags & JSON_INTERN_STRINGS) ||
+      n1 == json_doc_intern(doc, "a long string value 1")) {
+    printf("flags %d: string values\n", flags);
+    failed++;
+  }
+out:
+  free(x);
+  free(y);
+  json_doc_free(plain);
+  json_doc_free(doc);
+  free(a);
+  free(b);
+  return failed;
+}
+
+/**
+ * @brief 测试 JSON_INTERN 驻留key与短字符串
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  int failed = 0;
+  failed += check(100, JSON_INTERN);
+  failed += check(100, JSON_INTERN | JSON_INSITU);
+  failed += check(100, JSON_INTERN | JSON_INTERN_STRINGS);
+  failed += check(100, JSON_INTERN | JSON_INTERN_STRINGS | JSON_INSITU);
+  failed += check(100, JSON_INTERN | JSON_LAZY);
+  // 并行解析时各线程的驻留表合并到文档中
+  failed += check(20000, JSON_INTERN | JSON_THREADS(4));
+
+  // 上下文复用驻留表，新文档中的key重新驻留
+  json_parser_ctx *c = json_ctx_new();
+  for (int i = 0; i < 3; i++) {
+    char s[64];
+    sprintf(s, "{\"a%d\": [{\"x\": 1}, {\"x\": 2}]}", i);
+    json_doc *doc = json_ctx_parse(c, s, JSON_INTERN);
+    char name[8];
+    sprintf(name, "a%d", i);
+    if (!doc || !json_doc_intern(doc, name) ||
+        (i && json_doc_intern(doc, "a0"))) {
+      printf("ctx %d\n", i);
+      failed++;
+    }
+  }
+  json_ctx_free(c);
+
+  if (failed)
+    printf("%d failed\n", failed);
+  else
+    puts("ok");
+  return failed != 0;
+}
@@ -0,0 +1,129 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief 测试 JSON_LAZY 延迟解析
+ *
+ * @return int 全部通过返回0
+ */
+/**
+ * @brief 文档首块的字节数，首块位于链表的末尾
+ */
+static size_t first_block(const json_doc *doc) {
+  struct json_block *b = doc->block;
+  while (b->next)
+    b = b->next;
+  return b->end - (char *)b;
+}
+
+int main(void) {
+  char s[] = "{\"a\": {\"b\": [1, 2, 3], \"c\": \"x}]\\\"y\"},"
+             " \"n\": -1.5e3, \"t\": true, \"z\": null,"
+             " \"objs\": [{\"k\": {\"v\": \"deep\"}}, {\"k\": 0}],"
+             " \"s\": \"str\", \"o\": {\"p\": {\"q\": [[], {}]}}}";
+  int failed = 0;
+
+  json_doc *eager = json_doc_parse(s, 0);
+  json_doc *lazy = json_doc_parse(s, JSON_LAZY);
+  if (!eager || !lazy) {
+    puts("parse failed");
+    return 1;
+  }
+
+  // 成员只记录位置，未被解析
+  json *m = lazy->root->value.Json;
+  if (m->value_type != json_Lazy) {
+    printf("member type %d\n", m->value_type);
+    failed++;
+  }
+
+  // 查找时解析
+  char *c = json_read_str("a:c", lazy->root);
+  if (!c || strcmp(c, "x}]\"y")) {
+    printf("a:c = %s\n", c ? c : "(null)");
+    failed++;
+  }
+  c = json_read_str("objs:0:k:v", lazy->root);
+  if (!c || strcmp(c, "deep")) {
+    printf("objs:0:k:v = %s\n", c ? c : "(null)");
+    failed++;
+  }
+  if (lazy->root->value.Json->next->value_type != json_Lazy) {
+    puts("untouched member was parsed");
+    failed++;
+  }
+
+  json_path *path = json_path_compile("o:p:q");
+  enum json_value_type type;
+  union json_value value;
+  if (!path || !json_path_get(path, lazy->root, &type, &value) ||
+      type != json_Mix) {
+    puts("path o:p:q");
+    failed++;
+  }
+  json_path_free(path);
+
+  // 全部解析后与立即解析的结果相同
+  char *a = json_dump(eager->root, 0);
+  char *b = json_dump(lazy->root, 0);
+  if (!a || !b || strcmp(a, b)) {
+    printf("dump:\n%s\n%s\n", a, b);
+    failed++;
+  }
+  free(a);
+  free(b);
+
+  // 结构索引跳过字符串中的括号与转义的引号
+  if (!lazy->tokens) {
+    puts("no structural index");
+    failed++;
+  }
+
+  // 含有注释时不建立索引，按普通方式解析
+  char commented[] = "{\"a\": [1, /* ] */ 2], // }\n \"b\": {\"c\": \"\\\\\"}}";
+  json_doc *doc = json_doc_parse(commented, JSON_LAZY);
+  c = doc ? json_read_str("b:c", doc->root) : NULL;
+  if (!doc || doc->tokens || doc->root->value.Json->value_type == json_Lazy ||
+      !c || strcmp(c, "\\")) {
+    puts("commented input");
+    failed++;
+  }
+  json_doc_free(doc);
+
+  // 有误的值在访问时为null
+  char bad[] = "{\"ok\": 1, \"bad\": tru}";
+  doc = json_doc_parse(bad, JSON_LAZY);
+  if (!doc ||
+      json_load(doc->root->value.Json->next)->value_type != json_Null) {
+    puts("invalid scalar");
+    failed++;
+  }
+  json_doc_free(doc);
+
+  // 延迟解析的首块按只建立一层节点估计，远小于立即解析
+  size_t len = 1 << 16;
+  char *big = malloc(len + 1);
+  size_t n = sprintf(big, "{\"arr\": [");
+  while (n < len - 16)
+    n += sprintf(big + n, "%zu, ", n);
+  strcpy(big + n, "0], \"x\": 1}");
+  len = strlen(big);
+  doc = json_doc_parse(big, JSON_LAZY);
+  if (!doc || first_block(doc) >= len / 2) {
+    printf("lazy first block %zu\n", doc ? first_block(doc) : 0);
+    failed++;
+  }
+  json_doc_free(doc);
+  free(big);
+
+  json_doc_free(eager);
+  json_doc_free(lazy);
+  if (failed)
+    printf("%d failed\n", failed);
+  else
+    puts("ok");
+  return failed != 0;
+}
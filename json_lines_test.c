@@ -0,0 +1,87 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief 检查记录按输入顺序到达，且第i条记录的id为i
+ */
+struct check {
+  json_path *id;
+  size_t next;
+  int failed;
+};
+
+static void on_record(void *arg, size_t index, json_doc *doc) {
+  struct check *check = arg;
+  long id;
+  if (index != check->next++ || !doc ||
+      !json_path_get_int(check->id, doc->root, &id) || (size_t)id != index) {
+    printf("record %zu\n", index);
+    check->failed++;
+  }
+  json_doc_free(doc);
+}
+
+/**
+ * @brief 记录第index条记录首个key的首字符，解析失败时为'-'
+ */
+static void on_key(void *arg, size_t index, json_doc *doc) {
+  char *keys = arg;
+  json *first = doc ? doc->root->value.Json : NULL;
+  if (index < 8)
+    keys[index] = first ? first->key[0] : '-';
+  json_doc_free(doc);
+}
+
+/**
+ * @brief 测试json_parse_lines
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  size_t nums = 100000;
+  size_t cap = nums * 64;
+  char *buf = malloc(cap);
+  size_t len = 0;
+  for (size_t i = 0; i < nums; i++) {
+    // 含转义换行、CRLF与空行
+    if (i % 7 == 0)
+      len += sprintf(buf + len, "{\"id\":%zu,\"s\":\"a\\nb\"}\n", i);
+    else if (i % 7 == 1)
+      len += sprintf(buf + len, "{\"s\":\"a b\\\\\",\"id\":%zu}\r\n", i);
+    else if (i % 7 == 2)
+      len += sprintf(buf + len, "\n  {\"id\":%zu,\"a\":[1,2]}\n", i);
+    else
+      len += sprintf(buf + len, "{\"id\":%zu}\n", i);
+  }
+
+  int failed = 0;
+  int threads[] = {1, 4, 0};
+  for (size_t i = 0; i < sizeof(threads) / sizeof(*threads); i++) {
+    struct check check = {json_path_compile("id"), 0, 0};
+    // 最后一条记录不以换行结尾
+    size_t count = json_parse_lines(buf, len - 1, threads[i], on_record, &check);
+    if (count != nums || check.next != nums || check.failed) {
+      printf("threads %d: %zu records\n", threads[i], count);
+      failed++;
+    }
+    json_path_free(check.id);
+  }
+
+  free(buf);
+
+  // 截断的记录只影响本行，字符串中未转义的换行也分割记录
+  const char bad[] = "{\"a\":\"truncated\n{\"b\":\"x\"}\n{\"c\":1}\n"
+                     "{\"d\":\"x\ny\"}\n{\"e\":3}\n";
+  char keys[9] = "";
+  size_t count = json_parse_lines(bad, sizeof(bad) - 1, 2, on_key, keys);
+  if (count != 6 || keys[1] != 'b' || keys[2] != 'c' || keys[5] != 'e') {
+    printf("malformed: %zu records %s\n", count, keys);
+    failed++;
+  }
+
+  printf("%s\n", failed ? "failed" : "passed");
+  return failed != 0;
+}
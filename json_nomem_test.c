@@ -0,0 +1,98 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 第fail_at次申请内存时失败，之前的申请正常
+static size_t allocs;
+static size_t fail_at;
+static void *fail_malloc(size_t size) {
+  if (++allocs == fail_at)
+    return NULL;
+  return malloc(size);
+}
+#define malloc(size) fail_malloc(size)
+
+#include "json.c"
+#include "json.h"
+
+/**
+ * @brief 检查数组的值：元素个数不为0时指针不为NULL
+ *
+ * @return bool 有误时返回false
+ */
+static bool check_arrays(const json *item) {
+  enum json_value_type t = item->value_type;
+  if (t == json_Json) {
+    for (const json *m = item->value.Json; m; m = m->next)
+      if (!check_arrays(m))
+        return false;
+    return true;
+  }
+  if (t == json_Mix || t == json_Strings || t == json_Jsons) {
+    if (item->len && !item->value.Mix)
+      return false;
+    for (unsigned int i = 0; t == json_Mix && i < item->len; i++)
+      if (!check_arrays(&item->value.Mix[i]))
+        return false;
+    for (unsigned int i = 0; t == json_Jsons && i < item->len; i++) {
+      json obj = {.value_type = json_Json, .value.Json = item->value.Jsons[i]};
+      if (!check_arrays(&obj))
+        return false;
+    }
+    return true;
+  }
+  if (t > json_Ints)
+    return item->value.Ints != NULL;
+  return true;
+}
+
+/**
+ * @brief 测试申请内存失败时数组不会留下NULL指针，也不泄漏已解析的元素
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  int failed = 0;
+  char s[] = "{\"i\": [1, 2, 3], \"f\": [1.5, 2.5], \"b\": [true],"
+             " \"s\": [\"a string value longer than 16\", \"b\"],"
+             " \"j\": [{\"x\": \"a string value longer than 16\"}, {\"y\": 1}],"
+             " \"m\": [1, \"a string value longer than 16\", {\"z\": [2]}]}";
+
+  // 依次让每一次申请失败，直到解析不再申请失败
+  for (fail_at = 1;; fail_at++) {
+    char copy[sizeof(s)];
+    memcpy(copy, s, sizeof(s));
+    allocs = 0;
+    json *root = json_parse(copy);
+    bool done = allocs < fail_at;
+    if (root && !check_arrays(root)) {
+      printf("json_parse: fail at %zu\n", fail_at);
+      failed++;
+    }
+    json_free(root);
+
+    // 增量解析器中数组申请失败时返回错误
+    memcpy(copy, s, sizeof(s));
+    allocs = 0;
+    json_parser *p = json_parser_new();
+    if (p) {
+      json_parser_feed(p, copy, sizeof(s) / 2);
+      json_parser_feed(p, copy + sizeof(s) / 2, sizeof(s) - 1 - sizeof(s) / 2);
+      root = json_parser_finish(p);
+      if (root && !check_arrays(root)) {
+        printf("json_parser: fail at %zu\n", fail_at);
+        failed++;
+      }
+      json_free(root);
+    }
+    if (done)
+      break;
+  }
+
+  if (failed)
+    printf("%d failed\n", failed);
+  else
+    puts("ok");
+  return failed != 0;
+}
@@ -0,0 +1,124 @@
+#include "json.c"
+#include "json.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief 解析数字并与期望的类型和值比较，浮点数按位比较
+ *
+ * @return int 失败的个数
+ */
+static int expect(const char *str, enum json_value_type type, long i,
+                  double f) {
+  json item;
+  char *s = (char *)str;
+  if (!parse_number(&s, &item) || *s != '\0' || item.value_type != type ||
+      (type == json_Int && item.value.Int != i) ||
+      (type == json_Float && memcmp(&item.value.Float, &f, sizeof(f)))) {
+    printf("%s: type %d, %ld / %.17g\n", str, item.value_type, item.value.Int,
+           item.value.Float);
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief 浮点数的结果与strtod相同
+ */
+static int expect_strtod(const char *str) {
+  return expect(str, json_Float, 0, strtod(str, NULL));
+}
+
+static uint64_t rng = 88172645463325252ull;
+static uint64_t next_rand(void) {
+  rng ^= rng << 13;
+  rng ^= rng >> 7;
+  rng ^= rng << 17;
+  return rng;
+}
+
+/**
+ * @brief 测试数字解析，Eisel-Lemire 与 strtod 回退的结果均为正确舍入
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  int failed = 0;
+
+  // 正负零
+  failed += expect("0", json_Int, 0, 0);
+  failed += expect("-0", json_Int, 0, 0);
+  failed += expect("0.0", json_Float, 0, 0.0);
+  failed += expect("-0.0", json_Float, 0, -0.0);
+  failed += expect("-0e10", json_Float, 0, -0.0);
+
+  // int64 的边界，超出时为浮点数
+  failed += expect("9223372036854775807", json_Int, INT64_MAX, 0);
+  failed += expect("-9223372036854775808", json_Int, INT64_MIN, 0);
+  failed += expect_strtod("9223372036854775808");
+  failed += expect_strtod("-9223372036854775809");
+  failed += expect_strtod("18446744073709551616");
+
+  // 溢出与下溢
+  failed += expect("1e400", json_Float, 0, HUGE_VAL);
+  failed += expect("-1e400", json_Float, 0, -HUGE_VAL);
+  failed += expect("1e-400", json_Float, 0, 0.0);
+  failed += expect("-1e-400", json_Float, 0, -0.0);
+  failed += expect_strtod("1.7976931348623157e308");
+  failed += expect_strtod("1.7976931348623158e308");
+
+  // 非规格化数与边界
+  failed += expect_strtod("4.9406564584124654e-324");
+  failed += expect_strtod("2.4703282292062328e-324");
+  failed += expect_strtod("2.2250738585072011e-308");
+  failed += expect_strtod("2.2250738585072014e-308");
+  failed += expect_strtod("2.2250738585072012e-308");
+  failed += expect_strtod("1e-310");
+
+  // 需要回退的难例
+  failed += expect("1e23", json_Float, 0, 1e23);
+  failed += expect_strtod("8.98846567431158e307");
+  failed += expect_strtod("9007199254740993.0");
+
+  // 超过19位的尾数
+  failed += expect_strtod("1234567890123456789012345678901234567890");
+  failed += expect_strtod("0.1234567890123456789012345678901234567890");
+  failed += expect_strtod("9007199254740992.000000000000000000000001");
+  // 恰好位于两个double中间时，很远处的非零数字决定舍入方向
+  char half[512];
+  size_t n = sprintf(half, "9007199254740993.");
+  memset(half + n, '0', 400);
+  strcpy(half + n + 400, "1");
+  failed += expect(half, json_Float, 0, 9007199254740994.0);
+  half[n + 400] = '\0';
+  failed += expect(half, json_Float, 0, 9007199254740992.0);
+
+  // 随机的数字与strtod逐位相同
+  char buf[64];
+  for (int i = 0; i < 1000000; i++) {
+    uint64_t r = next_rand();
+    int digits = (int)(r % 25) + 1;
+    n = 0;
+    if (r >> 63)
+      buf[n++] = '-';
+    buf[n++] = '1' + (char)(next_rand() % 9);
+    for (int j = 1; j < digits; j++) {
+      if (j == (int)(r >> 8) % digits)
+        buf[n++] = '.';
+      buf[n++] = '0' + (char)(next_rand() % 10);
+    }
+    int e = (int)(next_rand() % 700) - 350;
+    sprintf(buf + n, "e%d", e);
+    if (expect_strtod(buf) && ++failed > 10)
+      break;
+  }
+
+  if (failed)
+    printf("%d failed\n", failed);
+  else
+    puts("ok");
+  return failed != 0;
+}
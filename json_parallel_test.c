@@ -0,0 +1,85 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief 生成含有一个大数组的文档
+ *
+ * @param n 元素个数
+ * @param mix 为true时每1000个元素中有一个数字，数组为Mix
+ * @return char* 由malloc申请
+ */
+static char *make_doc(int n, bool mix) {
+  char *s = malloc((size_t)n * 128 + 64);
+  size_t len = sprintf(s, "{\"items\": [");
+  for (int i = 0; i < n; i++) {
+    if (i)
+      len += sprintf(s + len, i % 7 ? "," : ",\n  ");
+    if (mix && i % 1000 == 999)
+      len += sprintf(s + len, "%d", i);
+    else
+      len += sprintf(s + len,
+                     "{\"id\": %d, \"name\": \"n\\\"]%d\", \"v\": [%d, %d.5],"
+                     " \"o\": {\"a\": [{\"b\": %s}]}}",
+                     i, i, i, i, i & 1 ? "true" : "null");
+  }
+  sprintf(s + len, "], \"tail\": 1}");
+  return s;
+}
+
+/**
+ * @brief 测试 JSON_PARALLEL 的结果与顺序解析相同
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  int failed = 0;
+  for (int mix = 0; mix < 2; mix++) {
+    for (int insitu = 0; insitu < 2; insitu++) {
+      char *a = make_doc(20000, mix);
+      char *b = strdup(a);
+      int flags = insitu ? JSON_INSITU : 0;
+      json_doc *seq = json_doc_parse(a, flags);
+      json_doc *par = json_doc_parse(b, flags | JSON_THREADS(4));
+      char *x = seq ? json_dump(seq->root, 0) : NULL;
+      char *y = par ? json_dump(par->root, 0) : NULL;
+      if (!x || !y || strcmp(x, y)) {
+        printf("mix=%d insitu=%d differs\n", mix, insitu);
+        failed++;
+      }
+      free(x);
+      free(y);
+      json_doc_free(seq);
+      json_doc_free(par);
+      free(a);
+      free(b);
+    }
+  }
+
+  // 元素有误时与顺序解析在同一位置停止
+  char *a = make_doc(20000, false);
+  memcpy(strstr(a, "\"id\": 15000,") + 6, "@", 1);
+  char *b = strdup(a);
+  json_doc *seq = json_doc_parse(a, 0);
+  json_doc *par = json_doc_parse(b, JSON_THREADS(4));
+  char *x = seq ? json_dump(seq->root, 0) : NULL;
+  char *y = par ? json_dump(par->root, 0) : NULL;
+  if (!x || !y || strcmp(x, y)) {
+    puts("bad element differs");
+    failed++;
+  }
+  free(x);
+  free(y);
+  json_doc_free(seq);
+  json_doc_free(par);
+  free(a);
+  free(b);
+
+  if (failed)
+    printf("%d failed\n", failed);
+  else
+    puts("ok");
+  return failed != 0;
+}
@@ -0,0 +1,159 @@
+#include "json.c"
+#include "json.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief 写入临时文件
+ *
+ * @param path 修改为文件路径
+ * @return bool 失败返回false
+ */
+static bool write_file(char *path, const char *buf, size_t len) {
+  strcpy(path, "/tmp/json_parse_file_XXXXXX");
+  int fd = mkstemp(path);
+  if (fd < 0)
+    return false;
+  bool ok = write(fd, buf, len) == (ssize_t)len;
+  close(fd);
+  return ok;
+}
+
+/**
+ * @brief 生成长度恰好为len的文档，结尾的`}`之前以空格填充
+ *
+ * 最后一个成员x为 "end"
+ *
+ * @return char* 由malloc申请
+ */
+static char *make_doc(size_t len) {
+  char *s = malloc(len + 1);
+  size_t n = sprintf(s, "{\"a\": [1, 2, 3], \"s\": \"str\", \"x\": \"end\"");
+  memset(s + n, ' ', len - n - 1);
+  s[len - 1] = '}';
+  s[len] = '\0';
+  return s;
+}
+
+/**
+ * @brief 检查由make_doc生成的文档
+ */
+static bool check_doc(const json_doc *doc) {
+  char *x = doc ? json_read_str("x", doc->root) : NULL;
+  char *s = doc ? json_read_str("s", doc->root) : NULL;
+  return x && !strcmp(x, "end") && s && !strcmp(s, "str");
+}
+
+/**
+ * @brief 向管道写入数据的线程
+ */
+struct pipe_writer {
+  int fd;
+  const char *buf;
+  size_t len;
+};
+
+static void *pipe_write(void *arg) {
+  struct pipe_writer *w = arg;
+  for (size_t done = 0; done < w->len;) {
+    ssize_t n = write(w->fd, w->buf + done, w->len - done);
+    if (n <= 0)
+      break;
+    done += n;
+  }
+  close(w->fd);
+  return NULL;
+}
+
+/**
+ * @brief 测试json_parse_file的映射与读取路径
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  int failed = 0;
+  char path[64];
+  size_t page = sysconf(_SC_PAGESIZE);
+
+  // 不存在的文件
+  if (json_parse_file("/tmp/json_parse_file_missing/none.json", 0)) {
+    puts("missing file");
+    failed++;
+  }
+
+  // 空文件不是合法的json
+  if (!write_file(path, "", 0) || json_parse_file(path, 0)) {
+    puts("empty file");
+    failed++;
+  }
+  unlink(path);
+
+  // 长度为页大小整数倍时，哨兵位于之后的匿名页中
+  size_t sizes[] = {page - 1, page, page + 1, page * 2};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(*sizes); i++) {
+    size_t len = sizes[i];
+    char *s = make_doc(len);
+    if (!write_file(path, s, len)) {
+      puts("write");
+      return 1;
+    }
+    json_doc *doc = json_parse_file(path, 0);
+    if (!check_doc(doc) || doc->input) {
+      printf("size %zu\n", len);
+      failed++;
+    }
+    json_doc_free(doc);
+
+    // 原地解析时映射随文档释放，字符串指向映射，不修改文件
+    doc = json_parse_file(path, JSON_INSITU);
+    char *x = doc ? json_read_str("x", doc->root) : NULL;
+    if (!check_doc(doc) || !doc->input || !doc->input_map ||
+        x < (char *)doc->input || x >= (char *)doc->input + len) {
+      printf("size %zu insitu\n", len);
+      failed++;
+    }
+    json_doc_free(doc);
+    FILE *fp = fopen(path, "rb");
+    char *back = malloc(len + 1);
+    if (!fp || fread(back, 1, len + 1, fp) != len || memcmp(back, s, len)) {
+      printf("size %zu file modified\n", len);
+      failed++;
+    }
+    if (fp)
+      fclose(fp);
+    free(back);
+    unlink(path);
+    free(s);
+  }
+
+  // 管道无法映射，分块读取，长度超过一块
+  size_t len = JSON_READ_CHUNK * 3 + 5;
+  char *s = make_doc(len);
+  int fds[2];
+  if (pipe(fds)) {
+    puts("pipe");
+    return 1;
+  }
+  struct pipe_writer w = {fds[1], s, len};
+  pthread_t thread;
+  pthread_create(&thread, NULL, pipe_write, &w);
+  sprintf(path, "/proc/self/fd/%d", fds[0]);
+  json_doc *doc = json_parse_file(path, JSON_INSITU);
+  pthread_join(thread, NULL);
+  close(fds[0]);
+  if (!check_doc(doc) || !doc->input || doc->input_map) {
+    puts("pipe");
+    failed++;
+  }
+  json_doc_free(doc);
+  free(s);
+
+  if (failed)
+    printf("%d failed\n", failed);
+  else
+    puts("ok");
+  return failed != 0;
+}
@@ -0,0 +1,94 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * @brief 测试json_parse_n不读取len之后的内存
+ *
+ * 输入放在可读页的末尾，之后的一页不可访问
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  const char s[] = "{\"a\":[1,2,3],\"b\":\"x\\u4e2d\",\"c\":{\"d\":1.5}}";
+  size_t len = sizeof(s) - 1;
+  size_t page = sysconf(_SC_PAGESIZE);
+  char *map = mmap(NULL, page * 2, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  mprotect(map + page, page, PROT_NONE);
+  char *buf = map + page - len;
+  memcpy(buf, s, len);
+
+  int failed = 0;
+  json_path *b = json_path_compile("b");
+  json_path *d = json_path_compile("c:d");
+
+  json *root = json_parse_n(buf, len, 0);
+  char *str = json_path_get_str(b, root);
+  if (!str || strcmp(str, "x中")) {
+    printf("json_parse_n\n");
+    failed++;
+  }
+  json_free(root);
+
+  json_doc *doc = json_doc_parse_n(buf, len, 0);
+  double f;
+  if (!doc || !json_path_get_float(d, doc->root, &f) || f != 1.5) {
+    printf("json_doc_parse_n\n");
+    failed++;
+  }
+  json_doc_free(doc);
+
+  // 驻留key与短字符串值
+  doc = json_doc_parse_n(buf, len, JSON_INTERN | JSON_INTERN_STRINGS);
+  str = doc ? json_path_get_str(b, doc->root) : NULL;
+  if (!doc || !(doc->flags & JSON_INTERN) || !json_doc_intern(doc, "d") ||
+      !str || str != json_doc_intern(doc, "x中")) {
+    printf("JSON_INTERN\n");
+    failed++;
+  }
+  json_doc_free(doc);
+
+  // 成员较多的对象以驻留的key建立索引
+  char wide[512];
+  size_t n = sprintf(wide, "{");
+  for (int i = 0; i < 20; i++)
+    n += sprintf(wide + n, "%s\"k%d\":%d", i ? "," : "", i, i);
+  n += sprintf(wide + n, "}");
+  json_path *k = json_path_compile("k17");
+  long v;
+  doc = json_doc_parse_n(wide, n, JSON_INTERN);
+  if (!doc || !json_path_get_int(k, doc->root, &v) || v != 17) {
+    printf("JSON_INTERN index\n");
+    failed++;
+  }
+  json_doc_free(doc);
+  json_path_free(k);
+
+  // 截断的输入
+  if ((root = json_parse_n(buf, len - 1, 0))) {
+    printf("truncated\n");
+    failed++;
+  }
+  json_free(root);
+
+  // 以'\0'为哨兵的解析
+  memcpy(map, s, sizeof(s));
+  root = json_parse_n(map, len, JSON_PADDED);
+  str = json_path_get_str(b, root);
+  if (!str || strcmp(str, "x中")) {
+    printf("JSON_PADDED\n");
+    failed++;
+  }
+  json_free(root);
+
+  json_path_free(b);
+  json_path_free(d);
+  munmap(map, page * 2);
+  printf("%s\n", failed ? "failed" : "passed");
+  return failed != 0;
+}
@@ -0,0 +1,144 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+static bool same_chain(json *a, json *b, bool object);
+
+/**
+ * @brief 比较两个节点的值
+ *
+ * @return bool 相同返回true
+ */
+static bool same_value(json *a, json *b) {
+  if (a->value_type != b->value_type)
+    return false;
+  // 值不是数组时len中为解析器的标记，两种解析方式可能不同
+  if (a->value_type > json_Json && a->len != b->len)
+    return false;
+  switch (a->value_type) {
+  case json_Null:
+    return true;
+  case json_Int:
+    return a->value.Int == b->value.Int;
+  case json_Float:
+    return a->value.Float == b->value.Float;
+  case json_Bool:
+    return a->value.Bool == b->value.Bool;
+  case json_String:
+    return !strcmp(a->value.String, b->value.String);
+  case json_Json:
+    return same_chain(a->value.Json, b->value.Json, true);
+  case json_Mix:
+    return same_chain(a->value.Mix, b->value.Mix, false);
+  case json_Strings:
+    for (size_t i = 0; i < a->len; i++)
+      if (strcmp(a->value.Strings[i], b->value.Strings[i]))
+        return false;
+    return true;
+  case json_Jsons:
+    for (size_t i = 0; i < a->len; i++)
+      if (!same_chain(a->value.Jsons[i], b->value.Jsons[i], true))
+        return false;
+    return true;
+  default:
+    if (a->value_type > json_Ints && a->value_type <= json_Ints_end)
+      return !memcmp(a->value.Ints, b->value.Ints, sizeof(long) * a->len);
+    if (a->value_type > json_Floats && a->value_type <= json_Floats_end)
+      return !memcmp(a->value.Floats, b->value.Floats, sizeof(double) * a->len);
+    return !memcmp(a->value.Bools, b->value.Bools, sizeof(bool) * a->len);
+  }
+}
+
+/**
+ * @brief 比较两个节点链表
+ *
+ * @param object 是否比较key
+ * @return bool 相同返回true
+ */
+static bool same_chain(json *a, json *b, bool object) {
+  for (; a && b; a = a->next, b = b->next)
+    if ((object && strcmp(a->key, b->key)) || !same_value(a, b))
+      return false;
+  return !a && !b;
+}
+
+/**
+ * @brief 分三块输入增量解析器
+ *
+ * @return json* 解析结果
+ */
+static json *parse_split(const char *s, size_t a, size_t b) {
+  json_parser *p = json_parser_new();
+  json_parser_feed(p, s, a);
+  json_parser_feed(p, s + a, b - a);
+  json_parser_feed(p, s + b, strlen(s) - b);
+  return json_parser_finish(p);
+}
+
+/**
+ * @brief 测试json_parser_feed在任意位置分块时与json_parse结果相同
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  const char *docs[] = {
+      "{\"a\":1,\"b\":-2.5e3,\"c\":\"x\\\"y\\\\\",\"d\":true,\"e\":null}",
+      "{\"u\":\"\\u4e2d\\u6587\",\"s\":[\"a\",\"b\\n\"],\"i\":[1,2,3],"
+      "\"f\":[1.5,2],\"bo\":[true,false],\"m\":[1,\"x\",{\"k\":[[]]}],"
+      "\"j\":[{\"x\":1},{}],\"e\":[],\"o\":{}}",
+      "{ /* c */ \"k\" : // c\n \"v\" , \"n\":{\"a\":{\"b\":[[1],[2]]}}}",
+      "{\"k0\":0,\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,\"k6\":6,"
+      "\"k7\":7,\"k8\":8,\"k9\":9,\"k10\":10,\"k11\":11,\"k12\":12,"
+      "\"k13\":13,\"k14\":14,\"k15\":15,\"k16\":16}",
+  };
+  int failed = 0;
+  for (size_t i = 0; i < sizeof(docs) / sizeof(*docs); i++) {
+    char *copy = strdup(docs[i]);
+    json *want = json_parse(copy);
+    free(copy);
+    size_t len = strlen(docs[i]);
+    for (size_t a = 0; a <= len; a++) {
+      for (size_t b = a; b <= len; b++) {
+        json *got = parse_split(docs[i], a, b);
+        if (!got || !same_value(want, got)) {
+          printf("doc %zu split %zu %zu\n", i, a, b);
+          failed++;
+        }
+        json_free(got);
+      }
+    }
+    json_free(want);
+  }
+
+  // 逐字节输入
+  json_parser *p = json_parser_new();
+  for (const char *s = docs[1]; *s; s++)
+    json_parser_feed(p, s, 1);
+  json *got = json_parser_finish(p);
+  json_path *path = json_path_compile("m:2:k");
+  enum json_value_type type;
+  union json_value value;
+  if (!got || !json_path_get(path, got, &type, &value) || type != json_Mix) {
+    printf("byte by byte\n");
+    failed++;
+  }
+  json_path_free(path);
+  json_free(got);
+
+  // 不完整或错误的输入
+  const char *bad[] = {"{\"a\":", "{\"a\":[1,2}", "{\"a\":tru}", "[1]",
+                       "{\"a\" 1}"};
+  for (size_t i = 0; i < sizeof(bad) / sizeof(*bad); i++) {
+    json *root = parse_split(bad[i], 1, 2);
+    if (root) {
+      printf("bad %zu\n", i);
+      failed++;
+    }
+    json_free(root);
+  }
+
+  printf("%s\n", failed ? "failed" : "passed");
+  return failed != 0;
+}
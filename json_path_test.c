@@ -0,0 +1,63 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief 测试json_path_compile与json_path_get_*
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  char s[] = "{"
+             "\"version\":\"2.0.0\","
+             "\"tasks\":[{\"label\":\"build\",\"args\":[\"-g\",\"-O2\"]},"
+             "{\"label\":\"test\",\"retry\":3}],"
+             "\"ratio\":[0.5,1.5],"
+             "\"flags\":[true,false],"
+             "\"mix\":[1,\"two\",{\"three\":3}],"
+             "\"0\":\"zero\""
+             "}";
+  json *root = json_parse(s);
+
+  const char *paths[] = {"version", "tasks:0:label", "tasks:0:args:1",
+                         "tasks:1:label", "mix:1", "0", "tasks:2:label",
+                         "nope"};
+  const char *expect[] = {"2.0.0", "build", "-O2", "test", "two", "zero",
+                          NULL, NULL};
+  int failed = 0;
+  for (size_t i = 0; i < sizeof(paths) / sizeof(*paths); i++) {
+    json_path *path = json_path_compile(paths[i]);
+    char *str = json_path_get_str(path, root);
+    if (expect[i] ? !str || strcmp(str, expect[i]) : str != NULL) {
+      printf("%s: %s\n", paths[i], str ? str : "(null)");
+      failed++;
+    }
+    json_path_free(path);
+  }
+
+  long n;
+  double d;
+  bool b;
+  json_path *retry = json_path_compile("tasks:1:retry");
+  json_path *ratio = json_path_compile("ratio:1");
+  json_path *flag = json_path_compile("flags:1");
+  json_path *three = json_path_compile("mix:2:three");
+  if (!json_path_get_int(retry, root, &n) || n != 3)
+    failed++;
+  if (!json_path_get_float(ratio, root, &d) || d != 1.5)
+    failed++;
+  if (!json_path_get_bool(flag, root, &b) || b)
+    failed++;
+  if (!json_path_get_int(three, root, &n) || n != 3)
+    failed++;
+  json_path_free(retry);
+  json_path_free(ratio);
+  json_path_free(flag);
+  json_path_free(three);
+
+  json_free(root);
+  printf("json_path: %d failed\n", failed);
+  return failed != 0;
+}
@@ -0,0 +1,150 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief 将事件转发给json_writer，重新输出整个文档
+ */
+struct forward {
+  json_writer *w;
+  char buf[256];
+  int raw; // number 回调收到的次数
+};
+
+static bool flush_str(void *arg, const char *buf, size_t len) {
+  char **out = arg;
+  size_t old = *out ? strlen(*out) : 0;
+  *out = realloc(*out, old + len + 1);
+  memcpy(*out + old, buf, len);
+  (*out)[old + len] = '\0';
+  return true;
+}
+
+static bool on_start_object(void *arg) {
+  return json_writer_begin_object(((struct forward *)arg)->w);
+}
+static bool on_end_object(void *arg) {
+  return json_writer_end_object(((struct forward *)arg)->w);
+}
+static bool on_start_array(void *arg) {
+  return json_writer_begin_array(((struct forward *)arg)->w);
+}
+static bool on_end_array(void *arg) {
+  return json_writer_end_array(((struct forward *)arg)->w);
+}
+static bool on_key(void *arg, const char *str, size_t len, bool escaped) {
+  struct forward *f = arg;
+  size_t n = json_sax_unescape(f->buf, str, len);
+  return (escaped || n == len) && json_writer_key(f->w, f->buf);
+}
+static bool on_string(void *arg, const char *str, size_t len, bool escaped) {
+  struct forward *f = arg;
+  size_t n = json_sax_unescape(f->buf, str, len);
+  return (escaped || n == len) && json_writer_string(f->w, f->buf);
+}
+static bool on_integer(void *arg, long v) {
+  return json_writer_int(((struct forward *)arg)->w, v);
+}
+static bool on_real(void *arg, double v) {
+  return json_writer_double(((struct forward *)arg)->w, v);
+}
+static bool on_boolean(void *arg, bool v) {
+  return json_writer_bool(((struct forward *)arg)->w, v);
+}
+static bool on_null(void *arg) {
+  return json_writer_null(((struct forward *)arg)->w);
+}
+static bool on_number(void *arg, const char *str, size_t len) {
+  struct forward *f = arg;
+  f->raw++;
+  return len == 4 && !strncmp(str, "-1.5", 4);
+}
+static bool on_any_number(void *arg, const char *str, size_t len) {
+  return true;
+}
+static bool on_any_integer(void *arg, long v) { return true; }
+static bool on_any_real(void *arg, double v) { return true; }
+static bool on_stop(void *arg, const char *str, size_t len, bool escaped) {
+  return strncmp(str, "stop", len);
+}
+
+/**
+ * @brief 测试json_sax_parse
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  int failed = 0;
+  char s[] = "{\"a\":1, \"b\":[2.5,\"x\\\"y\",true,null,{}], /* c */ "
+             "\"c\\n\":{\"d\":[[],false]}, \"e\":\"\\u4e2d\"}";
+
+  // 经过事件重新输出的结果与解析后再序列化的结果相同
+  char *out = NULL;
+  struct forward f = {json_writer_new(flush_str, &out, 0)};
+  struct json_sax_handler h = {
+      on_start_object, on_end_object, on_start_array, on_end_array,
+      on_key,          on_string,     NULL,           on_integer,
+      on_real,         on_boolean,    on_null};
+  if (!json_sax_parse(s, &h, &f) || !json_writer_finish(f.w)) {
+    printf("forward\n");
+    failed++;
+  } else {
+    json *root = json_parse(s);
+    char *dump = json_dump(root, 0);
+    if (strcmp(out, dump)) {
+      printf("sax:  %s\ndump: %s\n", out, dump);
+      failed++;
+    }
+    free(dump);
+    json_free(root);
+  }
+  free(out);
+
+  // 数字原文
+  struct json_sax_handler raw = {0};
+  raw.number = on_number;
+  f.raw = 0;
+  if (!json_sax_parse("[-1.5, -1.5]", &raw, &f) || f.raw != 2) {
+    printf("raw number\n");
+    failed++;
+  }
+
+  // number回调与integer, real回调接受相同的数字
+  const char *numbers[] = {"[1.2.3, --, 1e]", "[1.2.3]", "[--]", "[-]",
+                           "[1e]", "[1.]", "[-0.5e+3]", "[1e5.5]",
+                           "[2-3]", "[1E-2, 0, -7]"};
+  struct json_sax_handler conv = {0};
+  conv.integer = on_any_integer;
+  conv.real = on_any_real;
+  raw.number = on_any_number;
+  for (size_t i = 0; i < sizeof(numbers) / sizeof(*numbers); i++) {
+    const char *num = numbers[i];
+    if (json_sax_parse(num, &raw, NULL) != json_sax_parse(num, &conv, NULL) ||
+        (i == 0 && json_sax_parse(num, &raw, NULL))) {
+      printf("number grammar: %s\n", numbers[i]);
+      failed++;
+    }
+  }
+
+  // 回调返回false时停止
+  struct json_sax_handler stop = {0};
+  stop.string = on_stop;
+  if (json_sax_parse("[\"go\", \"stop\", \"go\"]", &stop, NULL) ||
+      !json_sax_parse("[\"go\"]", &stop, NULL)) {
+    printf("stop\n");
+    failed++;
+  }
+
+  // 语法错误
+  struct json_sax_handler none = {0};
+  if (json_sax_parse("{\"a\" 1}", &none, NULL) ||
+      json_sax_parse("[1,", &none, NULL)) {
+    printf("syntax\n");
+    failed++;
+  }
+
+  printf("%s\n", failed ? "failed" : "passed");
+  return failed != 0;
+}
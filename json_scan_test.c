@@ -0,0 +1,282 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief 一组扫描kernel，supported 为当前CPU是否支持
+ */
+struct kernel_set {
+  const char *name;
+  struct scan_kernel k;
+  bool supported;
+};
+
+// 按字节的实现作为参照，放在第一个
+static struct kernel_set sets[3];
+static int set_nums;
+
+static void sets_init(void) {
+  sets[set_nums++] = (struct kernel_set){
+      "scalar",
+      {space_scalar, line_scalar, star_scalar, quote_scalar, escape_scalar,
+       block_scalar, backslash_scalar, utf8_scalar},
+      true};
+#ifdef JSON_X86
+  __builtin_cpu_init();
+  sets[set_nums++] = (struct kernel_set){
+      "sse2",
+      {space_sse2, line_sse2, star_sse2, quote_sse2, escape_sse2, block_sse2,
+       backslash_sse2, utf8_scalar},
+      __builtin_cpu_supports("sse2")};
+  sets[set_nums++] = (struct kernel_set){
+      "avx2",
+      {space_avx2, line_avx2, star_avx2, quote_avx2, escape_avx2, block_avx2,
+       backslash_avx2, utf8_avx2},
+      __builtin_cpu_supports("avx2")};
+#endif
+}
+
+static const char *const names[] = {"space", "line",   "star",
+                                    "quote", "escape", "backslash"};
+
+static char *run(const struct scan_kernel *k, int which, char *str) {
+  switch (which) {
+  case 0:
+    return k->space(str);
+  case 1:
+    return k->line(str);
+  case 2:
+    return k->star(str);
+  case 3:
+    return k->quote(str);
+  case 4:
+    return k->escape(str);
+  default:
+    return k->backslash(str);
+  }
+}
+
+// 向量化的实现按16/32字节对齐读取，缓冲区按64字节对齐，
+// '\0'之后填满各kernel的停止字符，检查不会越过'\0'
+static char buf[512] __attribute__((aligned(64)));
+static const char after_end[] = "\"\\*\n\x01/";
+
+/**
+ * @brief 将str放在buf的off处
+ *
+ * @return char* 放置后的开始
+ */
+static char *place(const char *str, size_t len, size_t off) {
+  for (size_t i = 0; i < sizeof(buf); i++)
+    buf[i] = after_end[i % (sizeof(after_end) - 1)];
+  memcpy(buf + off, str, len);
+  buf[off + len] = '\0';
+  return buf + off;
+}
+
+/**
+ * @brief 在每个对齐偏移处运行各kernel，与按字节的结果比较
+ *
+ * @return int 失败的个数
+ */
+static int check_string(const char *str, size_t len) {
+  for (size_t off = 0; off < 64; off++) {
+    char *s = place(str, len, off);
+    for (int which = 0; which < 6; which++) {
+      size_t want = run(&sets[0].k, which, s) - s;
+      for (int i = 1; i < set_nums; i++) {
+        if (!sets[i].supported)
+          continue;
+        size_t got = run(&sets[i].k, which, s) - s;
+        if (got != want) {
+          printf("%s %s: off %zu len %zu: %zu != %zu\n", sets[i].name,
+                 names[which], off, len, got, want);
+          return 1;
+        }
+      }
+    }
+
+    // 跳过注释时`*/`与块边界的关系
+    scan = sets[0].k;
+    size_t want = skip(s) - s;
+    for (int i = 1; i < set_nums; i++) {
+      if (!sets[i].supported)
+        continue;
+      scan = sets[i].k;
+      size_t got = skip(s) - s;
+      if (got != want) {
+        printf("%s skip: off %zu len %zu: %zu != %zu\n", sets[i].name, off,
+               len, got, want);
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+static uint64_t rng = 88172645463325252ull;
+static uint64_t next_rand(void) {
+  rng ^= rng << 13;
+  rng ^= rng >> 7;
+  rng ^= rng << 17;
+  return rng;
+}
+
+/**
+ * @brief 比较64字节块的位掩码
+ *
+ * @return int 失败的个数
+ */
+static int check_block(const char *p) {
+  struct block_masks want, got;
+  sets[0].k.block(p, &want);
+  for (int i = 1; i < set_nums; i++) {
+    if (!sets[i].supported)
+      continue;
+    sets[i].k.block(p, &got);
+    if (memcmp(&want, &got, sizeof(want))) {
+      printf("%s block\n", sets[i].name);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief 比较utf8检查的结果
+ *
+ * @return int 失败的个数
+ */
+static int check_utf8(const char *s, size_t len) {
+  bool want = sets[0].k.utf8(s, len);
+  for (int i = 1; i < set_nums; i++) {
+    if (sets[i].supported && sets[i].k.utf8(s, len) != want) {
+      printf("%s utf8: len %zu\n", sets[i].name, len);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief 测试向量化的扫描kernel与按字节的实现结果相同
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  int failed = 0;
+  sets_init();
+  struct scan_kernel saved = scan;
+
+  // 固定的输入
+  static const char *const inputs[] = {
+      "",
+      "x",
+      "   \t\r\n  x",
+      "\"",
+      "\\",
+      "\\\\\\\"",
+      "abc\\\\\\\\\"def",
+      "a*b",
+      "** /",
+      "line\nnext",
+      "\x01\x1f ",
+      "\x7f\x80\xff\"",
+      "\xc3\xa9\xe4\xb8\xad\"",
+      "/* c */x",
+      "/**/x",
+      "/*/ */x",
+      "/* unterminated *",
+      "// line\n  x",
+      "// no newline",
+      "  /* a */ /* b */ // c\n /**/ x",
+  };
+  for (size_t i = 0; i < sizeof(inputs) / sizeof(*inputs); i++)
+    failed += check_string(inputs[i], strlen(inputs[i]));
+
+  // 停止字符位于各个位置，跨越16与32字节的块边界
+  char str[160];
+  const char stops[] = "\"\\*\n\x01x/";
+  const char fills[] = " a\t";
+  for (size_t f = 0; f < sizeof(fills) - 1; f++) {
+    for (size_t c = 0; c < sizeof(stops) - 1; c++) {
+      for (size_t p = 0; p < 72; p++) {
+        memset(str, fills[f], p);
+        str[p] = stops[c];
+        memset(str + p + 1, fills[f], 3);
+        failed += check_string(str, p + 4);
+        // 结尾在块中间，没有停止字符
+        failed += check_string(str, p);
+      }
+    }
+  }
+
+  // 连续的`\`，以及`*/`在块边界两侧
+  for (size_t p = 0; p < 72; p++) {
+    for (size_t run_len = 1; run_len < 5; run_len++) {
+      memset(str, 'a', p);
+      memset(str + p, '\\', run_len);
+      strcpy(str + p + run_len, "\"b");
+      failed += check_string(str, strlen(str));
+    }
+    memcpy(str, "/*", 2);
+    memset(str + 2, 'a', p);
+    strcpy(str + 2 + p, "*/x");
+    failed += check_string(str, strlen(str));
+    memset(str + 2, '*', p);
+    strcpy(str + 2 + p, "*/x");
+    failed += check_string(str, strlen(str));
+    memcpy(str, "//", 2);
+    memset(str + 2, 'a', p);
+    strcpy(str + 2 + p, "\n x");
+    failed += check_string(str, strlen(str));
+    if (failed > 10)
+      break;
+  }
+
+  // 位掩码：结构字符、引号与`\`随机出现，在各个偏移处读取
+  const char chars[] = "\"\\/{[}],a :\x80";
+  char block[256];
+  for (int round = 0; round < 2000; round++) {
+    for (size_t i = 0; i < sizeof(block); i++)
+      block[i] = chars[next_rand() % (sizeof(chars) - 1)];
+    for (size_t off = 0; off < 64; off++)
+      failed += check_block(block + off);
+    if (failed > 10)
+      break;
+  }
+
+  // utf8：合法的字符与随机字节，结尾在块中间或多字节字符中间
+  const char *const pieces[] = {"a", "\xc3\xa9", "\xe4\xb8\xad",
+                                "\xf0\x9f\x98\x80", "\xed\xa0\x80",
+                                "\xc0\xaf", "\x80", "\xf4\x90\x80\x80"};
+  char text[160];
+  for (int round = 0; round < 20000; round++) {
+    size_t n = 0;
+    bool valid_only = round & 1;
+    while (n < 120) {
+      const char *piece = pieces[next_rand() % (valid_only ? 4 : 8)];
+      memcpy(text + n, piece, strlen(piece));
+      n += strlen(piece);
+    }
+    size_t len = next_rand() % n;
+    size_t off = next_rand() % 32;
+    memmove(buf + off, text, len);
+    failed += check_utf8(buf + off, len);
+    if (failed > 10)
+      break;
+  }
+
+  scan = saved;
+  for (int i = 1; i < set_nums; i++)
+    if (!sets[i].supported)
+      printf("%s not supported, skipped\n", sets[i].name);
+  if (failed)
+    printf("%d failed\n", failed);
+  else
+    puts("ok");
+  return failed != 0;
+}
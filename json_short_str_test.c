@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 统计解析过程中申请内存的次数
+static size_t allocs;
+static void *count_malloc(size_t size) {
+  allocs++;
+  return malloc(size);
+}
+#define malloc(size) count_malloc(size)
+
+#include "json.c"
+#include "json.h"
+
+/**
+ * @brief 测试json_parse中短的key与字符串值与节点一起申请
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  int failed = 0;
+  char s[] = "{\"id\": 1, \"name\": \"short\", \"a\\tb\": \"\\u00e9\\n\","
+             " \"long_key_name_over_16\": \"a string value longer than 16\","
+             " \"s\": \"a string value longer than 16\", \"\": \"\","
+             " \"o\": {\"k\": \"v\", \"arr\": [\"x\", \"y\"]}}";
+  char copy[sizeof(s)];
+  memcpy(copy, s, sizeof(s));
+
+  allocs = 0;
+  json *root = json_parse(s);
+  size_t used = allocs;
+  json_doc *doc = json_doc_parse(copy, 0);
+  if (!root || !doc) {
+    puts("parse failed");
+    return 1;
+  }
+
+  // 结果与文档解析相同
+  char *a = json_dump(root, 0);
+  char *b = json_dump(doc->root, 0);
+  if (!a || !b || strcmp(a, b)) {
+    printf("dump:\n%s\n%s\n", a, b);
+    failed++;
+  }
+  free(a);
+  free(b);
+
+  // 短的key与值紧跟在节点之后，首个成员之后先是索引头部，
+  // len中记录与节点一起申请的字符串
+  json *m = root->value.Json;
+  json *name = m->next;
+  json *tab = name->next;
+  if (m->key != (char *)(m + 1) + sizeof(struct json_head) ||
+      strcmp(m->key, "id") || m->len != (JSON_LEN_HEAD | JSON_LEN_KEY) ||
+      name->key != (char *)(name + 1) ||
+      name->value.String != name->key + 5 ||
+      name->len != (JSON_LEN_KEY | JSON_LEN_STR) ||
+      strcmp(name->value.String, "short") ||
+      strcmp(tab->key, "a\tb") || strcmp(tab->value.String, "\xc3\xa9\n")) {
+    puts("inline strings");
+    failed++;
+  }
+  // 值为数组的成员len为元素个数，key单独申请
+  json *lk = tab->next;
+  json *arr = jump("o", root)->value.Json->next;
+  if (lk->key == (char *)(lk + 1) || lk->len ||
+      arr->key == (char *)(arr + 1) || arr->len != 2 ||
+      strcmp(json_read_str("long_key_name_over_16", root),
+             "a string value longer than 16") ||
+      strcmp(json_read_str("o:k", root), "v")) {
+    puts("long strings");
+    failed++;
+  }
+
+  // 根节点，9个成员节点，数组与其中的2个字符串，3个长字符串，
+  // 值为数组的成员的key
+  if (used != 17) {
+    printf("%zu allocations\n", used);
+    failed++;
+  }
+
+  json_free(root);
+  json_doc_free(doc);
+  if (failed)
+    printf("%d failed\n", failed);
+  else
+    puts("ok");
+  return failed != 0;
+}
@@ -0,0 +1,97 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief 以 JSON_STRICT 解析，并用json_doc_parse_n按长度再解析一次
+ *
+ * @return bool 两种方式的结果须相同，返回是否解析成功
+ */
+static bool strict_ok(const char *s, int *failed) {
+  char *copy = strdup(s);
+  json_doc *doc = json_doc_parse(copy, JSON_STRICT);
+  json_doc *bounded = json_doc_parse_n(s, strlen(s), JSON_STRICT);
+  bool ok = doc != NULL;
+  if (ok != (bounded != NULL)) {
+    printf("bounded differs: %s\n", s);
+    (*failed)++;
+  }
+  json_doc_free(doc);
+  json_doc_free(bounded);
+  free(copy);
+  return ok;
+}
+
+/**
+ * @brief 测试 JSON_STRICT 与代理对的解码
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  int failed = 0;
+
+  // 代理对解码为4字节的utf8，不需要 JSON_STRICT
+  char pair[] = "{\"e\": \"\\ud83d\\ude00!\", \"lone\": \"\\ud83dx\"}";
+  json_doc *doc = json_doc_parse(pair, 0);
+  char *e = doc ? json_read_str("e", doc->root) : NULL;
+  char *lone = doc ? json_read_str("lone", doc->root) : NULL;
+  if (!e || strcmp(e, "\xf0\x9f\x98\x80!") || !lone ||
+      strcmp(lone, "\xed\xa0\xbdx")) {
+    puts("surrogate pair");
+    failed++;
+  }
+  json_doc_free(doc);
+
+  // 合法的输入，含有较长的ASCII段使向量化的kernel跨越多个块
+  static const char *const good[] = {
+      "{\"a\": \"plain ascii text that is longer than one 32 byte block\"}",
+      "{\"\xc3\xa9\": \"\xe4\xb8\xad\xe6\x96\x87\xf0\x9f\x98\x80\xf4\x8f\xbf"
+      "\xbf\"}",
+      "{\"esc\": \"\\\" \\\\ \\/ \\b \\f \\n \\r \\t \\u00e9 \\uD83D\\uDE00\"}",
+      "{\"k\": [1, 2.5, true, null, {\"x\": \"\xef\xbf\xbd\"}]}",
+  };
+  for (size_t i = 0; i < sizeof(good) / sizeof(good[0]); i++)
+    if (!strict_ok(good[i], &failed)) {
+      printf("rejected: %s\n", good[i]);
+      failed++;
+    }
+
+  // 非法的utf8与转义
+  static const char *const bad[] = {
+      "{\"a\": \"\x80\"}",              // 单独的后续字节
+      "{\"a\": \"\xc0\xaf\"}",          // 超长编码
+      "{\"a\": \"\xe0\x80\xaf\"}",      // 超长编码
+      "{\"a\": \"\xed\xa0\x80\"}",      // 代理项
+      "{\"a\": \"\xf4\x90\x80\x80\"}",  // 大于U+10FFFF
+      "{\"a\": \"\xe4\xb8\"}",          // 截断
+      "{\"a\": \"\xff\"}",              // 非法字节
+      "{\"a\": \"\\x41\"}",             // 非法转义
+      "{\"a\": \"\\u12G4\"}",           // 非法hex
+      "{\"a\": \"\\ud83d\"}",           // 单独的高代理项
+      "{\"a\": \"\\ude00\\ud83d\"}",    // 顺序错误
+      "{\"a\": \"\\ud83d\\u0041\"}",    // 高代理项之后不是低代理项
+  };
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+    if (strict_ok(bad[i], &failed)) {
+      printf("accepted bad %zu\n", i);
+      failed++;
+    }
+    // 非严格模式保持原来的行为
+    char *copy = strdup(bad[i]);
+    doc = json_doc_parse(copy, 0);
+    if (!doc) {
+      printf("lenient rejected bad %zu\n", i);
+      failed++;
+    }
+    json_doc_free(doc);
+    free(copy);
+  }
+
+  if (failed)
+    printf("%d failed\n", failed);
+  else
+    puts("ok");
+  return failed != 0;
+}
@@ -0,0 +1,105 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief 测试扁平的tape文档
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  char s[] = "{\"a\": {\"b\": [1, 2, 3], \"c\": \"x}]\\\"y\\u00e9\"},"
+             " \"n\": -1.5e3, \"t\": true, \"f\": false, \"z\": null,"
+             " \"objs\": [{\"k\": {\"v\": \"deep\"}}, {\"k\": 0}],"
+             " \"mix\": [1, \"s\", 2.5, null, [], {}, [[true]]],"
+             " \"e\": {}, \"s\": \"str\", \"o\": {\"p\": {\"q\": [[], {}]}}}";
+  int failed = 0;
+
+  json_tape *t = json_tape_parse(s);
+  json_doc *doc = json_doc_parse(s, 0);
+  if (!t || !doc) {
+    puts("parse failed");
+    return 1;
+  }
+
+  // 序列化结果与json树相同
+  for (int flags = 0; flags <= JSON_PRETTY; flags++) {
+    char *a = json_dump(doc->root, flags);
+    char *b = json_tape_dump(t, flags);
+    if (!a || !b || strcmp(a, b)) {
+      printf("dump %d:\n%s\n%s\n", flags, a, b);
+      failed++;
+    }
+    free(a);
+    free(b);
+  }
+
+  // 查找
+  static const char *const cases[][2] = {
+      {"a:c", "x}]\"y\xc3\xa9"}, {"objs:0:k:v", "deep"}, {"s", "str"},
+      {"mix:1", "s"},           {"n", NULL},            {"objs:2", NULL},
+      {"a:d", NULL},            {"mix:x", NULL},
+  };
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    char *str = json_tape_read_str((char *)cases[i][0], t);
+    const char *expect = cases[i][1];
+    if (expect ? !str || strcmp(str, expect) : str != NULL) {
+      printf("%s = %s\n", cases[i][0], str ? str : "(null)");
+      failed++;
+    }
+  }
+
+  enum json_value_type type;
+  union json_value value;
+  json_path *path = json_path_compile("a:b:2");
+  if (!path || !json_tape_path_get(path, t, &type, &value) ||
+      type != json_Int || value.Int != 3) {
+    puts("path a:b:2");
+    failed++;
+  }
+  json_path_free(path);
+  path = json_path_compile("n");
+  if (!json_tape_path_get(path, t, &type, &value) || type != json_Float ||
+      value.Float != -1500) {
+    puts("path n");
+    failed++;
+  }
+  json_path_free(path);
+  path = json_path_compile("o:p:q");
+  if (!json_tape_path_get(path, t, &type, &value) || type != json_Mix) {
+    puts("path o:p:q");
+    failed++;
+  }
+  json_path_free(path);
+  path = json_path_compile("mix:6:0:0");
+  if (!json_tape_path_get(path, t, &type, &value) || type != json_Bool ||
+      !value.Bool) {
+    puts("path mix:6:0:0");
+    failed++;
+  }
+  json_path_free(path);
+
+  // 根值可以是任意类型，有误时返回NULL
+  json_tape *arr = json_tape_parse("[1, [2], {\"a\": \"b\"}]");
+  char *d = arr ? json_tape_dump(arr, 0) : NULL;
+  if (!d || strcmp(d, "[1,[2],{\"a\":\"b\"}]")) {
+    printf("array root: %s\n", d ? d : "(null)");
+    failed++;
+  }
+  free(d);
+  json_tape_free(arr);
+  if (json_tape_parse("{\"a\": [1, 2}")) {
+    puts("mismatched brackets accepted");
+    failed++;
+  }
+
+  json_tape_free(t);
+  json_doc_free(doc);
+  if (failed)
+    printf("%d failed\n", failed);
+  else
+    puts("ok");
+  return failed != 0;
+}
@@ -0,0 +1,134 @@
+#include "json.c"
+#include "json.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief 收集写入器的输出
+ */
+struct sink {
+  char *buf;
+  size_t len;
+  size_t cap;
+  size_t flushes;
+};
+
+static bool sink_flush(void *arg, const char *buf, size_t len) {
+  struct sink *sink = arg;
+  if (sink->len + len + 1 > sink->cap) {
+    sink->cap = (sink->len + len + 1) * 2;
+    sink->buf = realloc(sink->buf, sink->cap);
+  }
+  memcpy(sink->buf + sink->len, buf, len);
+  sink->len += len;
+  sink->buf[sink->len] = '\0';
+  sink->flushes++;
+  return true;
+}
+
+/**
+ * @brief 写入一个与json_dump_test中相同结构的文档
+ */
+static bool write_doc(json_writer *w, const json *tree) {
+  return json_writer_begin_object(w) && json_writer_key(w, "i") &&
+         json_writer_int(w, -12) && json_writer_key(w, "f") &&
+         json_writer_double(w, 0.1) && json_writer_key(w, "s") &&
+         json_writer_string(w, "a\"\\\n\x01中") && json_writer_key(w, "a") &&
+         json_writer_begin_array(w) && json_writer_bool(w, true) &&
+         json_writer_null(w) && json_writer_begin_object(w) &&
+         json_writer_end_object(w) && json_writer_begin_array(w) &&
+         json_writer_end_array(w) && json_writer_end_array(w) &&
+         json_writer_key(w, "tree") && json_writer_value(w, tree) &&
+         json_writer_end_object(w);
+}
+
+/**
+ * @brief 测试json_writer
+ *
+ * @return int 全部通过返回0
+ */
+int main(void) {
+  int failed = 0;
+  char t[] = "{\"x\":[1,2],\"y\":{\"z\":\"w\"}}";
+  json *tree = json_parse(t);
+
+  // 与解析后再序列化的结果相同
+  for (int flags = 0; flags <= JSON_PRETTY; flags++) {
+    struct sink sink = {NULL, 0, 0, 0};
+    json_writer *w = json_writer_new(sink_flush, &sink, flags);
+    if (!write_doc(w, tree) ||
+        !json_writer_finish(w)) {
+      printf("write %d\n", flags);
+      failed++;
+      continue;
+    }
+    json *root = json_parse(sink.buf);
+    char *dump = json_dump(root, flags);
+    if (!dump || strcmp(dump, sink.buf)) {
+      printf("writer: %s\ndump:   %s\n", sink.buf, dump);
+      failed++;
+    }
+    free(dump);
+    json_free(root);
+    free(sink.buf);
+  }
+  json_free(tree);
+
+  // 嵌套错误
+  struct sink sink = {NULL, 0, 0, 0};
+  json_writer *w = json_writer_new(sink_flush, &sink, 0);
+  if (!json_writer_begin_object(w) || json_writer_int(w, 1) ||
+      json_writer_key(w, "k") || json_writer_finish(w)) {
+    printf("nesting\n");
+    failed++;
+  }
+  w = json_writer_new(sink_flush, &sink, 0);
+  if (!json_writer_begin_array(w) || json_writer_end_object(w) ||
+      json_writer_finish(w)) {
+    printf("mismatched end\n");
+    failed++;
+  }
+  w = json_writer_new(sink_flush, &sink, 0);
+  if (!json_writer_begin_array(w) || json_writer_finish(w)) {
+    printf("unfinished\n");
+    failed++;
+  }
+  free(sink.buf);
+
+  // 大于缓冲区的输出分多次写出
+  sink = (struct sink){NULL, 0, 0, 0};
+  char *big = malloc(200000);
+  for (size_t i = 0; i < 199999; i++)
+    big[i] = i % 100 ? 'a' + i % 26 : '\n';
+  big[199999] = '\0';
+  w = json_writer_new(sink_flush, &sink, 0);
+  json_writer_begin_object(w);
+  json_writer_key(w, "a");
+  json_writer_begin_array(w);
+  for (long i = 0; i < 100000; i++)
+    json_writer_int(w, i);
+  json_writer_string(w, big);
+  json_writer_end_array(w);
+  json_writer_end_object(w);
+  if (!json_writer_finish(w) || sink.flushes < 2) {
+    printf("big output\n");
+    failed++;
+  } else {
+    json *root = json_parse(sink.buf);
+    json *last = root ? root->value.Json->value.Mix : NULL;
+    while (last && last->next)
+      last = last->next;
+    if (!last || last->value_type != json_String ||
+        strcmp(last->value.String, big)) {
+      printf("big string\n");
+      failed++;
+    }
+    json_free(root);
+  }
+  free(big);
+  free(sink.buf);
+
+  printf("%s\n", failed ? "failed" : "passed");
+  return failed != 0;
+}